@@ -1,6 +1,12 @@
+#define _GNU_SOURCE // wcwidth, accept4
+#define NCURSES_WIDECHAR 1 // ncursesw: get_wch ve geniş karakter çıktısı
 #include <ncurses.h>
 #include <locale.h>
+#include <wchar.h>  // Adların ekran genişliği (mbrtowc, wcwidth)
+#include <wctype.h>
+#include <limits.h> // MB_LEN_MAX
 #include <string.h>
+#include <strings.h> // strcasecmp
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
@@ -9,6 +15,22 @@
 #include <errno.h>
 #include <stdbool.h> // bool tipini kullanmak için
 #include <ctype.h>   // tolower fonksiyonu için bu satır eklendi
+#include <fcntl.h>
+#include <sys/mman.h> // Log dosyasını belleğe eşlemek için
+#include <sys/file.h> // flock: log ekleyicileri ve yeniden yazıcılar arasında
+#include <stdint.h>
+#include <pthread.h> // Paralel log ayrıştırma için
+#include <poll.h>
+#include <sys/timerfd.h> // Olay döngüsünün bir sonraki son tarihi için
+#include <sys/eventfd.h> // Arka plan istatistik yapımının ilerleme ve bitiş bildirimleri
+#include <sys/inotify.h> // Veri dizinindeki log ve kategori değişikliklerini izlemek için
+#include <sys/socket.h> // Arka plan servisinin Unix soketi
+#include <sys/un.h>
+#include <signal.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // SSE2/AVX2 alan ayırıcı çekirdeği için
+#define FOCUSLOG_HAVE_X86_SIMD 1
+#endif
 
 // --- Makrolar ve Sabitler ---
 #define COLOR_PAIR_DEFAULT  1
@@ -29,38 +51,516 @@
 
 #define MAX_CATEGORY_NAME_LEN 100
 #define MAX_FOCUS_NAME_LEN    100
-#define MAX_CATEGORIES        50
-#define MAX_FOCUSES_PER_CATEGORY 50 // Her kategori için maksimum odak sayısı
 #define IDLE_TIMEOUT_SECONDS 5 // Boşta kalma süresi (saniye)
+#define EVENT_NO_DEADLINE (-1LL) // wait_for_key: tuş gelene kadar süresiz bekle
+#define EVENT_DATA_CHANGED (-2)   // wait_for_key: veri dizinindeki log veya kategori dosyası değişti
+#define MENU_CHOICE_RELOAD (-2)   // draw_menu_and_get_choice: kategori modeli değişti, liste yeniden kurulmalı
+#define DATA_WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) // Yazım bitti, dosya değiştirildi veya silindi
+#define DATA_CHANGE_LOG 1         // drain_data_watch: etkin log değişti
+#define DATA_CHANGE_CATEGORIES 2  // drain_data_watch: kategori dosyası değişti
+#define DAEMON_SOCKET_NAME "focuslog.sock" // Veri dizininde
+#define DAEMON_MAX_CLIENTS 64
+#define DAEMON_LINE_MAX 512           // İstek/yanıt satırı üst sınırı ('\n' dahil)
+#define DAEMON_CLIENT_TIMEOUT_MS 200  // İstemci tarafı gönderme/alma zaman aşımı
+#define DAEMON_MAX_SLEEP_MS (60 * 1000) // Uykuyu sayan saatte bitiş gecikmesini sınırlar
+#define SETTINGS_SUSPEND_POLICY_KEY "suspend_policy" // settings.conf: count | exclude
 
 #define STATS_FOCUS_NAME_COL_WIDTH 25 // İstatistikler tablosunda odak adı sütunu genişliği
+#define STATS_CHECKPOINT_TAIL_BYTES 64 // Log değişikliğini algılamak için özetlenen bayt sayısı
+#define LOG_SCAN_WINDOW_BYTES (64L * 1024 * 1024) // Log tarayıcısının tek seferde eşlediği pencere boyutu
+#define LOG_MAX_FIELDS 8 // Bir log satırında ayrıştırılan en fazla alan sayısı
+#define BINARY_LOG_MAGIC "FLOGBIN2" // İkili log dosyasının ilk 8 baytı (kayıtlar kalıcı ID'leri içerir)
+#define BINARY_LOG_MAGIC_V1 "FLOGBIN1" // Kalıcı ID'ler öncesi ikili log
+#define BINARY_LOG_MAGIC_LEN 8
+#define BINARY_TAG_NAME 'N'    // Sözlük girdisi: id, uzunluk, ad baytları
+#define BINARY_TAG_SESSION 'S' // Oturum: kategori/odak sözlük id'leri, kalıcı id'ler, başlangıç farkı, süreç, süre
+#define BINARY_TAG_UTC_OFFSET 'O' // Sonraki oturumların UTC farkı (saniye, zigzag)
+#define BINARY_TAG_TOMBSTONE 'T' // Silme işareti: tür, kategori sözlük id, [odak sözlük id], kalıcı id'ler, silme zamanı
+#define BINARY_MAX_RECORD_BYTES 256 // Tek bir ikili kaydın alabileceği en fazla bayt
+#define CSV_MAX_RECORD_BYTES (MAX_CATEGORY_NAME_LEN + MAX_FOCUS_NAME_LEN + 128) // Tek bir write() ile eklenen CSV satırı: iki ad, tırnaklar, ayırıcılar ve en çok 20 haneli altı sayı
+#define WORK_LOG_LOCK_NAME "work_log.lock" // Kilit ve log kuşak numarası (veri dizininde)
+#define CATEGORIES_LOCK_NAME "categories.lock" // Kategori dosyasını okuyup yeniden yazanların kilidi
+#define STATS_CACHE_NAME "stats.cache" // `focuslog stats` çağrıları arasında saklanan toplamlar (veri dizininde)
+#define STATS_CACHE_MAGIC "FLSTATC1"
+#define CSV_LOG_HEADER "\"Category\",\"Focus\",\"StartEpoch\",\"EndEpoch\",\"UtcOffset\",\"Duration\",\"CategoryId\",\"FocusId\"\n"
+#define CSV_CATEGORY_ID_COLUMN "CategoryId" // Kalıcı ID sütunlarının varlığını gösteren başlık
+#define LEGACY_CSV_START_COLUMN "StartTime" // Zamanları yerel metin olarak tutan eski başlık
+#define CSV_TOMBSTONE_CATEGORY "!DELETE_CATEGORY" // Kategori silme satırının işareti (tırnaksız ilk alan)
+#define CSV_TOMBSTONE_FOCUS "!DELETE_FOCUS"       // Odak silme satırının işareti
+#define COMPACT_MIN_DEAD_BYTES (1L * 1024 * 1024) // Otomatik sıkıştırma için gereken en az ölü bayt
+#define COMPACT_DEAD_PERCENT 25 // Ölü baytlar logun bu yüzdesini aşınca otomatik sıkıştırılır
+#define CSV_KERNEL_BLOCK_BYTES 64 // Vektörel ayrıştırıcının tek adımda sınıflandırdığı bayt sayısı
+#define CATEGORIES_NEXT_ID_PREFIX "!NextId;" // Kategori dosyasında sıradaki kalıcı ID satırı
+#define ENTITY_INDEX_MIN_SIZE 64 // Kalıcı ID indeksinin en küçük yuva sayısı (2'nin kuvveti)
+#define STAT_NAME_TABLE_MIN_SIZE 256 // İsim indeksinin başlangıç yuva sayısı (2'nin kuvveti; yarısı dolunca büyür)
+#define ARENA_BLOCK_BYTES (64 * 1024) // Arenanın sistemden tek seferde istediği en küçük blok
+#define MODEL_MIN_CAPACITY 8 // Büyüyen kategori/odak dizilerinin ilk kapasitesi
+#define PARALLEL_INGEST_MIN_BYTES (4L * 1024 * 1024) // Bu boyutun altındaki loglar tek iş parçacığıyla okunur
+#define STATS_SINCE_SEEK_SLACK_SECONDS (24 * 60 * 60) // --since aramasında sıra dışı eklenmiş kayıtlar için pay
+#define STATS_SINCE_ORDER_SAMPLES 16 // --since aramasından önce sırası denetlenen kayıt sayısı
+#define STATS_SINCE_SEEK_MIN_BYTES (64 * 1024) // Arama bu aralığa inince doğrusal taramaya geçilir
+#define MAX_INGEST_THREADS 32
+#define STATS_ASYNC_MIN_BYTES (1L * 1024 * 1024) // Arayüzde bu kadar bayt okunacaksa yükleme arka planda yapılır
+#define STATS_PROGRESS_STEP_BYTES (1L * 1024 * 1024) // Arka plan yapımı her bu kadar baytta ilerleme bildirir
+#define STATS_RETRY_MS 2000 // Arka plan yapımı başlatılamazsa bu kadar sonra yeniden denenir
+#define IDLE_TOP_FOCUS_COUNT 3 // Boşta ekranında listelenen en uzun odak sayısı
+#define STATS_ROW_CATEGORY (-1) // İstatistik tablosu satırı: kategori başlığı
+#define STATS_ROW_BLANK (-2)    // İstatistik tablosu satırı: kategoriler arasındaki boş satır
+#define UI_HEADER_ROWS 4 // Tablo ekranlarında başlık penceresinin satır sayısı (başlık, boşluk, sütunlar, ayırıcı)
+#define UI_FOOTER_ROWS 2 // Alt bilgi penceresinin satır sayısı
+#define UI_FRAME_LOG_ENV "FOCUSLOG_FRAME_LOG" // Kare başına terminale yazılan baytların kaydedileceği dosya
 
 // --- Yeni Veri Yapıları ---
+// Büyük bloklardan sırayla yer ayıran bellek alanı. Tek tek serbest bırakma yoktur;
+// model yeniden kurulurken bütün bloklar birlikte bırakılır.
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    size_t size;
+    unsigned char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *blocks; // En yeni blok başta
+} Arena;
+
 typedef struct {
-    char name[MAX_FOCUS_NAME_LEN];
+    char *name;         // Ad baytları modelin dize havuzunda
+    int name_width;     // Adın terminalde kapladığı hücre sayısı (ad atanırken bir kez ölçülür)
     int color_pair_id;
+    uint32_t id;        // Kalıcı ID; log kayıtları odağa bu ID ile bağlanır
 } Focus;
 
 typedef struct {
-    char name[MAX_CATEGORY_NAME_LEN];
-    Focus focuses[MAX_FOCUSES_PER_CATEGORY];
+    char *name;
+    int name_width;     // Adın terminalde kapladığı hücre sayısı
+    Focus *focuses;     // Arenada büyüyen dizi
     int num_focuses;
+    int focus_capacity;
     int color_pair_id;
+    uint32_t id;        // Kalıcı ID (kategori ve odaklar aynı sayaçtan ID alır)
 } Category;
 
+// Kalıcı ID'den kategori/odak konumuna indeks yuvası
+typedef struct {
+    uint32_t id;        // 0 = boş yuva
+    int category_index;
+    int focus_index;    // Kategori girdilerinde -1
+} EntitySlot;
+
+// Kategori dosyasının ayrıştırılmış bir sürümü. Örnekler arası birleştirmede taban (son
+// okunan/yazılan), bizimki (bellekteki model) ve diskteki sürüm bu biçimde karşılaştırılır.
+typedef struct {
+    char *name;
+    int color_pair_id;  // Dosyada yoksa -1 (yüklenirken rastgele atanır)
+    uint32_t id;        // Kalıcı ID (eski dosyalarda 0)
+    int parent;         // Odaklarda kategorisinin girdi konumu, kategorilerde -1
+} CategoryEntry;
+
+typedef struct {
+    CategoryEntry *entries; // Dosya sırası: her kategori ardından odakları
+    int count;
+    int capacity;
+    uint32_t next_id;
+    uint64_t *by_id;    // (ID << 32 | konum) anahtarları, sıralı (ilk aramada kurulur)
+    bool has_file;      // Aşağıdaki kimlik, okunan/yazılan dosyaya ait
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+} CategorySnapshot;
+
 // İstatistikler için yeni veri yapıları
 typedef struct {
-    char name[MAX_FOCUS_NAME_LEN];
+    char *name;
+    uint32_t id;         // Odağın kalıcı ID'si; 0 ise kayıt ID'sizdir ve adla eşlenir
     long total_duration; // Saniye cinsinden toplam süre
     int session_count;   // Oturum sayısı
+    long long log_bytes; // Bu odağın canlı kayıtlarının logda kapladığı bayt
 } StatFocus;
 
 typedef struct {
-    char name[MAX_CATEGORY_NAME_LEN];
-    StatFocus focuses[MAX_FOCUSES_PER_CATEGORY];
+    char *name;
+    uint32_t id;         // Kategorinin kalıcı ID'si; 0 ise adla eşlenir
+    StatFocus *focuses;  // Tablonun arenasında büyüyen dizi
     int num_focuses;
+    int focus_capacity;
 } StatCategory;
 
+// Log satırındaki bir alanın kopyalanmadan gösterimi (tırnaklar hariç)
+typedef struct {
+    const char *ptr;
+    size_t len;
+} LogField;
+
+// work_log.csv'yi pencereler halinde belleğe eşleyip satır satır dolaşan tarayıcı
+typedef struct {
+    int fd;
+    off_t end;              // Taramanın bittiği bayt konumu
+    char *map;              // Geçerli eşleme penceresi
+    size_t map_len;
+    off_t map_offset;       // Pencerenin dosyadaki başlangıcı (sayfa hizalı)
+    off_t pos;              // Bir sonraki satırın başladığı bayt konumu
+    off_t row_offset;       // Geçerli satırın başladığı bayt konumu
+    const char *row;        // Geçerli satır ('\n' hariç)
+    size_t row_len;
+    LogField fields[LOG_MAX_FIELDS];
+    int num_fields;
+} LogScanner;
+
+// Çalışma logunun disk biçimi
+typedef enum {
+    LOG_FORMAT_CSV,     // work_log.csv (varsayılan)
+    LOG_FORMAT_BINARY   // work_log.bin: ad sözlüğü + varint alanlar
+} LogFormat;
+
+// Bilgisayar uykudayken (suspend) geçen sürenin oturuma sayılıp sayılmayacağı
+typedef enum {
+    SUSPEND_POLICY_EXCLUDE, // CLOCK_MONOTONIC: uykuda geçen süre sayılmaz (varsayılan)
+    SUSPEND_POLICY_COUNT    // CLOCK_BOOTTIME: uykuda geçen süre de çalışma sayılır
+} SuspendPolicy;
+
+// Oturum süresini duvar saatinden bağımsız ölçen saat. Tüm değerler milisaniyedir;
+// duvar saati yalnızca kaydedilen başlangıç/bitiş alanları için okunur.
+typedef struct {
+    clockid_t clock;
+    long long start_ms;
+    long long paused_ms;        // Tamamlanmış duraklamaların toplamı
+    long long pause_start_ms;
+    bool paused;
+} SessionClock;
+
+// Log kaydının türü. Silme işaretleri (tombstone) kendilerinden önceki eşleşen
+// oturumları geçersiz kılar; kayıtlar fiziksel olarak sıkıştırmada atılır.
+typedef enum {
+    LOG_RECORD_SESSION,
+    LOG_RECORD_DELETE_CATEGORY,
+    LOG_RECORD_DELETE_FOCUS
+} LogRecordType;
+
+// Biçimden bağımsız tek bir log kaydı. Adlar okuyucunun belleğini gösterir.
+// Silme işaretlerinde start_time silme zamanıdır; kategori silmede focus boştur.
+typedef struct {
+    LogRecordType type;
+    LogField category;
+    LogField focus;
+    uint32_t category_id; // Kalıcı ID'ler (0: ID'siz eski kayıt)
+    uint32_t focus_id;
+    time_t start_time;  // UTC epoch saniyesi
+    time_t end_time;
+    long utc_offset;    // Kayıt anındaki yerel saat farkı (saniye); yalnızca gösterim için
+    long duration;
+    size_t byte_length; // Kaydın logda kapladığı bayt (ölü bayt hesabı için)
+} LogRecord;
+
+// İkili logdaki adları tam sayı ID'lere eşleyen sözlük
+typedef struct {
+    char **names;
+    size_t *lengths;
+    int count;
+    int capacity;
+    int *slots;         // Hash yuvaları: ad ID'si + 1 (0 = boş)
+    int slot_capacity;
+} NameDictionary;
+
+// İkili logu okumak/yazmak için gereken sıralı durum
+typedef struct {
+    NameDictionary dict;
+    time_t last_start;  // Önceki oturumun başlangıcı (fark kodlaması için)
+    long utc_offset;    // Son 'O' kaydıyla bildirilen UTC farkı
+    bool entity_ids;    // Dosya FLOGBIN2: kayıtlar kalıcı ID'leri içerir
+} BinaryLogState;
+
+// CSV logundaki sütunların yeri; başlıktan belirlenir
+typedef struct {
+    bool epoch_times;   // false: eski "YYYY-MM-DD HH:MM:SS" yerel zaman sütunları
+    int min_fields;
+    int start_column;
+    int end_column;
+    int utc_offset_column; // -1: sütun yok
+    int duration_column;
+    int category_id_column; // -1: kalıcı ID sütunları yok
+    int focus_id_column;
+} CsvLogSchema;
+
+// Her iki biçimi de aynı arabirimle okuyan log okuyucusu
+typedef struct {
+    LogScanner scanner;
+    LogFormat format;
+    BinaryLogState *binary_state;
+    CsvLogSchema schema;
+    bool parse_times;   // Eski CSV: zaman metinlerini epoch'a çevir (saat dilimi veritabanını kullanır)
+    off_t skipped_bytes;   // İkili log: çözülemediği için atlanan bozuk baytlar
+    off_t first_skipped;   // İlk bozuk baytın konumu
+} LogReader;
+
+// Her iki biçime de kayıt ekleyebilen log yazıcısı. "a" kipinde her kayıt O_APPEND
+// tanımlayıcıya tek bir write() ile gider ve yazıcı kapanana kadar log kilidi tutulur;
+// "w" kipi yeniden yazıcıların geçici dosyaları içindir (tamponlu, kilitsiz).
+typedef struct {
+    FILE *file;         // "w" kipi
+    int fd;             // "a" kipi (-1: kullanılmıyor)
+    int lock_fd;        // Tutulan log kilidi (-1: yok)
+    LogFormat format;
+    BinaryLogState *binary_state;
+    bool commit_state;  // false ise durum değiştirilmez (kayıtlar daha sonra okuyucu tarafından işlenir)
+} LogWriter;
+
+// Alan ayırıcı çekirdeğinin seviyeleri (çalışma zamanında CPU'ya göre seçilir)
+typedef enum {
+    CSV_KERNEL_SCALAR,
+    CSV_KERNEL_SSE2,
+    CSV_KERNEL_AVX2
+} CsvKernelLevel;
+
+// Kategori/odak adlarını istatistik dizilerindeki indekslere eşleyen hash tablosu yuvası.
+// Kategori girdilerinde focus_id -1'dir; odak girdileri kategori ID'si ile birlikte anahtarlanır.
+typedef struct {
+    unsigned long hash;
+    int category_id;
+    int focus_id;
+    bool used;
+} StatNameSlot;
+
+// İstatistik toplamlarının ve isim indeksinin tutulduğu depo. Diziler ve adlar
+// tablonun kendi arenasındadır; paralel yüklemede her iş parçacığı kendi özel
+// tablosunu doldurur ve sonuçlar global tabloya birleştirilir.
+typedef struct {
+    StatCategory *categories;
+    int num_categories;
+    int category_capacity;
+    StatNameSlot *name_table; // Yarısı dolunca iki katına büyür
+    int name_table_size;
+    int name_table_used;
+    Arena arena;            // Kategori/odak dizileri
+    Arena strings;          // Ad baytları (dize havuzu)
+    long long dead_bytes;   // Silinmiş oturumların ve silme işaretlerinin kapladığı bayt
+    time_t since_time;      // Yalnızca bu andan sonra başlayan oturumlar sayılır (0: tümü)
+    long long corrupt_bytes; // İkili logda çözülemeyip atlanan bayt
+} StatTable;
+
+// Sıkıştırmada kullanılan silme indeksi: her silinen kategori/odak anahtarı için
+// son silme işaretinin log içindeki sıra numarası. Bu sıradan önceki oturumlar ölüdür.
+typedef struct {
+    NameDictionary keys;
+    long *last_sequence;
+} TombstoneIndex;
+
+// Artımlı istatistik yüklemesi için kontrol noktası
+typedef struct {
+    bool valid;
+    dev_t dev;
+    ino_t ino;
+    off_t offset;             // İşlenen son tam satırın bittiği bayt konumu
+    uint64_t log_generation;  // Yüklemedeki log kuşağı; yeniden yazılan log (inode yeniden kullanılsa da) baştan okunur
+    unsigned long tail_hash;  // offset'ten önceki son baytların özeti
+    size_t tail_len;
+} StatCheckpoint;
+
+// Kontrol noktasına göre log için yapılması gereken yükleme
+typedef enum {
+    STATS_LOAD_NONE,    // Görüntü güncel
+    STATS_LOAD_APPEND,  // Yalnızca sona eklenen kayıtlar okunur
+    STATS_LOAD_REBUILD, // Log baştan okunur
+    STATS_LOAD_MISSING  // Log yok
+} StatsLoadKind;
+
+// Arka planda kurulan istatistik görüntüsü (çift tampon). Arayüz öndeki global
+// tabloyu okurken iş parçacığı yalnızca bunu doldurur; bitince arayüz iş parçacığı iki
+// görüntünün yerini değiştirir, böylece yayımlanan görüntü hiçbir zaman yarım olmaz.
+typedef struct {
+    StatTable table;
+    StatCheckpoint checkpoint;
+    BinaryLogState binary_state;
+    char log_path[300];
+    LogFormat format;
+    pthread_t thread;
+    bool running;         // Yalnızca arayüz iş parçacığı okur/yazar
+    bool stale;           // Yapım sürerken görüntü geçersiz kılındı (arayüz)
+    uint64_t log_generation; // Yapım başladığında logun kuşağı ve inode'u; yayımlarken değiştiyse görüntü atılır
+    dev_t log_dev;
+    ino_t log_ino;
+    bool finished;        // İş parçacığı yazar (__atomic), arayüz okur
+    off_t progress_bytes; // İşlenen bayt (__atomic; paralel parçalar birlikte artırır)
+    off_t total_bytes;    // Okunacak toplam bayt (__atomic)
+} StatsBuild;
+
+// Sıralamadaki bir odağın global istatistik tablosundaki konumu
+typedef struct {
+    int category_index;
+    int focus_index;
+    long total_duration;
+} RankedFocus;
+
+// Odakların toplam süreye göre sıralaması. Yalnızca istenen ilk K odak tutulur ve
+// istatistikler değişene (stats_generation artana) kadar yeniden kullanılır.
+typedef struct {
+    RankedFocus *entries;   // Azalan süre sırası; eşitlikte tablo sırası korunur
+    int count;
+    int capacity;
+    int limit;              // Sıralamanın kurulduğu K
+    int num_focuses;        // Tablodaki toplam odak sayısı
+    long total_duration;    // Tüm odakların toplam süresi
+    unsigned long generation;
+    bool valid;
+} FocusRanking;
+
+// Boşta çubuğunun tek renkli bir parçası
+typedef struct {
+    int width;          // Sütun sayısı
+    int color_pair_id;
+} IdleBarSegment;
+
+// "En çok odaklanılan" listesinin bir satırı (adlar kategori modelini gösterir)
+typedef struct {
+    const char *category_name; // NULL: odak artık tanımlı değil
+    const char *focus_name;
+    int category_name_width; // Adların hücre genişlikleri
+    int focus_name_width;
+    int category_color_id;
+    int focus_color_id;
+    long total_duration;
+} IdleTopFocus;
+
+// Boşta ekranının çizime hazır modeli. İstatistikler, kategori modeli veya çubuk
+// genişliği değişene kadar yeniden kullanılır; çizim bu veriler üzerinde düz bir döngüdür.
+typedef struct {
+    IdleBarSegment *segments;
+    int num_segments;
+    int segment_capacity;
+    int filled_width;       // Segmentlerin kapladığı toplam sütun
+    IdleTopFocus top[IDLE_TOP_FOCUS_COUNT];
+    int num_top;
+    int category_column_width;
+    int focus_column_width;
+    long total_duration;
+    int bar_width;
+    unsigned long stats_generation;
+    unsigned long entity_generation;
+    bool valid;
+} IdleRenderModel;
+
+// İstatistik tablosunun sıralama anahtarları ('s' ile sırayla seçilir)
+typedef enum {
+    STATS_SORT_DEFINED,  // Kategori dosyasındaki sıra
+    STATS_SORT_TOTAL,    // Toplam süre
+    STATS_SORT_SESSIONS, // Oturum sayısı
+    STATS_SORT_AVERAGE,  // Ortalama oturum süresi
+    STATS_SORT_NAME,     // Ad
+    STATS_SORT_KEY_COUNT
+} StatsSortKey;
+
+// Tablodaki bir kategori veya odağın sıralanan değerleri
+typedef struct {
+    long total_duration;
+    int session_count;
+} StatsRowValue;
+
+// İstatistik tablosunun kategori modeline bağlı kısmı. Kategori i'nin odakları düz
+// dizilerde focus_base[i] konumundan başlar.
+typedef struct {
+    int *focus_base;         // num_user_categories + 1 eleman; sonuncusu toplam odak sayısı
+    int capacity;
+    int num_rows;            // Gösterilen satır sayısı (başlıklar, odaklar, aradaki boş satırlar)
+    int category_name_width; // En uzun kategori adı
+    int focus_name_width;    // En uzun odak adı
+    unsigned long entity_generation;
+    bool valid;
+} StatsTableLayout;
+
+// Tablonun istatistiklere bağlı değerleri (her odak ve kategori için bir kez çözülür)
+typedef struct {
+    StatsRowValue *focus_values;    // focus_base düzeninde
+    StatsRowValue *category_values;
+    int focus_capacity;
+    int category_capacity;
+    unsigned long stats_generation;
+    unsigned long entity_generation;
+    bool valid;
+} StatsTableValues;
+
+// Bir sıralama anahtarı ve yönü için tablonun dizilişi. Görüntüleme konumu p'deki
+// kategorinin başlığı category_first_row[p] satırındadır; ardından odakları ve bir boş
+// satır gelir. Görünen satırlar buradan ikili aramayla çözülür.
+typedef struct {
+    int *category_order;     // Görüntüleme konumu -> kategori indeksi
+    int *category_first_row; // num_user_categories + 1 eleman; sonuncusu toplam satır sayısı (boş satır dahil)
+    int *focus_order;        // focus_base[i] + k -> kategori i'de k. sıradaki odağın indeksi
+    int category_capacity;
+    int focus_capacity;
+    unsigned long stats_generation;
+    unsigned long entity_generation;
+    bool valid;
+} StatsOrdering;
+
+// İstatistik tablosunun sütun genişlikleri ve konumları (ekran genişliği, dil ve kategori
+// modeli başına bir kez hesaplanır)
+typedef struct {
+    int category_width;
+    int focus_width;
+    int sessions_width;
+    int duration_width; // Ortalama ve toplam süre sütunları
+    int values_start;   // Oturum sütunundan önceki ayırıcının tablo başına göre konumu
+    int line_width;
+    int start_x;        // Tablonun ortalanmış başlangıç sütunu
+    int cols;
+    bool english;
+    unsigned long entity_generation;
+    bool valid;
+} StatsColumnMetrics;
+
+// Menünün yerleşimi. Ad uzunlukları menü açılırken bir kez ölçülür; konumlar yalnızca
+// ekran boyutu değiştiğinde yeniden hesaplanır.
+typedef struct {
+    int max_item_len; // Seçeneklerin ve başlığın en uzunu
+    int title_len;
+    int start_x;
+    int start_y;
+    int title_x;
+} MenuLayout;
+
+// Ekran boyutuna göre bir kez kurulan kalıcı pencereler. Her pencere yalnızca kendi
+// içeriği değiştiğinde yeniden çizilir; doupdate yalnızca farklı hücreleri gönderir.
+typedef struct {
+    WINDOW *header; // Başlık ve tablo sütun başlıkları (üst UI_HEADER_ROWS satır)
+    WINDOW *body;   // Tablo gövdesi (ekran çok küçükse NULL)
+    WINDOW *footer; // Alt bilgi (son UI_FOOTER_ROWS satır)
+    WINDOW *timer;  // Sayaç rakamları (ekranın ortasındaki satır)
+    int body_rows;
+    int rows;
+    int cols;
+} UiLayout;
+
+// Kare başına terminale giden bayt ölçümü. Baytlar, doupdate'in hemen öncesi ve
+// sonrasında iş parçacığının /proc wchar sayacından okunur.
+typedef struct {
+    FILE *log;      // NULL: ölçüm kapalı
+    int io_fd;      // /proc/thread-self/io
+    unsigned long frames;
+    unsigned long long total_bytes;
+} UiFrameStats;
+
+// Arka plan servisinin sahip olduğu etkin oturum. Adlar kopyalanır; servis kategori
+// dosyasına bağlı kalmadan kaydı yazabilir.
+typedef struct {
+    bool active;
+    char category_name[MAX_CATEGORY_NAME_LEN];
+    char focus_name[MAX_FOCUS_NAME_LEN];
+    uint32_t category_id;
+    uint32_t focus_id;
+    long duration_seconds;
+    time_t start_time;      // Yalnızca kaydedilen başlangıç alanı için
+    SessionClock clock;
+    unsigned long token;    // START yanıtında istemciye verilir; sonraki istekler oturumu bununla seçer
+} DaemonSession;
+
+// Servise bağlı bir istemci ve yarım kalmış istek satırı
+typedef struct {
+    int fd;
+    char buffer[DAEMON_LINE_MAX];
+    size_t len;
+} DaemonClient;
+
 
 // --- Global Değişkenler ---
 const char *menu_items_tr[] = {
@@ -77,26 +577,81 @@ const char *menu_items_en[] = {
     "Exit"
 };
 
-Category user_categories[MAX_CATEGORIES];
+Category *user_categories = NULL; // category_arena içinde büyüyen dizi
 int num_user_categories = 0;
+int user_category_capacity = 0;
+Arena category_arena;   // Kategori ve odak dizileri
+Arena category_strings; // Kategori ve odak adları
+uint32_t next_entity_id = 1; // Sıradaki kalıcı kategori/odak ID'si (hiçbir zaman yeniden kullanılmaz)
+CategorySnapshot category_base; // Kategori dosyasının bu örneğin son okuduğu/yazdığı hali
+bool category_model_stale = false; // Kategori dosyası başka bir örnekçe değiştirildi; güvenli noktada birleştirilecek
+int category_model_pins = 0; // >0 iken ekranlar Category/ad işaretçileri tutuyor: model yeniden kurulmaz
+bool menu_reloads_on_category_change = false; // Kategori/odak seçim menüleri değişiklikte MENU_CHOICE_RELOAD döndürür
+EntitySlot *entity_index = NULL; // Kalıcı ID -> user_categories konumu
+int entity_index_size = 0;
+unsigned long entity_generation = 0; // Kategori modeli (ad, renk, konum) her değiştiğinde artar
 int next_available_color_pair_id = MIN_CUSTOM_COLOR_PAIR;
 
 char focuslog_data_dir[256];
 char categories_file_path[300];
+char settings_file_path[300];
+SuspendPolicy suspend_policy = SUSPEND_POLICY_EXCLUDE;
 char work_log_file_path[300];
-
-StatCategory stat_categories[MAX_CATEGORIES]; // İstatistik verileri için
-int num_stat_categories = 0;
+char daemon_socket_path[300];
+char work_log_lock_path[300];
+char categories_lock_path[300];
+char work_log_bin_path[300];
+char stats_cache_path[300];
+LogFormat active_log_format = LOG_FORMAT_CSV; // work_log.bin varsa ikili biçim kullanılır
+BinaryLogState active_binary_state; // Etkin ikili logun okunmuş kısmına ait sözlük ve durum
+BinaryLogState writer_binary_state; // İkili log ekleyicilerinin sözlüğü ve durumu (istatistiklerden bağımsız)
+
+StatTable global_stat_table; // İstatistik verileri ve isim -> indeks tablosu
+StatCheckpoint stats_checkpoint; // Log'un ne kadarının işlendiğini tutar
+StatsBuild stats_build; // Arka planda hazırlanan yeni görüntü (arayüz)
+long long stats_retry_at_ms = 0; // Yapım başlatılamadıysa yeniden deneneceği monotonik an (0: yok)
+StatCheckpoint writer_checkpoint; // writer_binary_state'in logun neresine kadar geldiği
+unsigned long stats_generation = 0; // İstatistikler her değiştiğinde artar
+time_t stats_since_time = 0; // Yalnızca bu andan sonra başlayan oturumlar sayılır (0: tümü; `stats --since`)
+FocusRanking focus_ranking; // draw_idle_bar için önbelleğe alınmış sıralama
+IdleRenderModel idle_render_model; // Boşta ekranının son çizim modeli
+StatsTableLayout stats_table_layout; // view_statistics için önbelleğe alınmış satır düzeni
+StatsTableValues stats_table_values; // Tablodaki her satırın süre/oturum değerleri
+StatsOrdering stats_orderings[STATS_SORT_KEY_COUNT][2]; // [anahtar][0: artan, 1: azalan]
+StatsColumnMetrics stats_column_metrics; // Tablonun son sütun yerleşimi
 
 time_t last_input_time; // Son kullanıcı giriş zamanı
+int event_timer_fd = -1; // Olay döngüsünün son tarih zamanlayıcısı (-1: poll zaman aşımı kullanılır)
+int stats_event_fd = -1; // Arka plan istatistik yapımının eventfd'si (ilk yapımda açılır)
+int data_watch_fd = -1; // Arayüzün veri dizini izleyicisi (-1: inotify yok; değişiklikler dakika başında denetlenir)
+UiLayout ui_layout; // Tablo ve sayaç ekranlarının kalıcı pencereleri
+UiFrameStats ui_frame_stats = { NULL, -1, 0, 0 };
 
 // Renk çiftlerinin başlatılıp başlatılmadığını takip etmek için global dizi
 bool g_initialized_color_pairs[MAX_COLOR_PAIRS];
 
 // --- Fonksiyon Tanımlamaları ---
+// Olay döngüsü: tuş veya son tarih gelene kadar uyumadan bekler
+void event_loop_init();
+long long monotonic_now_ms();
+
+// Oturum saati
+void session_clock_start(SessionClock *clock);
+long long session_clock_elapsed_ms(const SessionClock *clock);
+void session_clock_pause(SessionClock *clock);
+void session_clock_resume(SessionClock *clock);
+int wait_for_key(long long deadline_ms);
+int open_data_watch();
+int drain_data_watch(int watch_fd);
+
+// Ekran katmanı: kalıcı pencereler ve tek noktadan ekran güncellemesi
+const UiLayout *ui_layout_get();
+void ui_frame_stats_init();
+void ui_present(WINDOW *win);
+
 // draw_menu_and_get_choice fonksiyonuna yeni bir parametre eklendi: current_lang_menu_items_for_idle
 int draw_menu_and_get_choice(const char **options, int num_options, const char *title_msg, int initial_highlight, int *color_ids, const char **current_lang_menu_items_for_idle);
-void start_timer_session(const char *category_name, const char *focus_name, int duration_seconds, const char **current_lang_menu_items, int category_color_id, int focus_color_id);
+void start_timer_session(const Category *category, const Focus *focus, int duration_seconds, const char **current_lang_menu_items);
 int get_duration_from_user(const char **current_lang_menu_items);
 void manage_settings(const char **current_lang_menu_items);
 
@@ -106,13 +661,90 @@ int handle_new_focus_creation(Category *cat, const char **current_lang_menu_item
 // Yeni silme fonksiyonları
 void delete_category(int index, const char **current_lang_menu_items);
 void delete_focus(Category *cat, int index, const char **current_lang_menu_items);
-void filter_work_log(const char *deleted_category, const char *deleted_focus); // İstatistik loglarını filtrelemek için yeni fonksiyon
+bool append_work_log_tombstone(const Category *deleted_category, const Focus *deleted_focus); // Silinen kategori/odak için loga silme işareti ekler
+
+// Yeniden adlandırma fonksiyonları (log yeniden yazılmaz; kayıtlar kalıcı ID'ye bağlıdır)
+void rename_category(Category *cat, const char **current_lang_menu_items);
+void rename_focus(Category *cat, int index, const char **current_lang_menu_items);
+
+// Arena ve büyüyen kategori/odak modeli
+void *arena_alloc(Arena *arena, size_t size, size_t align);
+char *arena_strndup(Arena *pool, const char *str, size_t len);
+void *arena_grow_array(Arena *arena, void *items, size_t item_size, int count, int *capacity);
+void arena_free(Arena *arena);
+Category *add_user_category(const char *name, int color_pair_id, uint32_t id);
+Focus *add_user_focus(Category *cat, const char *name, int color_pair_id, uint32_t id);
+void reset_user_categories();
+
+// Kalıcı ID fonksiyonları
+uint32_t allocate_entity_id();
+void rebuild_entity_index();
+bool lookup_entity(uint32_t id, int *category_index, int *focus_index);
+void resolve_record_entity_ids(LogRecord *record);
+
+// Log tarayıcı fonksiyonları
+bool log_scanner_open(LogScanner *scanner, const char *path, off_t start);
+bool log_scanner_open_fd(LogScanner *scanner, int fd, off_t start);
+bool log_scanner_next(LogScanner *scanner);
+void log_scanner_close(LogScanner *scanner);
+int split_log_row(const char *row, size_t len, LogField *fields, int max_fields);
+int split_log_row_scalar(const char *row, size_t len, LogField *fields, int max_fields);
+int split_log_row_with_kernel(CsvKernelLevel level, const char *row, size_t len, LogField *fields, int max_fields);
+CsvKernelLevel detect_csv_kernel_level();
+bool csv_kernel_self_check();
+bool log_field_equals(const LogField *field, const char *str);
+long parse_log_long(const LogField *field);
+const unsigned char *log_scanner_peek(LogScanner *scanner, size_t need, size_t *available);
+
+// Log biçimi fonksiyonları
+const char *active_log_path();
+void detect_active_log_format();
+bool log_reader_open(LogReader *reader, const char *path, LogFormat format, off_t start, BinaryLogState *binary_state);
+bool log_reader_open_fd(LogReader *reader, int fd, LogFormat format, off_t start, BinaryLogState *binary_state);
+bool log_reader_next(LogReader *reader, LogRecord *record);
+void log_reader_close(LogReader *reader);
+bool log_writer_open(LogWriter *writer, const char *path, LogFormat format, const char *mode, BinaryLogState *binary_state, bool commit_state);
+bool log_writer_append(LogWriter *writer, const LogRecord *record);
+bool log_writer_close(LogWriter *writer);
+int lock_data_file(const char *lock_path, int operation);
+void unlock_data_file(int lock_fd);
+int work_log_lock(int operation);
+void work_log_unlock(int lock_fd);
+uint64_t read_work_log_generation();
+void bump_work_log_generation(int lock_fd);
+void binary_log_state_reset(BinaryLogState *state);
+bool copy_work_log(const char *src_path, LogFormat src_format, const char *dst_path, LogFormat dst_format, const TombstoneIndex *tombstones, bool assign_entity_ids, BinaryLogState *final_state);
+bool build_tombstone_index(const char *path, LogFormat format, TombstoneIndex *index);
+bool is_record_deleted(const TombstoneIndex *index, const LogRecord *record, long sequence);
+void tombstone_index_free(TombstoneIndex *index);
+bool compact_work_log();
+bool maybe_compact_work_log();
+bool reset_work_log();
+bool convert_work_log(LogFormat target_format);
+bool upgrade_work_log_schema();
+bool export_work_log(FILE *out);
+bool parse_since_argument(const char *text, time_t now, time_t *since);
+int run_stats_query(int argc, char **argv, FILE *out);
+int run_record_command(int argc, char **argv);
+
+// Arka plan servisi (etkin oturum ve bellekteki toplamlar, Unix soketi üzerinden)
+int run_daemon();
+int run_status_client(int argc, char **argv);
+int daemon_connect();
+bool daemon_request(int fd, const char *request, char *reply, size_t reply_size);
+void format_log_timestamp(time_t epoch, long utc_offset, char *buffer, size_t buffer_size);
 
 
 void load_data();
 void save_data();
+bool sync_category_model();
+bool read_category_snapshot(const char *path, CategorySnapshot *snapshot);
+void category_snapshot_free(CategorySnapshot *snapshot);
+bool merge_category_snapshots(CategorySnapshot *base, CategorySnapshot *ours, CategorySnapshot *theirs, CategorySnapshot *merged);
+void load_settings();
+void save_settings();
 void create_data_directory();
-void record_work_session(const char *category, const char *focus, time_t start_time, time_t end_time, long duration);
+bool record_work_session(const Category *category, const Focus *focus, time_t start_time, time_t end_time, long duration);
 int get_random_color_pair();
 
 void format_duration_string(long total_seconds, char *buffer, size_t buffer_size);
@@ -120,8 +752,35 @@ void format_duration_string(long total_seconds, char *buffer, size_t buffer_size
 // İstatistik fonksiyonları
 void view_statistics(const char **current_lang_menu_items);
 void load_statistics();
-int get_stat_category_index(const char *category_name);
-int get_stat_focus_index(StatCategory *stat_cat, const char *focus_name);
+bool load_stats_cache();
+void save_stats_cache();
+void request_statistics();
+bool drain_statistics_build();
+void sync_binary_log_state();
+void adopt_binary_writer_state(BinaryLogState *state);
+bool statistics_build_progress(int *percent);
+void invalidate_statistics();
+void ingest_log_record(StatTable *table, const LogRecord *record);
+void apply_stat_tombstone(StatTable *table, const LogRecord *record);
+int get_ingest_thread_count();
+int get_stat_category_index(uint32_t category_id);
+int get_stat_focus_index(StatCategory *stat_cat, uint32_t focus_id);
+int intern_stat_category(StatTable *table, uint32_t entity_id, const char *category_name, size_t name_len);
+int intern_stat_focus(StatTable *table, int category_id, uint32_t entity_id, const char *focus_name, size_t name_len);
+void reset_stat_aggregates(StatTable *table);
+const FocusRanking *get_focus_ranking(int limit);
+const IdleRenderModel *get_idle_render_model(int bar_width);
+const StatsTableLayout *get_stats_table_layout();
+const StatsTableValues *get_stats_table_values();
+const StatsOrdering *get_stats_ordering(StatsSortKey key, bool descending);
+const StatsColumnMetrics *get_stats_column_metrics(bool english, int cols);
+void stat_table_free(StatTable *table);
+
+// UTF-8 metnin terminaldeki hücre genişliği ve hücre sınırlı çıktı
+int text_width(const char *text);
+size_t utf8_prefix_len(const char *text, size_t max_bytes);
+void put_cells(WINDOW *win, int y, int x, const char *text, int max_cells);
+void put_clipped(WINDOW *win, int y, int x, const char *text);
 
 // Yeni yardımcı fonksiyon: Kullanıcıdan string girişi al (ESC ile iptal edilebilir)
 int get_string_input(char *buffer, size_t buffer_size, int y, int x, const char *prompt);
@@ -137,10 +796,74 @@ void ensure_all_color_pairs_initialized();
 
 
 // --- Ana Fonksiyon ---
-int main() {
+int main(int argc, char **argv) {
     setlocale(LC_ALL, "");
     srandom(time(NULL));
 
+    // Vektörel log ayrıştırıcısını skaler yola karşı doğrula
+    if (argc > 1 && strcmp(argv[1], "--self-check") == 0) {
+        return csv_kernel_self_check() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Çalışma logunu CSV ve ikili biçim arasında dönüştür
+    if (argc > 1 && strcmp(argv[1], "convert-log") == 0) {
+        if (argc < 3 || (strcmp(argv[2], "binary") != 0 && strcmp(argv[2], "csv") != 0)) {
+            fprintf(stderr, "Kullanım: %s convert-log binary|csv\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        create_data_directory();
+        load_data();
+        upgrade_work_log_schema();
+        return convert_work_log(strcmp(argv[2], "binary") == 0 ? LOG_FORMAT_BINARY : LOG_FORMAT_CSV) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Çalışma logunu okunabilir zamanlarla standart çıktıya aktar
+    if (argc > 1 && strcmp(argv[1], "export-log") == 0) {
+        create_data_directory();
+        load_data(); // Kalıcı ID'li kayıtlar güncel adlarla yazdırılır
+        return export_work_log(stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Betikler ve durum çubukları için ncurses olmadan istatistik sorgusu
+    if (argc > 1 && strcmp(argv[1], "stats") == 0) {
+        create_data_directory();
+        return run_stats_query(argc, argv, stdout);
+    }
+
+    // Etkin oturumu ve toplamları bellekte tutan arka plan servisi
+    if (argc > 1 && strcmp(argv[1], "daemon") == 0) {
+        create_data_directory();
+        return run_daemon();
+    }
+
+    // Servise tek bir istek gönder (varsayılan STATUS); durum çubukları için
+    if (argc > 1 && strcmp(argv[1], "status") == 0) {
+        create_data_directory();
+        return run_status_client(argc, argv);
+    }
+
+    // Arayüz olmadan bir oturum kaydet (betikler için)
+    if (argc > 1 && strcmp(argv[1], "record") == 0) {
+        create_data_directory();
+        return run_record_command(argc, argv);
+    }
+
+    // Silinmiş kayıtları logdan fiziksel olarak at
+    if (argc > 1 && strcmp(argv[1], "compact-log") == 0) {
+        create_data_directory();
+        load_data();
+        upgrade_work_log_schema();
+        struct stat st;
+        long long before = (stat(active_log_path(), &st) == 0) ? (long long)st.st_size : 0;
+        if (!compact_work_log()) {
+            fprintf(stderr, "Hata: Çalışma logu sıkıştırılamadı: %s\n", active_log_path());
+            return EXIT_FAILURE;
+        }
+        long long after = (stat(active_log_path(), &st) == 0) ? (long long)st.st_size : 0;
+        printf("Çalışma logu sıkıştırıldı: %lld -> %lld bayt\n", before, after);
+        return EXIT_SUCCESS;
+    }
+
     create_data_directory();
 
     initscr();
@@ -148,6 +871,9 @@ int main() {
     cbreak();
     keypad(stdscr, TRUE);
     curs_set(0);
+    event_loop_init();
+    ui_frame_stats_init();
+    data_watch_fd = open_data_watch(); // Başka örneklerin eklediği oturumlar ve kategori düzenlemeleri
 
     if (has_colors()) {
         start_color();
@@ -159,7 +885,10 @@ int main() {
     }
 
     load_data();
+    load_settings();
     ensure_all_color_pairs_initialized(); // Yüklenen tüm renk çiftlerini başlat
+    upgrade_work_log_schema(); // Eski logu bir kez epoch zamanlı ve kalıcı ID'li biçime çevir
+    load_stats_cache(); // Son görüntüden başla: log baştan değil, yalnızca kuyruğu okunur
 
     const char *lang_env = getenv("LANG");
     const char **current_main_menu_items;
@@ -177,6 +906,7 @@ int main() {
     last_input_time = time(NULL); // Uygulama başlangıcında zamanı ayarla
 
     while (1) {
+        sync_category_model(); // Ana menüde hiçbir ekran kategori işaretçisi tutmaz
         // draw_menu_and_get_choice fonksiyonuna current_main_menu_items parametresi eklendi
         main_menu_choice = draw_menu_and_get_choice(current_main_menu_items, TOTAL_MAIN_MENU_ITEMS, main_title_msg, 0, NULL, current_main_menu_items);
 
@@ -186,10 +916,13 @@ int main() {
                 int selected_focus_idx = -1;
                 bool return_to_main_menu = false;
                 bool return_to_category_selection = false;
+                category_model_pins++; // Seçilen kategori ve sayaç model işaretçileri tutar
+                menu_reloads_on_category_change = true;
 
                 do { // Category selection loop
                     selected_category_idx = -1; // Reset for re-entry
                     return_to_category_selection = false; // Reset
+                    sync_category_model(); // Liste her kurulmadan önce diğer örneklerin düzenlemeleri uygulanır
 
                     char **temp_category_names = (char **)malloc((num_user_categories + 1) * sizeof(char*));
                     int *temp_category_color_ids = (int *)malloc((num_user_categories + 1) * sizeof(int));
@@ -211,7 +944,9 @@ int main() {
                     free(temp_category_names);
                     free(temp_category_color_ids);
 
-                    if (category_choice == num_user_categories) { // "Yeni Kategori Ekle" seçildi
+                    if (category_choice == MENU_CHOICE_RELOAD) { // Başka bir örnek kategorileri değiştirdi
+                        continue;
+                    } else if (category_choice == num_user_categories) { // "Yeni Kategori Ekle" seçildi
                         int new_cat_idx = handle_new_category_creation(current_main_menu_items);
                         if (new_cat_idx != -1) { // Yeni kategori başarıyla eklendi
                             selected_category_idx = new_cat_idx;
@@ -254,7 +989,19 @@ int main() {
                             free(temp_focus_options);
                             free(temp_focus_color_ids);
 
-                            if (focus_choice == selected_cat->num_focuses) { // "Yeni Odak Ekle" seçildi
+                            if (focus_choice == MENU_CHOICE_RELOAD) {
+                                // Model yeniden kurulur; seçili kategori kalıcı ID'siyle yeniden bulunur
+                                uint32_t selected_cat_id = selected_cat->id;
+                                int unused_focus_idx;
+                                sync_category_model();
+                                if (!lookup_entity(selected_cat_id, &selected_category_idx, &unused_focus_idx)) {
+                                    selected_category_idx = -1; // Kategori silinmiş: kategori seçimine dön
+                                    return_to_category_selection = true;
+                                    break;
+                                }
+                                selected_cat = &user_categories[selected_category_idx];
+                                continue;
+                            } else if (focus_choice == selected_cat->num_focuses) { // "Yeni Odak Ekle" seçildi
                                 int new_focus_idx = handle_new_focus_creation(selected_cat, current_main_menu_items);
                                 if (new_focus_idx != -1) {
                                     selected_focus_idx = new_focus_idx;
@@ -271,12 +1018,10 @@ int main() {
                             if (return_to_category_selection) break; // Exit to category selection
 
                             if (selected_focus_idx != -1) {
-                                const char *final_focus_name = selected_cat->focuses[selected_focus_idx].name;
-                                int final_focus_color_id = selected_cat->focuses[selected_focus_idx].color_pair_id;
-
                                 int duration = get_duration_from_user(current_main_menu_items);
                                 if (duration > 0) { // Duration entered, not cancelled
-                                    start_timer_session(selected_cat->name, final_focus_name, duration, current_main_menu_items, selected_cat->color_pair_id, final_focus_color_id);
+                                    menu_reloads_on_category_change = false;
+                                    start_timer_session(selected_cat, &selected_cat->focuses[selected_focus_idx], duration, current_main_menu_items);
                                     return_to_main_menu = true; // Session finished, go back to main menu
                                 } else if (duration == -1) { // ESC from duration input
                                     selected_focus_idx = -1; // Force re-entry into focus selection loop
@@ -286,13 +1031,17 @@ int main() {
                         } while (selected_focus_idx == -1 && !return_to_category_selection); // Keep looping until a focus is selected or back to category
                     }
                 } while (selected_category_idx == -1 && !return_to_main_menu); // Keep looping until a category is selected or back to main menu
+                menu_reloads_on_category_change = false;
+                category_model_pins--;
                 break; // Exit MENU_START_WORK block
             }
             case MENU_VIEW_STATS:
                 view_statistics(current_main_menu_items);
                 break;
             case MENU_SETTINGS:
+                category_model_pins++; // Ayarlar menüleri kategori işaretçileri tutar
                 manage_settings(current_main_menu_items);
+                category_model_pins--;
                 break;
             case MENU_EXIT:
                 goto end_program;
@@ -301,156 +1050,491 @@ int main() {
 
 end_program:
     save_data();
+    save_stats_cache();
     endwin();
     return 0;
 }
 
 // --- Fonksiyon Implementasyonları ---
 
+// --- Metin Genişliği ---
+
+// UTF-8 metnin terminalde kapladığı hücre sayısı (Türkçe harfler 1, geniş karakterler 2).
+// Geçersiz baytlar ve yazdırılamayan karakterler birer hücre sayılır.
+// Return: hücre sayısı
+int text_width(const char *text) {
+    mbstate_t state;
+    memset(&state, 0, sizeof(state));
+    int width = 0;
+    size_t remaining = strlen(text);
+    while (remaining > 0) {
+        wchar_t wc;
+        size_t len = mbrtowc(&wc, text, remaining, &state);
+        if (len == (size_t)-1 || len == (size_t)-2 || len == 0) {
+            memset(&state, 0, sizeof(state));
+            len = 1;
+            width++;
+        } else {
+            int cells = wcwidth(wc);
+            width += (cells >= 0) ? cells : 1;
+        }
+        text += len;
+        remaining -= len;
+    }
+    return width;
+}
+
+// Metnin en fazla max_bytes baytlık, çok baytlı bir karakteri bölmeyen önek uzunluğu
+// Return: bayt sayısı
+size_t utf8_prefix_len(const char *text, size_t max_bytes) {
+    size_t len = strnlen(text, max_bytes);
+    if (text[len] == '\0') return len;
+    // Kesim noktası bir devam baytına (10xxxxxx) denk geliyorsa karakterin başına dön
+    while (len > 0 && ((unsigned char)text[len] & 0xC0) == 0x80) len--;
+    return len;
+}
+
+// Metni en fazla max_cells hücre olacak şekilde geniş karakter olarak yazar; kesim her zaman
+// karakter sınırındadır ve satır bir alt satıra taşmaz
+void put_cells(WINDOW *win, int y, int x, const char *text, int max_cells) {
+    if (max_cells <= 0) return;
+    wchar_t wide[512];
+    int count = 0;
+    int cells = 0;
+    mbstate_t state;
+    memset(&state, 0, sizeof(state));
+    size_t remaining = strlen(text);
+    while (remaining > 0 && count < (int)(sizeof(wide) / sizeof(wide[0]))) {
+        wchar_t wc;
+        size_t len = mbrtowc(&wc, text, remaining, &state);
+        if (len == (size_t)-1 || len == (size_t)-2 || len == 0) {
+            memset(&state, 0, sizeof(state));
+            wc = L'?'; // Geçersiz bayt
+            len = 1;
+        }
+        int wc_cells = wcwidth(wc);
+        if (wc_cells < 0) wc_cells = 1;
+        if (cells + wc_cells > max_cells) break;
+        wide[count++] = wc;
+        cells += wc_cells;
+        text += len;
+        remaining -= len;
+    }
+    if (count > 0) mvwaddnwstr(win, y, x, wide, count);
+}
+
+// Metni pencerenin sağ kenarında keser (tablo ekrandan genişse satırlar alt satıra taşmaz)
+void put_clipped(WINDOW *win, int y, int x, const char *text) {
+    put_cells(win, y, x, text, getmaxx(win) - x);
+}
+
 // Yeni yardımcı fonksiyon: Kullanıcıdan string girişi al (ESC ile iptal edilebilir)
 // Return: 0 (başarılı), -1 (iptal edildi)
 int get_string_input(char *buffer, size_t buffer_size, int y, int x, const char *prompt) {
-    int input_char;
-    int current_len = 0;
+    wint_t input_char;
+    size_t current_len = 0;
     buffer[0] = '\0'; // Ensure buffer is empty initially
 
     curs_set(1); // Show cursor
     echo();      // Enable echoing input characters
 
     mvprintw(y, x, "%s", prompt);
-    refresh();
+    ui_present(stdscr);
 
-    int input_x = x + strlen(prompt);
+    int input_x = x + text_width(prompt);
 
     while (1) {
         mvprintw(y, input_x, "%s", buffer); // Display current buffer content
         clrtoeol(); // Clear to end of line (to remove any leftover chars if input shrinks)
-        refresh();
+        ui_present(stdscr);
 
-        input_char = getch();
+        // Çok baytlı karakterler (ör. Türkçe harfler) tek bir geniş karakter olarak okunur
+        int status = get_wch(&input_char);
+        if (status == ERR) continue;
+        bool is_key = (status == KEY_CODE_YES);
 
-        if (input_char == 10 || input_char == KEY_ENTER) { // Enter key
+        if ((!is_key && input_char == 10) || (is_key && input_char == KEY_ENTER)) { // Enter key
             curs_set(0); // Hide cursor
             noecho();    // Disable echoing
             return 0; // Success
-        } else if (input_char == 27) { // ESC key
+        } else if (!is_key && input_char == 27) { // ESC key
             curs_set(0);
             noecho();
             return -1; // Canceled
-        } else if (input_char == KEY_BACKSPACE || input_char == 127) { // Backspace (127 for some terminals)
-            if (current_len > 0) {
-                current_len--;
+        } else if ((is_key && input_char == KEY_BACKSPACE) || (!is_key && (input_char == 127 || input_char == 8))) { // Backspace (127 for some terminals)
+            // Son karakterin tüm baytları silinir
+            while (current_len > 0 && ((unsigned char)buffer[current_len - 1] & 0xC0) == 0x80) current_len--;
+            if (current_len > 0) current_len--;
+            buffer[current_len] = '\0';
+            // No need to clear on screen, mvprintw will overwrite
+        } else if (!is_key && iswprint(input_char)) { // Printable character
+            char encoded[MB_LEN_MAX];
+            mbstate_t state;
+            memset(&state, 0, sizeof(state));
+            size_t len = wcrtomb(encoded, (wchar_t)input_char, &state);
+            if (len != (size_t)-1 && current_len + len < buffer_size) {
+                memcpy(buffer + current_len, encoded, len);
+                current_len += len;
                 buffer[current_len] = '\0';
-                // No need to clear on screen, mvprintw will overwrite
             }
-        } else if (current_len < buffer_size - 1 && isprint(input_char)) { // Printable character
-            buffer[current_len++] = input_char;
-            buffer[current_len] = '\0';
         }
     }
 }
 
 
-// draw_menu_and_get_choice fonksiyonuna yeni bir parametre eklendi
-int draw_menu_and_get_choice(const char **options, int num_options, const char *title_msg, int initial_highlight, int *color_ids, const char **current_lang_menu_items_for_idle) {
-    if (num_options == 0) {
-        return -1;
+// --- Olay Döngüsü ---
+
+void event_loop_init() {
+    event_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+}
+
+long long monotonic_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// --- Oturum Saati ---
+
+static long long clock_now_ms(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Saat, suspend_policy'ye göre seçilir. CLOCK_BOOTTIME desteklenmiyorsa uyku süresi
+// sayılamaz ve CLOCK_MONOTONIC kullanılır.
+void session_clock_start(SessionClock *clock) {
+    clock->clock = CLOCK_MONOTONIC;
+#ifdef CLOCK_BOOTTIME
+    struct timespec probe;
+    if (suspend_policy == SUSPEND_POLICY_COUNT && clock_gettime(CLOCK_BOOTTIME, &probe) == 0) {
+        clock->clock = CLOCK_BOOTTIME;
     }
-    int highlight = initial_highlight;
-    int choice = -1;
-    int c;
+#endif
+    clock->start_ms = clock_now_ms(clock->clock);
+    clock->paused_ms = 0;
+    clock->pause_start_ms = 0;
+    clock->paused = false;
+}
+
+// Duraklamalar hariç geçen süre
+long long session_clock_elapsed_ms(const SessionClock *clock) {
+    long long now = clock->paused ? clock->pause_start_ms : clock_now_ms(clock->clock);
+    long long elapsed = now - clock->start_ms - clock->paused_ms;
+    return elapsed > 0 ? elapsed : 0;
+}
+
+void session_clock_pause(SessionClock *clock) {
+    if (clock->paused) return;
+    clock->pause_start_ms = clock_now_ms(clock->clock);
+    clock->paused = true;
+}
+
+void session_clock_resume(SessionClock *clock) {
+    if (!clock->paused) return;
+    clock->paused_ms += clock_now_ms(clock->clock) - clock->pause_start_ms;
+    clock->paused = false;
+}
+
+// stdin'de bir tuş olana veya deadline_ms (monotonik ms) gelene kadar poll() içinde bloklar;
+// arada hiç uyanılmaz. Son tarih bir timerfd'ye mutlak zaman olarak kurulur, böylece
+// tamamlanmamış bir kaçış dizisi gibi boş uyanmalar bekleme süresini kaydırmaz.
+// Veri dizini izleniyorsa başka bir örneğin log veya kategori değişikliğinde de uyanılır:
+// log artımlı olarak hemen yüklenir (büyük işler arka plana verilir), kategori modeli ise
+// category_model_stale ile işaretlenir (modeli yeniden kurmak, işaretçi tutmayan çağıranın
+// işidir). Arka plan istatistik yapımı sürerken ilerlemesi ve bitişi de uyandırır; yapım
+// başlatılamadıysa stats_retry_at_ms'de yeniden denenir.
+// Return: tuş kodu, ERR (son tarihe ulaşıldı), EVENT_DATA_CHANGED (veri dosyaları değişti)
+int wait_for_key(long long deadline_ms) {
+    int watch_fd = data_watch_fd;
+    nodelay(stdscr, TRUE);
+    int ch = getch(); // ncurses tamponunda bekleyen tuş varsa hemen döndür
+    if (ch == ERR && deadline_ms != EVENT_NO_DEADLINE && event_timer_fd != -1) {
+        struct itimerspec deadline = { { 0, 0 }, { deadline_ms / 1000, (deadline_ms % 1000) * 1000000 } };
+        timerfd_settime(event_timer_fd, TFD_TIMER_ABSTIME, &deadline, NULL);
+    }
+
+    bool input_closed = false; // Terminal kapandıysa yalnızca son tarih beklenir (boş döngü olmaz)
+    while (ch == ERR) {
+        int timeout_ms = -1;
+        if (deadline_ms != EVENT_NO_DEADLINE) {
+            long long remaining = deadline_ms - monotonic_now_ms();
+            if (remaining <= 0) break;
+            if (event_timer_fd == -1) timeout_ms = (int)remaining;
+        } else if (input_closed) {
+            break;
+        }
+        if (stats_retry_at_ms != 0) {
+            long long retry_in = stats_retry_at_ms - monotonic_now_ms();
+            if (retry_in < 0) retry_in = 0;
+            if (timeout_ms == -1 || retry_in < timeout_ms) timeout_ms = (int)retry_in;
+        }
+
+        struct pollfd fds[4];
+        int nfds = 0;
+        int input_slot = -1, timer_slot = -1, watch_slot = -1, build_slot = -1;
+        if (!input_closed) {
+            input_slot = nfds;
+            fds[nfds++] = (struct pollfd){ STDIN_FILENO, POLLIN, 0 };
+        }
+        if (deadline_ms != EVENT_NO_DEADLINE && event_timer_fd != -1) {
+            timer_slot = nfds;
+            fds[nfds++] = (struct pollfd){ event_timer_fd, POLLIN, 0 };
+        }
+        if (watch_fd != -1) {
+            watch_slot = nfds;
+            fds[nfds++] = (struct pollfd){ watch_fd, POLLIN, 0 };
+        }
+        if (stats_build.running) {
+            build_slot = nfds;
+            fds[nfds++] = (struct pollfd){ stats_event_fd, POLLIN, 0 };
+        }
+        int ready = poll(fds, nfds, timeout_ms);
+        if (ready == -1 && errno != EINTR) {
+            input_closed = true;
+            continue;
+        }
+
+        if (timer_slot != -1 && (fds[timer_slot].revents & POLLIN)) {
+            uint64_t expirations;
+            if (read(event_timer_fd, &expirations, sizeof(expirations)) < 0) { /* zamanlayıcı zaten boşaltılmış */ }
+        }
+        // Tuş, sinyal (ör. KEY_RESIZE) veya eksik kaçış dizisinin devamı olabilir
+        if (ready == -1 || (input_slot != -1 && fds[input_slot].revents != 0)) {
+            ch = getch();
+            if (ch == ERR && input_slot != -1 && (fds[input_slot].revents & (POLLHUP | POLLERR | POLLNVAL))) {
+                input_closed = true;
+            }
+        }
+        if (ch == ERR && watch_slot != -1 && fds[watch_slot].revents != 0) {
+            // Bekleyen tuşlar önceliklidir; ilgisiz dosyalardaki olaylar beklemeyi kesmez
+            int changes = drain_data_watch(watch_fd);
+            if (changes & DATA_CHANGE_LOG) request_statistics();
+            if (changes & DATA_CHANGE_CATEGORIES) category_model_stale = true;
+            if (changes != 0) ch = EVENT_DATA_CHANGED;
+        }
+        if (ch == ERR && build_slot != -1 && fds[build_slot].revents != 0 && drain_statistics_build()) {
+            ch = EVENT_DATA_CHANGED; // İlerleme veya yayımlanan yeni görüntü
+        }
+        if (ch == ERR && stats_retry_at_ms != 0 && monotonic_now_ms() >= stats_retry_at_ms) {
+            request_statistics();
+            ch = EVENT_DATA_CHANGED; // Hata satırı kalkar veya yeniden deneme zamanı güncellenir
+        }
+    }
+
+    if (deadline_ms != EVENT_NO_DEADLINE && event_timer_fd != -1) {
+        struct itimerspec disarm = { { 0, 0 }, { 0, 0 } };
+        timerfd_settime(event_timer_fd, 0, &disarm, NULL);
+    }
+    nodelay(stdscr, FALSE);
+    return ch;
+}
+
+
+// --- Ekran Katmanı ---
+
+static void ui_layout_free() {
+    if (ui_layout.header != NULL) delwin(ui_layout.header);
+    if (ui_layout.body != NULL) delwin(ui_layout.body);
+    if (ui_layout.footer != NULL) delwin(ui_layout.footer);
+    if (ui_layout.timer != NULL) delwin(ui_layout.timer);
+    memset(&ui_layout, 0, sizeof(ui_layout));
+}
+
+// Pencereleri güncel ekran boyutuna göre döndürür; boyut değişmedikçe aynı pencereler
+// (ve içerikleri) yeniden kullanılır. Başlık, gövde ve alt bilgi sığmıyorsa NULL kalır.
+// Return: pencere düzeni (hiçbir zaman NULL değil)
+const UiLayout *ui_layout_get() {
+    int rows, cols;
+    getmaxyx(stdscr, rows, cols);
+    if (ui_layout.timer != NULL && ui_layout.rows == rows && ui_layout.cols == cols) {
+        return &ui_layout;
+    }
+
+    // Boyut değiştiyse terminalin içeriği artık bilinmiyor (yeniden akıtılmış olabilir):
+    // sonraki kare fark yerine tamamen yeniden yazılır. resizeterm stdscr'nin yeni
+    // alanını değişmiş işaretler; getch bunu pencerelerin üstüne çizmesin diye stdscr
+    // boş olarak alta gönderilir.
+    if (ui_layout.timer != NULL) {
+        clearok(curscr, TRUE);
+        erase();
+        wnoutrefresh(stdscr);
+    }
+    ui_layout_free();
+    ui_layout.rows = rows;
+    ui_layout.cols = cols;
+    ui_layout.timer = newwin(1, cols, rows / 2, 0);
+    int body_rows = rows - UI_HEADER_ROWS - UI_FOOTER_ROWS;
+    if (body_rows > 0) {
+        ui_layout.header = newwin(UI_HEADER_ROWS, cols, 0, 0);
+        ui_layout.body = newwin(body_rows, cols, UI_HEADER_ROWS, 0);
+        ui_layout.footer = newwin(UI_FOOTER_ROWS, cols, rows - UI_FOOTER_ROWS, 0);
+        ui_layout.body_rows = body_rows;
+    }
+    if (ui_layout.header == NULL || ui_layout.body == NULL || ui_layout.footer == NULL) {
+        if (ui_layout.header != NULL) delwin(ui_layout.header);
+        if (ui_layout.body != NULL) delwin(ui_layout.body);
+        if (ui_layout.footer != NULL) delwin(ui_layout.footer);
+        ui_layout.header = ui_layout.body = ui_layout.footer = NULL;
+        ui_layout.body_rows = 0;
+    }
+    return &ui_layout;
+}
+
+// FOCUSLOG_FRAME_LOG ayarlıysa her kare için "kare<TAB>bayt<TAB>toplam" satırı yazılır
+void ui_frame_stats_init() {
+    const char *path = getenv(UI_FRAME_LOG_ENV);
+    if (path == NULL || path[0] == '\0') return;
+
+    int io_fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+    if (io_fd == -1) io_fd = open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+    if (io_fd == -1) return; // Sayaç yoksa ölçüm yapılamaz
+    FILE *log = fopen(path, "a");
+    if (log == NULL) {
+        close(io_fd);
+        return;
+    }
+    setvbuf(log, NULL, _IOLBF, 0);
+    ui_frame_stats.log = log;
+    ui_frame_stats.io_fd = io_fd;
+}
 
+// Return: iş parçacığının şimdiye kadar yazdığı bayt, -1 (okunamadı)
+static long long ui_read_written_bytes() {
+    char buffer[512];
+    ssize_t len = pread(ui_frame_stats.io_fd, buffer, sizeof(buffer) - 1, 0);
+    if (len <= 0) return -1;
+    buffer[len] = '\0';
+    const char *field = strstr(buffer, "wchar:");
+    return (field != NULL) ? atoll(field + strlen("wchar:")) : -1;
+}
+
+// Bekleyen pencereleri (ve verilmişse win'i) tek bir doupdate ile terminale gönderir.
+// ncurses yalnızca önceki kareden farklı hücreleri yazar; ölçüm açıksa karenin baytları kaydedilir.
+void ui_present(WINDOW *win) {
+    if (win != NULL) wnoutrefresh(win);
+    if (ui_frame_stats.log == NULL) {
+        doupdate();
+        return;
+    }
+
+    long long before = ui_read_written_bytes();
+    doupdate();
+    long long after = ui_read_written_bytes();
+    if (before < 0 || after < before) return;
+    ui_frame_stats.frames++;
+    ui_frame_stats.total_bytes += (unsigned long long)(after - before);
+    fprintf(ui_frame_stats.log, "%lu\t%lld\t%llu\n", ui_frame_stats.frames, after - before, ui_frame_stats.total_bytes);
+}
+
+// Menünün konumlarını güncel ekran boyutuna göre yerleştirir (ad uzunlukları önceden ölçülmüştür)
+static void place_menu_layout(MenuLayout *layout, int num_options) {
     int yMax, xMax;
     getmaxyx(stdscr, yMax, xMax);
+    layout->start_x = (xMax - layout->max_item_len) / 2;
+    layout->start_y = (yMax - (num_options * 2 + 2)) / 2;
+    layout->title_x = (xMax - layout->title_len) / 2;
+}
 
-    int max_item_len = 0;
-    for (int i = 0; i < num_options; ++i) {
-        if (options[i] != NULL && strlen(options[i]) > max_item_len) {
-            max_item_len = strlen(options[i]);
+// Tek bir menü seçeneğini vurgulu veya kendi rengiyle çizer
+static void draw_menu_item(const MenuLayout *layout, const char **options, int index, bool highlighted, int *color_ids) {
+    if (highlighted) {
+        attron(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
+        attron(A_BOLD);
+    } else {
+        if (color_ids != NULL && color_ids[index] != 0 && has_colors()) {
+            attron(COLOR_PAIR(color_ids[index]));
+        } else {
+            attron(COLOR_PAIR(COLOR_PAIR_DEFAULT));
         }
     }
-    if (strlen(title_msg) > max_item_len) {
-        max_item_len = strlen(title_msg);
+    if (options[index] != NULL) {
+        mvprintw(layout->start_y + index * 2, layout->start_x, "%s", options[index]);
     }
+    attroff(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
+    attroff(COLOR_PAIR(COLOR_PAIR_DEFAULT));
+    if (color_ids != NULL && color_ids[index] != 0 && !highlighted && has_colors()) {
+        attroff(COLOR_PAIR(color_ids[index]));
+    }
+    attroff(A_BOLD);
+}
 
-    int menu_start_x = (xMax - max_item_len) / 2;
-    int menu_start_y = (yMax - (num_options * 2 + 2)) / 2;
-
-    // Menüyü çiz
-    clear();
+// Başlığı ve tüm seçenekleri çizer (ekran önceden temizlenmiş olmalı)
+static void draw_menu(const MenuLayout *layout, const char **options, int num_options, const char *title_msg, int highlight, int *color_ids) {
     attron(COLOR_PAIR(COLOR_PAIR_TITLE));
-    mvprintw(menu_start_y - 2, (xMax - strlen(title_msg)) / 2, "%s", title_msg);
+    mvprintw(layout->start_y - 2, layout->title_x, "%s", title_msg);
     attroff(COLOR_PAIR(COLOR_PAIR_TITLE));
 
     for (int i = 0; i < num_options; ++i) {
-        if (i == highlight) {
-            attron(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-            attron(A_BOLD);
-        } else {
-            if (color_ids != NULL && color_ids[i] != 0 && has_colors()) {
-                attron(COLOR_PAIR(color_ids[i]));
-            } else {
-                attron(COLOR_PAIR(COLOR_PAIR_DEFAULT));
-            }
-        }
-        if (options[i] != NULL) {
-             mvprintw(menu_start_y + i * 2, menu_start_x, "%s", options[i]);
-        }
-        attroff(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-        attroff(COLOR_PAIR(COLOR_PAIR_DEFAULT));
-        if (color_ids != NULL && color_ids[i] != 0 && i != highlight && has_colors()) {
-            attroff(COLOR_PAIR(color_ids[i]));
+        draw_menu_item(layout, options, i, i == highlight, color_ids);
+    }
+}
+
+// draw_menu_and_get_choice fonksiyonuna yeni bir parametre eklendi
+int draw_menu_and_get_choice(const char **options, int num_options, const char *title_msg, int initial_highlight, int *color_ids, const char **current_lang_menu_items_for_idle) {
+    if (num_options == 0) {
+        return -1;
+    }
+    int highlight = initial_highlight;
+    int choice = -1;
+    int c;
+
+    // Ad uzunlukları menü başına bir kez ölçülür; yeniden boyutlandırmada yalnızca konumlar değişir
+    MenuLayout layout;
+    layout.max_item_len = 0;
+    for (int i = 0; i < num_options; ++i) {
+        if (options[i] != NULL && text_width(options[i]) > layout.max_item_len) {
+            layout.max_item_len = text_width(options[i]);
         }
-        attroff(A_BOLD);
     }
-    refresh();
+    layout.title_len = text_width(title_msg);
+    if (layout.title_len > layout.max_item_len) {
+        layout.max_item_len = layout.title_len;
+    }
+    place_menu_layout(&layout, num_options);
+
+    // Menüyü çiz
+    erase();
+    draw_menu(&layout, options, num_options, title_msg, highlight, color_ids);
+    ui_present(stdscr);
 
     int old_highlight = highlight;
 
-    nodelay(stdscr, TRUE); // getch'i non-blocking yap
     last_input_time = time(NULL); // Menüye girildiğinde zamanı sıfırla
+    long long idle_deadline_ms = monotonic_now_ms() + IDLE_TIMEOUT_SECONDS * 1000LL;
 
     while (1) {
-        c = getch(); // Non-blocking çağrı
+        if (menu_reloads_on_category_change && category_model_stale) {
+            return MENU_CHOICE_RELOAD; // Seçenekler kategori modelinden kurulmuş: çağıran listeyi yeniden kurar
+        }
+        c = wait_for_key(idle_deadline_ms); // Tuş veya boşta kalma süresi dolana kadar uyur
 
-        if (c == ERR) { // Tuş basılmadı
-            if (time(NULL) - last_input_time >= IDLE_TIMEOUT_SECONDS) {
+        if (c == EVENT_DATA_CHANGED) { // Başka bir örnekte değişiklik: tuş sayılmaz, boşta kalma süresi sürer
+            continue;
+        } else if (c == ERR) { // Tuş basılmadı
+            if (monotonic_now_ms() >= idle_deadline_ms) {
                 // current_lang_menu_items_for_idle parametresi kullanıldı
                 draw_idle_bar(current_lang_menu_items_for_idle); // Boşta kalma çubuğunu göster
                 last_input_time = time(NULL); // Boşta kalma çubuğu gösterildikten sonra zamanı sıfırla
+                idle_deadline_ms = monotonic_now_ms() + IDLE_TIMEOUT_SECONDS * 1000LL;
 
-                // Menüyü yeniden çiz (draw_idle_bar ekranı temizlediği için)
-                clear();
-                attron(COLOR_PAIR(COLOR_PAIR_TITLE));
-                mvprintw(menu_start_y - 2, (xMax - strlen(title_msg)) / 2, "%s", title_msg);
-                attroff(COLOR_PAIR(COLOR_PAIR_TITLE));
-
-                for (int i = 0; i < num_options; ++i) {
-                    if (i == highlight) {
-                        attron(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-                        attron(A_BOLD);
-                    } else {
-                        if (color_ids != NULL && color_ids[i] != 0 && has_colors()) {
-                            attron(COLOR_PAIR(color_ids[i]));
-                        } else {
-                            attron(COLOR_PAIR(COLOR_PAIR_DEFAULT));
-                        }
-                    }
-                    if (options[i] != NULL) {
-                        mvprintw(menu_start_y + i * 2, menu_start_x, "%s", options[i]);
-                    }
-                    attroff(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-                    attroff(COLOR_PAIR(COLOR_PAIR_DEFAULT));
-                    if (color_ids != NULL && color_ids[i] != 0 && has_colors()) {
-                        attroff(COLOR_PAIR(color_ids[i]));
-                    }
-                    attroff(A_BOLD);
-                }
+                // Menüyü yeniden çiz (draw_idle_bar ekranı temizlediği için; bu sırada boyut değişmiş olabilir)
+                place_menu_layout(&layout, num_options);
+                clear(); // Boşta ekranının neredeyse tüm hücreleri değişir: ekranı silip yazmak farkı göndermekten ucuzdur
+                draw_menu(&layout, options, num_options, title_msg, highlight, color_ids);
+                ui_present(stdscr);
             }
-            usleep(100000); // CPU kullanımını azaltmak için küçük bir gecikme
             continue; // Tuş basılmadı, döngüye devam et
+        } else if (c == KEY_RESIZE) { // Terminal boyutu değişti: menü hemen yeniden yerleşir
+            place_menu_layout(&layout, num_options);
+            clear(); // Terminalin yeniden akıttığı içerik bilinmediğinden fark yerine tam çizim
+            draw_menu(&layout, options, num_options, title_msg, highlight, color_ids);
+            ui_present(stdscr);
+            continue;
         } else { // Tuş basıldı
             last_input_time = time(NULL); // Kullanıcı giriş yaptığında zamanı güncelle
+            idle_deadline_ms = monotonic_now_ms() + IDLE_TIMEOUT_SECONDS * 1000LL;
             old_highlight = highlight;
 
             switch (c) {
@@ -476,36 +1560,14 @@ int draw_menu_and_get_choice(const char **options, int num_options, const char *
             }
 
             if (choice != -1) {
-                nodelay(stdscr, FALSE); // Blocking moda geri dön
                 return choice;
             }
 
             if (highlight != old_highlight) {
-                // Eski vurguyu kaldır
-                if (color_ids != NULL && color_ids[old_highlight] != 0 && has_colors()) {
-                    attron(COLOR_PAIR(color_ids[old_highlight]));
-                } else {
-                    attron(COLOR_PAIR(COLOR_PAIR_DEFAULT));
-                }
-                attroff(A_BOLD);
-                if (options[old_highlight] != NULL) {
-                    mvprintw(menu_start_y + old_highlight * 2, menu_start_x, "%s", options[old_highlight]);
-                }
-                attroff(COLOR_PAIR(COLOR_PAIR_DEFAULT));
-                if (color_ids != NULL && color_ids[old_highlight] != 0 && has_colors()) {
-                    attroff(COLOR_PAIR(color_ids[old_highlight]));
-                }
-
-                // Yeni vurguyu çiz
-                attron(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-                attron(A_BOLD);
-                if (options[highlight] != NULL) {
-                    mvprintw(menu_start_y + highlight * 2, menu_start_x, "%s", options[highlight]);
-                }
-                attroff(COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-                attroff(A_BOLD);
+                draw_menu_item(&layout, options, old_highlight, false, color_ids); // Eski vurguyu kaldır
+                draw_menu_item(&layout, options, highlight, true, color_ids);      // Yeni vurguyu çiz
             }
-            refresh();
+            ui_present(stdscr);
         }
     }
 }
@@ -527,14 +1589,71 @@ void format_duration_string(long total_seconds, char *buffer, size_t buffer_size
     }
 }
 
-void start_timer_session(const char *category_name, const char *focus_name, int duration_seconds, const char **current_lang_menu_items, int category_color_id, int focus_color_id) {
-    clear();
+// Servisin sahip olduğu oturuma bir istek gönderir. Bağlantı yoksa veya koptuysa yeniden bağlanıp
+// bir kez tekrarlar; isteklerdeki oturum belirteci tekrarın güvenli olmasını sağlar.
+// Return: true (servis yanıt verdi), false (servise ulaşılamadı)
+static bool session_owner_request(int *daemon_fd, const char *request, char *reply, size_t reply_size) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (*daemon_fd == -1) {
+            *daemon_fd = daemon_connect();
+        }
+        if (*daemon_fd != -1 && daemon_request(*daemon_fd, request, reply, reply_size)) {
+            return true;
+        }
+        if (*daemon_fd != -1) {
+            close(*daemon_fd);
+            *daemon_fd = -1;
+        }
+    }
+    return false;
+}
+
+// Zamanlayıcının bitiş ekranı: ortada mesaj ve altında dönüş ipucu; bir tuş bekler
+static void show_timer_result(const char *message, const char *press_key_msg) {
     int yMax, xMax;
     getmaxyx(stdscr, yMax, xMax);
+    erase();
+    mvprintw(yMax / 2, (xMax - text_width(message)) / 2, "%s", message);
+    mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+    ui_present(stdscr);
+    getch();
+}
 
-    time_t start_time_actual = time(NULL);
-    time_t current_time_val;
-    long elapsed_seconds;
+void start_timer_session(const Category *category, const Focus *focus, int duration_seconds, const char **current_lang_menu_items) {
+    const char *category_name = category->name;
+    const char *focus_name = focus->name;
+    int category_color_id = category->color_pair_id;
+    int focus_color_id = focus->color_pair_id;
+    int yMax, xMax;
+    WINDOW *digits = NULL; // Yalnızca saniye değişince yeniden çizilen satır (ekran ortası)
+    bool layout_dirty = true; // Başlangıçta ve her KEY_RESIZE sonrası sabit yazılar yeniden yerleşir
+
+    time_t start_time_actual = time(NULL); // Yalnızca kaydedilen başlangıç alanı için
+    SessionClock session_clock;
+    session_clock_start(&session_clock);
+
+    // Servis çalışıyorsa oturumun tek sahibi odur: kaydı yalnızca o yazar, diğer istemciler durumu
+    // ondan okur. Ekran yerel saatle çizilir. START kabul edildikten sonra bu örnek kaydı hiçbir
+    // zaman kendisi yazmaz; bağlantı koparsa istekler belirteçle yeniden gönderilir, servise hiç
+    // ulaşılamazsa hata gösterilir. Servis yoksa veya başka bir oturum sürüyorsa kayıt yereldir.
+    int daemon_fd = -1;
+    char session_request[DAEMON_LINE_MAX], reply[DAEMON_LINE_MAX];
+    unsigned long session_token = ((unsigned long)getpid() << 32) ^ (unsigned long)time(NULL);
+    snprintf(session_request, sizeof(session_request), "START\t%d\t%u\t%u\t%s\t%s\t%lu",
+             duration_seconds, category->id, focus->id, category_name, focus_name, session_token);
+    bool daemon_owned = session_owner_request(&daemon_fd, session_request, reply, sizeof(reply)) &&
+                        strncmp(reply, "OK", 2) == 0;
+    if (!daemon_owned && daemon_fd != -1) {
+        close(daemon_fd); // Başka bir oturum sürüyor: kayıt yerelde yazılır
+        daemon_fd = -1;
+    }
+    bool daemon_unreachable = false; // Bir duraklatma/devam isteği servise ulaşmadı
+    const char *unreachable_msg = (current_lang_menu_items == menu_items_en)
+        ? "FocusLog service unreachable; the session stays with it and is not recorded here."
+        : "FocusLog servisine ulaşılamadı; oturum serviste kalır, burada kaydedilmez.";
+    const char *write_failed_msg = (current_lang_menu_items == menu_items_en)
+        ? "Could not write the session to the work log!" : "Oturum çalışma loguna yazılamadı!";
+    long long elapsed_ms = 0;
     long remaining_seconds = duration_seconds;
 
     const char *timer_title = (current_lang_menu_items == menu_items_en) ? "Focusing on:" : "Odaklanılıyor:";
@@ -543,30 +1662,40 @@ void start_timer_session(const char *category_name, const char *focus_name, int
     const char *press_esc_to_return_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return to menu..." : "Menüye dönmek için ESC tuşuna basın...";
 
 
-    bool paused = false;
-    time_t pause_start_time = 0;
-    long total_paused_time = 0;
-
     int input_char;
     char last_time_str[20] = "";
     char current_time_str[20];
-
-    if (category_color_id != 0 && has_colors()) attron(COLOR_PAIR(category_color_id));
-    mvprintw(yMax / 2 - 6, (xMax - strlen(category_label) - strlen(category_name) - 2) / 2, "%s %s", category_label, category_name);
-    if (category_color_id != 0 && has_colors()) attroff(COLOR_PAIR(category_color_id));
-
-    if (focus_color_id != 0 && has_colors()) attron(COLOR_PAIR(focus_color_id));
-    mvprintw(yMax / 2 - 4, (xMax - strlen(timer_title) - strlen(focus_name) - 2) / 2, "%s %s", timer_title, focus_name);
-    if (focus_color_id != 0 && has_colors()) attroff(COLOR_PAIR(focus_color_id));
-
-    mvprintw(yMax - 2, (xMax - strlen(pause_msg)) / 2, "%s", pause_msg);
-    refresh();
+    int category_line_len = text_width(category_label) + category->name_width + 2;
+    int focus_line_len = text_width(timer_title) + focus->name_width + 2;
 
     while (1) {
+        if (layout_dirty) {
+            erase();
+            getmaxyx(stdscr, yMax, xMax);
+            digits = ui_layout_get()->timer;
+
+            if (category_color_id != 0 && has_colors()) attron(COLOR_PAIR(category_color_id));
+            mvprintw(yMax / 2 - 6, (xMax - category_line_len) / 2, "%s %s", category_label, category_name);
+            if (category_color_id != 0 && has_colors()) attroff(COLOR_PAIR(category_color_id));
+
+            if (focus_color_id != 0 && has_colors()) attron(COLOR_PAIR(focus_color_id));
+            mvprintw(yMax / 2 - 4, (xMax - focus_line_len) / 2, "%s %s", timer_title, focus_name);
+            if (focus_color_id != 0 && has_colors()) attroff(COLOR_PAIR(focus_color_id));
+
+            mvprintw(yMax - 2, (xMax - text_width(pause_msg)) / 2, "%s", pause_msg);
+            if (daemon_unreachable) {
+                attron(COLOR_PAIR(COLOR_PAIR_RED));
+                mvprintw(yMax - 4, (xMax - text_width(unreachable_msg)) / 2, "%s", unreachable_msg);
+                attroff(COLOR_PAIR(COLOR_PAIR_RED));
+            }
+            last_time_str[0] = '\0'; // Rakamlar yeni konumlarına çizilsin
+            layout_dirty = false;
+        }
+
+        bool paused = session_clock.paused;
         if (!paused) {
-            current_time_val = time(NULL);
-            elapsed_seconds = (long)(current_time_val - start_time_actual - total_paused_time);
-            remaining_seconds = duration_seconds - elapsed_seconds;
+            elapsed_ms = session_clock_elapsed_ms(&session_clock);
+            remaining_seconds = duration_seconds - (long)(elapsed_ms / 1000);
         }
 
         if (remaining_seconds <= 0) {
@@ -575,14 +1704,11 @@ void start_timer_session(const char *category_name, const char *focus_name, int
 
         format_duration_string(remaining_seconds, current_time_str, sizeof(current_time_str));
 
-        if (strcmp(current_time_str, last_time_str) != 0 || (paused && strlen(last_time_str) > 0) || (!paused && strlen(last_time_str) == 0)) {
-            if (strlen(last_time_str) > strlen(current_time_str)) {
-                mvprintw(yMax / 2, (xMax - strlen(last_time_str)) / 2, "%*s", (int)strlen(last_time_str), "");
-            }
-
-            attron(A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-            mvprintw(yMax / 2, (xMax - strlen(current_time_str)) / 2, "%s", current_time_str);
-            attroff(A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
+        if (digits != NULL && strcmp(current_time_str, last_time_str) != 0) {
+            werase(digits);
+            wattron(digits, A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
+            mvwprintw(digits, 0, (xMax - text_width(current_time_str)) / 2, "%s", current_time_str);
+            wattroff(digits, A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
             strcpy(last_time_str, current_time_str);
         }
 
@@ -590,54 +1716,95 @@ void start_timer_session(const char *category_name, const char *focus_name, int
         const char *blank_text = "            ";
         if (paused) {
             attron(COLOR_PAIR(COLOR_PAIR_DEFAULT));
-            mvprintw(yMax / 2 + 2, (xMax - strlen(paused_text)) / 2, "%s", paused_text);
+            mvprintw(yMax / 2 + 2, (xMax - text_width(paused_text)) / 2, "%s", paused_text);
             attroff(COLOR_PAIR(COLOR_PAIR_DEFAULT));
         } else {
-            mvprintw(yMax / 2 + 2, (xMax - strlen(blank_text)) / 2, "%s", blank_text);
+            mvprintw(yMax / 2 + 2, (xMax - text_width(blank_text)) / 2, "%s", blank_text);
         }
 
-        refresh();
+        wnoutrefresh(stdscr); // Sayaç satırı stdscr'de boştur; rakam penceresi üstüne yazılır
+        ui_present(digits);
 
-        nodelay(stdscr, TRUE);
-        input_char = getch();
-        nodelay(stdscr, FALSE);
+        // Duraklatılmışken ekranda değişen bir şey yok: yalnızca tuş beklenir.
+        // Aksi halde gösterilen saniye değiştiğinde uyanılır.
+        long long deadline_ms = EVENT_NO_DEADLINE;
+        if (!paused && remaining_seconds > 0) {
+            deadline_ms = monotonic_now_ms() + (1000 - elapsed_ms % 1000);
+        }
+        input_char = (remaining_seconds > 0) ? wait_for_key(deadline_ms) : ERR;
 
         switch (input_char) {
+            case KEY_RESIZE:
+                layout_dirty = true;
+                break;
             case ' ':
-                paused = !paused;
                 if (paused) {
-                    pause_start_time = time(NULL);
+                    session_clock_resume(&session_clock);
                 } else {
-                    total_paused_time += (time(NULL) - pause_start_time);
+                    session_clock_pause(&session_clock);
+                }
+                if (daemon_owned) {
+                    snprintf(session_request, sizeof(session_request), "%s\t%lu", paused ? "RESUME" : "PAUSE", session_token);
+                    if (!session_owner_request(&daemon_fd, session_request, reply, sizeof(reply)) && !daemon_unreachable) {
+                        daemon_unreachable = true;
+                        layout_dirty = true;
+                    }
                 }
                 break;
             case 27: {
+                if (daemon_owned) {
+                    // Geçen süreyi servis kaydeder ("ERR idle": süre dolunca zaten kaydetti)
+                    snprintf(session_request, sizeof(session_request), "STOP\t%lu", session_token);
+                    bool answered = session_owner_request(&daemon_fd, session_request, reply, sizeof(reply));
+                    if (daemon_fd != -1) close(daemon_fd);
+                    if (!answered) {
+                        show_timer_result(unreachable_msg, press_esc_to_return_msg);
+                    } else if (strcmp(reply, "ERR write") == 0) {
+                        show_timer_result(write_failed_msg, press_esc_to_return_msg);
+                    }
+                    return;
+                }
+                // Duvar saati geri alındıysa bitiş, başlangıçtan önce kaydedilmez
                 time_t end_time = time(NULL);
-                record_work_session(category_name, focus_name, start_time_actual, end_time, elapsed_seconds); // elapsed_seconds kaydedildi
+                elapsed_ms = session_clock_elapsed_ms(&session_clock);
+                if (end_time < start_time_actual) end_time = start_time_actual + (time_t)(elapsed_ms / 1000);
+                // Duraklamalar hariç geçen süre kaydedilir
+                if (!record_work_session(category, focus, start_time_actual, end_time, (long)(elapsed_ms / 1000))) {
+                    show_timer_result(write_failed_msg, press_esc_to_return_msg);
+                }
                 return;
             }
         }
 
         if (remaining_seconds <= 0) {
-            time_t end_time = time(NULL);
-            record_work_session(category_name, focus_name, start_time_actual, end_time, duration_seconds); // Tam süre kaydedildi
-            clear();
+            if (daemon_owned) {
+                // Servis oturumu ya şimdi ya da kendi zamanlayıcısıyla kaydeder
+                snprintf(session_request, sizeof(session_request), "FINISH\t%lu", session_token);
+                bool answered = session_owner_request(&daemon_fd, session_request, reply, sizeof(reply));
+                if (daemon_fd != -1) close(daemon_fd);
+                if (!answered || strcmp(reply, "ERR write") == 0) {
+                    show_timer_result(answered ? write_failed_msg : unreachable_msg, press_esc_to_return_msg);
+                    return;
+                }
+            } else {
+                time_t end_time = time(NULL);
+                if (end_time < start_time_actual) end_time = start_time_actual + duration_seconds;
+                if (!record_work_session(category, focus, start_time_actual, end_time, duration_seconds)) { // Tam süre
+                    show_timer_result(write_failed_msg, press_esc_to_return_msg);
+                    return;
+                }
+            }
             const char *finished_msg = (current_lang_menu_items == menu_items_en) ? "Time's Up! Session Finished!" : "Süre Doldu! Oturum Bitti!";
-            mvprintw(yMax / 2, (xMax - strlen(finished_msg)) / 2, "%s", finished_msg);
-            mvprintw(yMax / 2 + 2, (xMax - strlen(press_esc_to_return_msg)) / 2, "%s", press_esc_to_return_msg); // Updated message
-            refresh();
-            getch();
+            show_timer_result(finished_msg, press_esc_to_return_msg);
             return;
         }
-
-        usleep(100000);
     }
 }
 
 // get_duration_from_user fonksiyonu (ESC ile iptal edilebilir)
 // Return: Süre (saniye cinsinden), -1 (iptal edildi)
 int get_duration_from_user(const char **current_lang_menu_items) {
-    clear();
+    erase();
     int yMax, xMax;
     getmaxyx(stdscr, yMax, xMax);
 
@@ -645,7 +1812,7 @@ int get_duration_from_user(const char **current_lang_menu_items) {
     char input_buffer[10];
     int duration_minutes = 0;
 
-    int result = get_string_input(input_buffer, sizeof(input_buffer), yMax / 2, (xMax - strlen(prompt) - 10) / 2, prompt);
+    int result = get_string_input(input_buffer, sizeof(input_buffer), yMax / 2, (xMax - text_width(prompt) - 10) / 2, prompt);
 
     if (result == -1) { // ESC ile iptal edildi
         return -1;
@@ -654,12 +1821,12 @@ int get_duration_from_user(const char **current_lang_menu_items) {
     duration_minutes = atoi(input_buffer);
 
     if (duration_minutes <= 0) {
-        clear();
+        erase();
         const char *invalid_msg = (current_lang_menu_items == menu_items_en) ? "Invalid duration. Using 25 minutes." : "Geçersiz süre. 25 dakika kullanılıyor.";
-        mvprintw(yMax / 2, (xMax - strlen(invalid_msg)) / 2, "%s", invalid_msg);
+        mvprintw(yMax / 2, (xMax - text_width(invalid_msg)) / 2, "%s", invalid_msg);
         const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-        refresh();
+        mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+        ui_present(stdscr);
         getch();
         return 25 * 60;
     }
@@ -670,22 +1837,22 @@ int get_duration_from_user(const char **current_lang_menu_items) {
 bool get_double_confirmation(const char *message1, const char *message2, const char **current_lang_menu_items) {
     int yMax, xMax;
     getmaxyx(stdscr, yMax, xMax);
-    clear();
+    erase();
 
     attron(COLOR_PAIR(COLOR_PAIR_RED));
-    mvprintw(yMax / 2 - 2, (xMax - strlen(message1)) / 2, "%s", message1);
+    mvprintw(yMax / 2 - 2, (xMax - text_width(message1)) / 2, "%s", message1);
     attroff(COLOR_PAIR(COLOR_PAIR_RED));
-    refresh();
+    ui_present(stdscr);
     int ch1 = getch();
     if (tolower(ch1) != 'y' && tolower(ch1) != 'e') {
         return false;
     }
 
-    clear();
+    erase();
     attron(COLOR_PAIR(COLOR_PAIR_RED));
-    mvprintw(yMax / 2 - 2, (xMax - strlen(message2)) / 2, "%s", message2);
+    mvprintw(yMax / 2 - 2, (xMax - text_width(message2)) / 2, "%s", message2);
     attroff(COLOR_PAIR(COLOR_PAIR_RED));
-    refresh();
+    ui_present(stdscr);
     int ch2 = getch();
     if (tolower(ch2) != 'y' && tolower(ch2) != 'e') {
         return false;
@@ -697,23 +1864,33 @@ bool get_double_confirmation(const char *message1, const char *message2, const c
 void manage_settings(const char **current_lang_menu_items) {
     int yMax, xMax;
 
-    char *settings_options[5]; // 2 yeni seçenek eklendi
+    char *settings_options[7]; // 2 yeni seçenek eklendi
     settings_options[0] = (char*)((current_lang_menu_items == menu_items_en) ? "Add New Category" : "Yeni Kategori Ekle");
     settings_options[1] = (char*)((current_lang_menu_items == menu_items_en) ? "Manage Existing Categories & Focuses" : "Mevcut Kategorileri ve Odakları Yönet");
     settings_options[2] = (char*)((current_lang_menu_items == menu_items_en) ? "Reset All Statistics" : "Tüm İstatistikleri Sıfırla");
     settings_options[3] = (char*)((current_lang_menu_items == menu_items_en) ? "Delete All Categories & Focuses" : "Tüm Odakları ve Kategorileri Sil");
-    settings_options[4] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Main Menu" : "Ana Menüye Geri Dön");
+    settings_options[4] = (char*)((current_lang_menu_items == menu_items_en) ? "Compact Statistics Log" : "İstatistik Logunu Sıkıştır");
+    settings_options[6] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Main Menu" : "Ana Menüye Geri Dön");
 
-    int settings_colors[5]; // Renkleri belirle
+    int settings_colors[7]; // Renkleri belirle
     settings_colors[0] = COLOR_PAIR_DEFAULT;
     settings_colors[1] = COLOR_PAIR_DEFAULT;
     settings_colors[2] = COLOR_PAIR_RED; // Kırmızı
     settings_colors[3] = COLOR_PAIR_RED; // Kırmızı
     settings_colors[4] = COLOR_PAIR_DEFAULT;
+    settings_colors[5] = COLOR_PAIR_DEFAULT;
+    settings_colors[6] = COLOR_PAIR_DEFAULT;
 
     while (1) {
+        // Uyku politikası seçeneği geçerli değeri gösterir
+        if (suspend_policy == SUSPEND_POLICY_COUNT) {
+            settings_options[5] = (char*)((current_lang_menu_items == menu_items_en) ? "Time While Suspended: Counted" : "Uykuda Geçen Süre: Sayılır");
+        } else {
+            settings_options[5] = (char*)((current_lang_menu_items == menu_items_en) ? "Time While Suspended: Not Counted" : "Uykuda Geçen Süre: Sayılmaz");
+        }
+
         // draw_menu_and_get_choice fonksiyonuna current_lang_menu_items parametresi eklendi
-        int selected_option = draw_menu_and_get_choice((const char**)settings_options, 5,
+        int selected_option = draw_menu_and_get_choice((const char**)settings_options, 7,
                                                        (current_lang_menu_items == menu_items_en) ? "Settings" : "Ayarlar", 0, settings_colors, current_lang_menu_items);
         getmaxyx(stdscr, yMax, xMax);
 
@@ -725,10 +1902,10 @@ void manage_settings(const char **current_lang_menu_items) {
                 Category *selected_cat = &user_categories[cat_to_manage_idx];
 
                 while(1) { // Odak veya kategori işlem döngüsü
-                    char **temp_options = (char**)malloc((selected_cat->num_focuses + 3) * sizeof(char*)); // Odaklar + Yeni Odak + Kategoriyi Sil + Geri
-                    int *temp_color_ids = (int*)malloc((selected_cat->num_focuses + 3) * sizeof(int));
+                    char **temp_options = (char**)malloc((selected_cat->num_focuses + 4) * sizeof(char*)); // Odaklar + Yeni Odak + Yeniden Adlandır + Kategoriyi Sil + Geri
+                    int *temp_color_ids = (int*)malloc((selected_cat->num_focuses + 4) * sizeof(int));
                     if (temp_options == NULL || temp_color_ids == NULL) {
-                        clear(); mvprintw(yMax/2, (xMax - strlen("Memory error!"))/2, "Memory error!"); refresh(); getch(); break;
+                        erase(); mvprintw(yMax/2, (xMax - text_width("Memory error!"))/2, "Memory error!"); ui_present(stdscr); getch(); break;
                     }
 
                     int current_option_idx = 0;
@@ -739,6 +1916,8 @@ void manage_settings(const char **current_lang_menu_items) {
                     }
                     temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Add New Focus" : "Yeni Odak Ekle");
                     temp_color_ids[current_option_idx++] = COLOR_PAIR_DEFAULT;
+                    temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Rename This Category" : "Bu Kategoriyi Yeniden Adlandır");
+                    temp_color_ids[current_option_idx++] = COLOR_PAIR_DEFAULT;
                     temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Delete This Category" : "Bu Kategoriyi Sil");
                     temp_color_ids[current_option_idx++] = COLOR_PAIR_RED; // Kırmızı
                     temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Categories" : "Kategorilere Geri Dön");
@@ -758,27 +1937,33 @@ void manage_settings(const char **current_lang_menu_items) {
                     } else if (sub_choice == current_option_idx - 2) { // "Delete This Category"
                         delete_category(cat_to_manage_idx, current_lang_menu_items);
                         break; // Kategori silindiği için kategori seçimine geri dön
-                    } else if (sub_choice == current_option_idx - 3) { // "Add New Focus"
+                    } else if (sub_choice == current_option_idx - 3) { // "Rename This Category"
+                        rename_category(selected_cat, current_lang_menu_items);
+                    } else if (sub_choice == current_option_idx - 4) { // "Add New Focus"
                         handle_new_focus_creation(selected_cat, current_lang_menu_items);
                     } else if (sub_choice != -1 && sub_choice < selected_cat->num_focuses) {
-                        // Odak seçildi, şimdi odak için silme seçeneği sun
-                        char *focus_options[2];
-                        focus_options[0] = (char*)((current_lang_menu_items == menu_items_en) ? "Delete This Focus" : "Bu Odağı Sil");
-                        focus_options[1] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Focus List" : "Odak Listesine Geri Dön");
+                        // Odak seçildi, şimdi odak için yeniden adlandırma/silme seçeneklerini sun
+                        char *focus_options[3];
+                        focus_options[0] = (char*)((current_lang_menu_items == menu_items_en) ? "Rename This Focus" : "Bu Odağı Yeniden Adlandır");
+                        focus_options[1] = (char*)((current_lang_menu_items == menu_items_en) ? "Delete This Focus" : "Bu Odağı Sil");
+                        focus_options[2] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Focus List" : "Odak Listesine Geri Dön");
 
-                        int focus_option_colors[2];
-                        focus_option_colors[0] = COLOR_PAIR_RED; // Kırmızı
-                        focus_option_colors[1] = COLOR_PAIR_DEFAULT;
+                        int focus_option_colors[3];
+                        focus_option_colors[0] = COLOR_PAIR_DEFAULT;
+                        focus_option_colors[1] = COLOR_PAIR_RED; // Kırmızı
+                        focus_option_colors[2] = COLOR_PAIR_DEFAULT;
 
                         char focus_title_buffer[MAX_FOCUS_NAME_LEN + 30];
                         snprintf(focus_title_buffer, sizeof(focus_title_buffer), "%s: %s", (current_lang_menu_items == menu_items_en) ? "Manage Focus" : "Odağı Yönet", selected_cat->focuses[sub_choice].name);
 
                         // draw_menu_and_get_choice fonksiyonuna current_lang_menu_items parametresi eklendi
-                        int delete_focus_choice = draw_menu_and_get_choice((const char**)focus_options, 2, focus_title_buffer, 0, focus_option_colors, current_lang_menu_items);
-                        if (delete_focus_choice == 0) { // "Delete This Focus"
+                        int delete_focus_choice = draw_menu_and_get_choice((const char**)focus_options, 3, focus_title_buffer, 0, focus_option_colors, current_lang_menu_items);
+                        if (delete_focus_choice == 0) { // "Rename This Focus"
+                            rename_focus(selected_cat, sub_choice, current_lang_menu_items);
+                        } else if (delete_focus_choice == 1) { // "Delete This Focus"
                             delete_focus(selected_cat, sub_choice, current_lang_menu_items);
                             // Odak silindiği için odak listesine geri dön (döngü devam edecek ve liste yenilenecek)
-                        } else if (delete_focus_choice == 1 || delete_focus_choice == -1) {
+                        } else if (delete_focus_choice == 2 || delete_focus_choice == -1) {
                             // Geri dön veya ESC, döngü devam edecek
                         }
                     } else if (sub_choice == -1) { // ESC basıldı
@@ -788,19 +1973,19 @@ void manage_settings(const char **current_lang_menu_items) {
             }
         } else if (selected_option == 1) { // "Mevcut Kategorileri ve Odakları Yönet"
             if (num_user_categories == 0) {
-                clear();
+                erase();
                 const char *no_cat_msg = (current_lang_menu_items == menu_items_en) ? "No categories to manage yet. Add some first." : "Henüz yönetilecek kategori yok. Önce ekleyin.";
-                mvprintw(yMax / 2, (xMax - strlen(no_cat_msg)) / 2, "%s", no_cat_msg);
+                mvprintw(yMax / 2, (xMax - text_width(no_cat_msg)) / 2, "%s", no_cat_msg);
                 const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-                mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-                refresh();
+                mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+                ui_present(stdscr);
                 getch();
             } else {
                 while(1) { // Kategori seçim döngüsü
                     char **temp_category_names = (char **)malloc((num_user_categories + 1) * sizeof(char*)); // +1 for "Back" option
                     int *temp_category_color_ids = (int *)malloc((num_user_categories + 1) * sizeof(int));
                     if (temp_category_names == NULL || temp_category_color_ids == NULL) {
-                        clear(); mvprintw(yMax/2, (xMax - strlen("Memory error!"))/2, "Memory error!"); refresh(); getch(); break;
+                        erase(); mvprintw(yMax/2, (xMax - text_width("Memory error!"))/2, "Memory error!"); ui_present(stdscr); getch(); break;
                     }
 
                     for (int i = 0; i < num_user_categories; i++) {
@@ -822,10 +2007,10 @@ void manage_settings(const char **current_lang_menu_items) {
                         Category *selected_cat = &user_categories[cat_to_manage_idx];
 
                         while(1) { // Odak veya kategori işlem döngüsü
-                            char **temp_options = (char**)malloc((selected_cat->num_focuses + 3) * sizeof(char*)); // Odaklar + Yeni Odak + Kategoriyi Sil + Geri
-                            int *temp_color_ids = (int*)malloc((selected_cat->num_focuses + 3) * sizeof(int));
+                            char **temp_options = (char**)malloc((selected_cat->num_focuses + 4) * sizeof(char*)); // Odaklar + Yeni Odak + Yeniden Adlandır + Kategoriyi Sil + Geri
+                            int *temp_color_ids = (int*)malloc((selected_cat->num_focuses + 4) * sizeof(int));
                             if (temp_options == NULL || temp_color_ids == NULL) {
-                                clear(); mvprintw(yMax/2, (xMax - strlen("Memory error!"))/2, "Memory error!"); refresh(); getch(); break;
+                                erase(); mvprintw(yMax/2, (xMax - text_width("Memory error!"))/2, "Memory error!"); ui_present(stdscr); getch(); break;
                             }
 
                             int current_option_idx = 0;
@@ -836,6 +2021,8 @@ void manage_settings(const char **current_lang_menu_items) {
                             }
                             temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Add New Focus" : "Yeni Odak Ekle");
                             temp_color_ids[current_option_idx++] = COLOR_PAIR_DEFAULT;
+                            temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Rename This Category" : "Bu Kategoriyi Yeniden Adlandır");
+                            temp_color_ids[current_option_idx++] = COLOR_PAIR_DEFAULT;
                             temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Delete This Category" : "Bu Kategoriyi Sil");
                             temp_color_ids[current_option_idx++] = COLOR_PAIR_RED; // Kırmızı
                             temp_options[current_option_idx] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Categories" : "Kategorilere Geri Dön");
@@ -855,27 +2042,33 @@ void manage_settings(const char **current_lang_menu_items) {
                             } else if (sub_choice == current_option_idx - 2) { // "Delete This Category"
                                 delete_category(cat_to_manage_idx, current_lang_menu_items);
                                 break; // Kategori silindiği için kategori seçimine geri dön
-                            } else if (sub_choice == current_option_idx - 3) { // "Add New Focus"
+                            } else if (sub_choice == current_option_idx - 3) { // "Rename This Category"
+                                rename_category(selected_cat, current_lang_menu_items);
+                            } else if (sub_choice == current_option_idx - 4) { // "Add New Focus"
                                 handle_new_focus_creation(selected_cat, current_lang_menu_items);
                             } else if (sub_choice != -1 && sub_choice < selected_cat->num_focuses) {
-                                // Odak seçildi, şimdi odak için silme seçeneği sun
-                                char *focus_options[2];
-                                focus_options[0] = (char*)((current_lang_menu_items == menu_items_en) ? "Delete This Focus" : "Bu Odağı Sil");
-                                focus_options[1] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Focus List" : "Odak Listesine Geri Dön");
+                                // Odak seçildi, şimdi odak için yeniden adlandırma/silme seçeneklerini sun
+                                char *focus_options[3];
+                                focus_options[0] = (char*)((current_lang_menu_items == menu_items_en) ? "Rename This Focus" : "Bu Odağı Yeniden Adlandır");
+                                focus_options[1] = (char*)((current_lang_menu_items == menu_items_en) ? "Delete This Focus" : "Bu Odağı Sil");
+                                focus_options[2] = (char*)((current_lang_menu_items == menu_items_en) ? "Back to Focus List" : "Odak Listesine Geri Dön");
 
-                                int focus_option_colors[2];
-                                focus_option_colors[0] = COLOR_PAIR_RED; // Kırmızı
-                                focus_option_colors[1] = COLOR_PAIR_DEFAULT;
+                                int focus_option_colors[3];
+                                focus_option_colors[0] = COLOR_PAIR_DEFAULT;
+                                focus_option_colors[1] = COLOR_PAIR_RED; // Kırmızı
+                                focus_option_colors[2] = COLOR_PAIR_DEFAULT;
 
                                 char focus_title_buffer[MAX_FOCUS_NAME_LEN + 30];
                                 snprintf(focus_title_buffer, sizeof(focus_title_buffer), "%s: %s", (current_lang_menu_items == menu_items_en) ? "Manage Focus" : "Odağı Yönet", selected_cat->focuses[sub_choice].name);
 
                                 // draw_menu_and_get_choice fonksiyonuna current_lang_menu_items parametresi eklendi
-                                int delete_focus_choice = draw_menu_and_get_choice((const char**)focus_options, 2, focus_title_buffer, 0, focus_option_colors, current_lang_menu_items);
-                                if (delete_focus_choice == 0) { // "Delete This Focus"
+                                int delete_focus_choice = draw_menu_and_get_choice((const char**)focus_options, 3, focus_title_buffer, 0, focus_option_colors, current_lang_menu_items);
+                                if (delete_focus_choice == 0) { // "Rename This Focus"
+                                    rename_focus(selected_cat, sub_choice, current_lang_menu_items);
+                                } else if (delete_focus_choice == 1) { // "Delete This Focus"
                                     delete_focus(selected_cat, sub_choice, current_lang_menu_items);
                                     // Odak silindiği için odak listesine geri dön (döngü devam edecek ve liste yenilenecek)
-                                } else if (delete_focus_choice == 1 || delete_focus_choice == -1) {
+                                } else if (delete_focus_choice == 2 || delete_focus_choice == -1) {
                                     // Geri dön veya ESC, döngü devam edecek
                                 }
                             } else if (sub_choice == -1) { // ESC basıldı
@@ -889,22 +2082,18 @@ void manage_settings(const char **current_lang_menu_items) {
             const char *confirm1 = (current_lang_menu_items == menu_items_en) ? "Are you sure you want to reset ALL statistics? (y/N)" : "TÜM istatistikleri sıfırlamak istediğinizden emin misiniz? (e/H)";
             const char *confirm2 = (current_lang_menu_items == menu_items_en) ? "This action cannot be undone. REALLY sure? (y/N)" : "Bu işlem geri alınamaz. GERÇEKTEN emin misiniz? (e/H)";
             if (get_double_confirmation(confirm1, confirm2, current_lang_menu_items)) {
-                FILE *log_file = fopen(work_log_file_path, "w"); // Dosyayı yazma modunda açarak içeriğini sıfırla
-                if (log_file != NULL) {
-                    // CSV başlığını yeniden yaz
-                    fprintf(log_file, "\"Category\",\"Focus\",\"StartTime\",\"EndTime\",\"Duration\"\n");
-                    fclose(log_file);
-                    clear();
+                if (reset_work_log()) { // Logu boşaltıp yalnızca başlığı yaz
+                    erase();
                     const char *success_msg = (current_lang_menu_items == menu_items_en) ? "All statistics reset successfully!" : "Tüm istatistikler başarıyla sıfırlandı!";
-                    mvprintw(yMax / 2, (xMax - strlen(success_msg)) / 2, "%s", success_msg);
+                    mvprintw(yMax / 2, (xMax - text_width(success_msg)) / 2, "%s", success_msg);
                 } else {
-                    clear();
+                    erase();
                     const char *error_msg = (current_lang_menu_items == menu_items_en) ? "Error resetting statistics." : "İstatistikler sıfırlanırken hata oluştu.";
-                    mvprintw(yMax / 2, (xMax - strlen(error_msg)) / 2, "%s", error_msg);
+                    mvprintw(yMax / 2, (xMax - text_width(error_msg)) / 2, "%s", error_msg);
                 }
                 const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-                mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-                refresh();
+                mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+                ui_present(stdscr);
                 getch();
             }
         } else if (selected_option == 3) { // "Tüm Odakları ve Kategorileri Sil"
@@ -914,31 +2103,44 @@ void manage_settings(const char **current_lang_menu_items) {
                 // Kategori ve odak dosyasını sil
                 int cat_del_result = remove(categories_file_path);
                 // İstatistik dosyasını sıfırla (içeriğini boşalt ve başlığı yaz)
-                FILE *log_file = fopen(work_log_file_path, "w");
-                int log_reset_result = -1;
-                if (log_file != NULL) {
-                    fprintf(log_file, "\"Category\",\"Focus\",\"StartTime\",\"EndTime\",\"Duration\"\n");
-                    fclose(log_file);
-                    log_reset_result = 0; // Başarılı sıfırlama
-                }
+                int log_reset_result = reset_work_log() ? 0 : -1;
 
                 if (cat_del_result == 0 && log_reset_result == 0) {
-                    num_user_categories = 0; // Bellekteki veriyi de sıfırla
+                    reset_user_categories(); // Bellekteki veriyi de sıfırla
+                    category_snapshot_free(&category_base); // Dosya yok: taban da boş
+                    rebuild_entity_index();
                     next_available_color_pair_id = MIN_CUSTOM_COLOR_PAIR; // Renk ID'lerini sıfırla
-                    clear();
+                    erase();
                     const char *success_msg = (current_lang_menu_items == menu_items_en) ? "All categories, focuses, and statistics deleted!" : "Tüm kategori, odak ve istatistikler silindi!";
-                    mvprintw(yMax / 2, (xMax - strlen(success_msg)) / 2, "%s", success_msg);
+                    mvprintw(yMax / 2, (xMax - text_width(success_msg)) / 2, "%s", success_msg);
                 } else {
-                    clear();
+                    erase();
                     const char *error_msg = (current_lang_menu_items == menu_items_en) ? "Error deleting categories/focuses." : "Kategori/odaklar silinirken hata oluştu.";
-                    mvprintw(yMax / 2, (xMax - strlen(error_msg)) / 2, "%s", error_msg);
+                    mvprintw(yMax / 2, (xMax - text_width(error_msg)) / 2, "%s", error_msg);
                 }
                 const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-                mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-                refresh();
+                mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+                ui_present(stdscr);
                 getch();
             }
-        } else if (selected_option == 4 || selected_option == -1) {
+        } else if (selected_option == 4) { // "İstatistik Logunu Sıkıştır"
+            // Silinmiş kategori/odakların kayıtlarını logdan fiziksel olarak at
+            erase();
+            if (compact_work_log()) {
+                const char *success_msg = (current_lang_menu_items == menu_items_en) ? "Statistics log compacted." : "İstatistik logu sıkıştırıldı.";
+                mvprintw(yMax / 2, (xMax - text_width(success_msg)) / 2, "%s", success_msg);
+            } else {
+                const char *error_msg = (current_lang_menu_items == menu_items_en) ? "Error compacting statistics log." : "İstatistik logu sıkıştırılırken hata oluştu.";
+                mvprintw(yMax / 2, (xMax - text_width(error_msg)) / 2, "%s", error_msg);
+            }
+            const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın...";
+            mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+            ui_present(stdscr);
+            getch();
+        } else if (selected_option == 5) { // Uyku politikası (sonraki oturumlardan itibaren geçerli)
+            suspend_policy = (suspend_policy == SUSPEND_POLICY_COUNT) ? SUSPEND_POLICY_EXCLUDE : SUSPEND_POLICY_COUNT;
+            save_settings();
+        } else if (selected_option == 6 || selected_option == -1) {
             return;
         }
     }
@@ -947,23 +2149,23 @@ void manage_settings(const char **current_lang_menu_items) {
 // handle_new_category_creation fonksiyonu (ESC ile iptal edilebilir)
 // Return: Yeni kategorinin indeksi (başarılı), -1 (iptal edildi veya hata)
 int handle_new_category_creation(const char **current_lang_menu_items) {
-    clear();
+    erase();
     int yMax, xMax; getmaxyx(stdscr, yMax, xMax);
     const char *prompt = (current_lang_menu_items == menu_items_en) ? "Enter new category name: " : "Yeni kategori adını girin: ";
     char new_cat_name_buffer[MAX_CATEGORY_NAME_LEN];
 
-    int result = get_string_input(new_cat_name_buffer, sizeof(new_cat_name_buffer), yMax / 2, (xMax - strlen(prompt) - MAX_CATEGORY_NAME_LEN) / 2, prompt);
+    int result = get_string_input(new_cat_name_buffer, sizeof(new_cat_name_buffer), yMax / 2, (xMax - text_width(prompt) - MAX_CATEGORY_NAME_LEN) / 2, prompt);
     if (result == -1) { // ESC ile iptal edildi
         return -1;
     }
 
     if (strlen(new_cat_name_buffer) == 0) { // Boş isim girildi
-        clear();
+        erase();
         const char *empty_name_msg = (current_lang_menu_items == menu_items_en) ? "Category name cannot be empty!" : "Kategori adı boş olamaz!";
-        mvprintw(yMax / 2, (xMax - strlen(empty_name_msg)) / 2, "%s", empty_name_msg);
+        mvprintw(yMax / 2, (xMax - text_width(empty_name_msg)) / 2, "%s", empty_name_msg);
         const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-        refresh();
+        mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+        ui_present(stdscr);
         getch();
         return -1;
     }
@@ -971,28 +2173,25 @@ int handle_new_category_creation(const char **current_lang_menu_items) {
     // Kategori zaten var mı kontrol et
     for (int i = 0; i < num_user_categories; i++) { // Hata düzeltildi: i < num_user_categories
         if (strcmp(user_categories[i].name, new_cat_name_buffer) == 0) {
-            clear();
+            erase();
             const char *exists_msg = (current_lang_menu_items == menu_items_en) ? "Category already exists!" : "Kategori zaten mevcut!";
-            mvprintw(yMax / 2, (xMax - strlen(exists_msg)) / 2, "%s", exists_msg);
+            mvprintw(yMax / 2, (xMax - text_width(exists_msg)) / 2, "%s", exists_msg);
             const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-            mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-            refresh();
+            mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+            ui_present(stdscr);
             getch();
             return -1;
         }
     }
 
-    if (num_user_categories < MAX_CATEGORIES) {
-        strcpy(user_categories[num_user_categories].name, new_cat_name_buffer);
-        user_categories[num_user_categories].num_focuses = 0;
-        user_categories[num_user_categories].color_pair_id = get_random_color_pair(); // Bu çağrı renk çiftini başlatır
-        num_user_categories++;
+    // Bu çağrı renk çiftini başlatır
+    if (add_user_category(new_cat_name_buffer, get_random_color_pair(), allocate_entity_id()) != NULL) {
         save_data();
         return num_user_categories - 1; // Yeni eklenen kategorinin indeksini döndür
     } else {
-        clear();
-        mvprintw(yMax/2, (xMax - strlen("Max categories reached!"))/2, "Max categories reached!");
-        refresh(); getch();
+        erase();
+        mvprintw(yMax/2, (xMax - text_width("Out of memory!"))/2, "Out of memory!");
+        ui_present(stdscr); getch();
         return -1;
     }
 }
@@ -1000,23 +2199,23 @@ int handle_new_category_creation(const char **current_lang_menu_items) {
 // handle_new_focus_creation fonksiyonu (ESC ile iptal edilebilir)
 // Return: Yeni odağın indeksi (başarılı), -1 (iptal edildi veya hata)
 int handle_new_focus_creation(Category *cat, const char **current_lang_menu_items) {
-    clear();
+    erase();
     int yMax, xMax; getmaxyx(stdscr, yMax, xMax);
     const char *prompt = (current_lang_menu_items == menu_items_en) ? "Enter new focus name: " : "Yeni odak adını girin: ";
     char new_focus_name_buffer[MAX_FOCUS_NAME_LEN];
 
-    int result = get_string_input(new_focus_name_buffer, sizeof(new_focus_name_buffer), yMax / 2, (xMax - strlen(prompt) - MAX_FOCUS_NAME_LEN) / 2, prompt);
+    int result = get_string_input(new_focus_name_buffer, sizeof(new_focus_name_buffer), yMax / 2, (xMax - text_width(prompt) - MAX_FOCUS_NAME_LEN) / 2, prompt);
     if (result == -1) { // ESC ile iptal edildi
         return -1;
     }
 
     if (strlen(new_focus_name_buffer) == 0) { // Boş isim girildi
-        clear();
+        erase();
         const char *empty_name_msg = (current_lang_menu_items == menu_items_en) ? "Focus name cannot be empty!" : "Odak adı boş olamaz!";
-        mvprintw(yMax / 2, (xMax - strlen(empty_name_msg)) / 2, "%s", empty_name_msg);
+        mvprintw(yMax / 2, (xMax - text_width(empty_name_msg)) / 2, "%s", empty_name_msg);
         const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-        refresh();
+        mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+        ui_present(stdscr);
         getch();
         return -1;
     }
@@ -1024,25 +2223,23 @@ int handle_new_focus_creation(Category *cat, const char **current_lang_menu_item
     // Odak zaten var mı kontrol et
     for (int i = 0; i < cat->num_focuses; i++) {
         if (strcmp(cat->focuses[i].name, new_focus_name_buffer) == 0) {
-            clear();
+            erase();
             const char *exists_msg = (current_lang_menu_items == menu_items_en) ? "Focus already exists in this category!" : "Bu kategoride odak zaten mevcut!";
-            mvprintw(yMax / 2, (xMax - strlen(exists_msg)) / 2, "%s", exists_msg);
+            mvprintw(yMax / 2, (xMax - text_width(exists_msg)) / 2, "%s", exists_msg);
             const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-            mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-            refresh();
+            mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+            ui_present(stdscr);
         }
     }
 
-    if (cat->num_focuses < MAX_FOCUSES_PER_CATEGORY) {
-        strcpy(cat->focuses[cat->num_focuses].name, new_focus_name_buffer);
-        cat->focuses[cat->num_focuses].color_pair_id = get_random_color_pair(); // Bu çağrı renk çiftini başlatır
-        cat->num_focuses++;
+    // Bu çağrı renk çiftini başlatır
+    if (add_user_focus(cat, new_focus_name_buffer, get_random_color_pair(), allocate_entity_id()) != NULL) {
         save_data();
         return cat->num_focuses - 1; // Yeni eklenen odağın indeksini döndür
     } else {
-        clear();
-        mvprintw(yMax/2, (xMax - strlen("Max focuses reached for this category!"))/2, "Max focuses reached for this category!");
-        refresh(); getch();
+        erase();
+        mvprintw(yMax/2, (xMax - text_width("Out of memory!"))/2, "Out of memory!");
+        ui_present(stdscr); getch();
         return -1;
     }
 }
@@ -1052,7 +2249,7 @@ void delete_category(int index, const char **current_lang_menu_items) {
     if (index < 0 || index >= num_user_categories) return;
 
     int yMax, xMax; getmaxyx(stdscr, yMax, xMax);
-    clear();
+    erase();
     const char *confirm_msg1 = (current_lang_menu_items == menu_items_en) ?
                               "Are you sure you want to delete category '%s' and all its focuses? (y/N)" :
                               "'%s' kategorisini ve tüm odaklarını silmek istediğinizden emin misiniz? (e/H)";
@@ -1063,30 +2260,29 @@ void delete_category(int index, const char **current_lang_menu_items) {
     snprintf(buffer1, sizeof(buffer1), confirm_msg1, user_categories[index].name);
 
     if (get_double_confirmation(buffer1, confirm_msg2, current_lang_menu_items)) {
-        // İstatistik loglarından ilgili kategoriye ait tüm kayıtları sil
-        filter_work_log(user_categories[index].name, NULL);
+        // İlgili kategoriye ait kayıtları silindi olarak işaretle (log yeniden yazılmaz)
+        append_work_log_tombstone(&user_categories[index], NULL);
+        maybe_compact_work_log();
 
-        // Kategoriyi listeden kaldır
-        for (int i = index; i < num_user_categories - 1; i++) {
-            user_categories[i] = user_categories[i+1];
-        }
+        // Kategoriyi listeden kaldır (girdiler küçüktür; odak dizileri ve adlar arenada kalır)
+        memmove(&user_categories[index], &user_categories[index + 1], (num_user_categories - index - 1) * sizeof(Category));
         num_user_categories--;
         save_data();
 
-        clear();
+        erase();
         const char *deleted_msg = (current_lang_menu_items == menu_items_en) ? "Category deleted." : "Kategori silindi.";
-        mvprintw(yMax / 2, (xMax - strlen(deleted_msg)) / 2, "%s", deleted_msg);
+        mvprintw(yMax / 2, (xMax - text_width(deleted_msg)) / 2, "%s", deleted_msg);
         const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-        refresh();
+        mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+        ui_present(stdscr);
         getch();
     } else {
-        clear();
+        erase();
         const char *canceled_msg = (current_lang_menu_items == menu_items_en) ? "Deletion canceled." : "Silme işlemi iptal edildi.";
-        mvprintw(yMax / 2, (xMax - strlen(canceled_msg)) / 2, "%s", canceled_msg);
+        mvprintw(yMax / 2, (xMax - text_width(canceled_msg)) / 2, "%s", canceled_msg);
         const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-        refresh();
+        mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+        ui_present(stdscr);
         getch();
     }
 }
@@ -1096,7 +2292,7 @@ void delete_focus(Category *cat, int index, const char **current_lang_menu_items
     if (index < 0 || index >= cat->num_focuses) return;
 
     int yMax, xMax; getmaxyx(stdscr, yMax, xMax);
-    clear();
+    erase();
     const char *confirm_msg1 = (current_lang_menu_items == menu_items_en) ?
                               "Are you sure you want to delete focus '%s'? (y/N)" :
                               "'%s' odağını silmek istediğinizden emin misiniz? (e/H)";
@@ -1107,649 +2303,4488 @@ void delete_focus(Category *cat, int index, const char **current_lang_menu_items
     snprintf(buffer1, sizeof(buffer1), confirm_msg1, cat->focuses[index].name);
 
     if (get_double_confirmation(buffer1, confirm_msg2, current_lang_menu_items)) {
-        // İstatistik loglarından ilgili odağa ait tüm kayıtları sil
-        filter_work_log(cat->name, cat->focuses[index].name);
+        // İlgili odağa ait kayıtları silindi olarak işaretle (log yeniden yazılmaz)
+        append_work_log_tombstone(cat, &cat->focuses[index]);
+        maybe_compact_work_log();
 
         // Odağı listeden kaldır
-        for (int i = index; i < cat->num_focuses - 1; i++) {
-            cat->focuses[i] = cat->focuses[i+1];
-        }
+        memmove(&cat->focuses[index], &cat->focuses[index + 1], (cat->num_focuses - index - 1) * sizeof(Focus));
         cat->num_focuses--;
         save_data();
 
-        clear();
+        erase();
         const char *deleted_msg = (current_lang_menu_items == menu_items_en) ? "Focus deleted." : "Odak silindi.";
-        mvprintw(yMax / 2, (xMax - strlen(deleted_msg)) / 2, "%s", deleted_msg);
+        mvprintw(yMax / 2, (xMax - text_width(deleted_msg)) / 2, "%s", deleted_msg);
         const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-        refresh();
+        mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+        ui_present(stdscr);
         getch();
     } else {
-        clear();
+        erase();
         const char *canceled_msg = (current_lang_menu_items == menu_items_en) ? "Deletion canceled." : "Silme işlemi iptal edildi.";
-        mvprintw(yMax / 2, (xMax - strlen(canceled_msg)) / 2, "%s", canceled_msg);
+        mvprintw(yMax / 2, (xMax - text_width(canceled_msg)) / 2, "%s", canceled_msg);
         const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın..."; // Updated message
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_key_msg)) / 2, "%s", press_key_msg);
-        refresh();
+        mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+        ui_present(stdscr);
         getch();
     }
 }
 
-// work_log.csv dosyasından belirtilen kategori veya odağa ait kayıtları filtreler
-void filter_work_log(const char *deleted_category, const char *deleted_focus) {
-    FILE *src_file = fopen(work_log_file_path, "r");
-    if (src_file == NULL) {
-        // Dosya yoksa veya okunamıyorsa yapacak bir şey yok.
+// Ortak mesaj ekranı: mesajı ve dönüş talimatını gösterip bir tuş bekler
+static void show_rename_message(const char *message, const char **current_lang_menu_items) {
+    int yMax, xMax; getmaxyx(stdscr, yMax, xMax);
+    erase();
+    mvprintw(yMax / 2, (xMax - text_width(message)) / 2, "%s", message);
+    const char *press_key_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return..." : "Geri dönmek için ESC tuşuna basın...";
+    mvprintw(yMax / 2 + 2, (xMax - text_width(press_key_msg)) / 2, "%s", press_key_msg);
+    ui_present(stdscr);
+    getch();
+}
+
+// Kategoriyi yeniden adlandırma fonksiyonu (ESC ile iptal edilebilir).
+// Log kayıtları kategoriye kalıcı ID ile bağlı olduğundan yalnızca kategori dosyası yazılır.
+void rename_category(Category *cat, const char **current_lang_menu_items) {
+    erase();
+    int yMax, xMax; getmaxyx(stdscr, yMax, xMax);
+    const char *prompt = (current_lang_menu_items == menu_items_en) ? "Enter new category name: " : "Yeni kategori adını girin: ";
+    char new_name_buffer[MAX_CATEGORY_NAME_LEN];
+
+    int result = get_string_input(new_name_buffer, sizeof(new_name_buffer), yMax / 2, (xMax - text_width(prompt) - MAX_CATEGORY_NAME_LEN) / 2, prompt);
+    if (result == -1) { // ESC ile iptal edildi
         return;
     }
 
-    char temp_file_path[300];
-    snprintf(temp_file_path, sizeof(temp_file_path), "%s/work_log_temp.csv", focuslog_data_dir);
-    FILE *temp_file = fopen(temp_file_path, "w");
-    if (temp_file == NULL) {
-        fprintf(stderr, "Hata: Geçici dosya oluşturulamadı: %s\n", temp_file_path);
-        fclose(src_file);
+    if (strlen(new_name_buffer) == 0) { // Boş isim girildi
+        show_rename_message((current_lang_menu_items == menu_items_en) ? "Category name cannot be empty!" : "Kategori adı boş olamaz!", current_lang_menu_items);
         return;
     }
 
-    char line_buffer[512];
-
-    // Başlık satırını kopyala
-    if (fgets(line_buffer, sizeof(line_buffer), src_file) != NULL) {
-        fputs(line_buffer, temp_file);
+    // Aynı adlı başka bir kategori var mı kontrol et
+    for (int i = 0; i < num_user_categories; i++) {
+        if (&user_categories[i] != cat && strcmp(user_categories[i].name, new_name_buffer) == 0) {
+            show_rename_message((current_lang_menu_items == menu_items_en) ? "Category already exists!" : "Kategori zaten mevcut!", current_lang_menu_items);
+            return;
+        }
     }
 
-    while (fgets(line_buffer, sizeof(line_buffer), src_file) != NULL) {
-        char temp_line[512];
-        strncpy(temp_line, line_buffer, sizeof(temp_line) - 1);
-        temp_line[sizeof(temp_line) - 1] = '\0';
-        temp_line[strcspn(temp_line, "\n")] = 0; // Yeni satır karakterini kaldır
+    char *new_name = arena_strndup(&category_strings, new_name_buffer, strlen(new_name_buffer));
+    if (new_name == NULL) {
+        show_rename_message("Out of memory!", current_lang_menu_items);
+        return;
+    }
+    cat->name = new_name; // Eski ad model yeniden yüklenene kadar havuzda kalır
+    cat->name_width = text_width(new_name);
+    save_data();
+    show_rename_message((current_lang_menu_items == menu_items_en) ? "Category renamed." : "Kategori yeniden adlandırıldı.", current_lang_menu_items);
+}
 
-        char category_name[MAX_CATEGORY_NAME_LEN];
-        char focus_name[MAX_FOCUS_NAME_LEN];
+// Odağı yeniden adlandırma fonksiyonu (ESC ile iptal edilebilir)
+void rename_focus(Category *cat, int index, const char **current_lang_menu_items) {
+    if (index < 0 || index >= cat->num_focuses) return;
 
-        char *ptr = temp_line;
-        char *start = ptr;
-        bool in_quote = false;
+    erase();
+    int yMax, xMax; getmaxyx(stdscr, yMax, xMax);
+    const char *prompt = (current_lang_menu_items == menu_items_en) ? "Enter new focus name: " : "Yeni odak adını girin: ";
+    char new_name_buffer[MAX_FOCUS_NAME_LEN];
 
-        // Kategori adını al
-        while (*ptr && (in_quote || *ptr != ',')) {
-            if (*ptr == '"') in_quote = !in_quote;
-            ptr++;
-        }
-        strncpy(category_name, start + (*start == '"' ? 1 : 0), (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0));
-        category_name[ (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0) ] = '\0';
+    int result = get_string_input(new_name_buffer, sizeof(new_name_buffer), yMax / 2, (xMax - text_width(prompt) - MAX_FOCUS_NAME_LEN) / 2, prompt);
+    if (result == -1) { // ESC ile iptal edildi
+        return;
+    }
+
+    if (strlen(new_name_buffer) == 0) { // Boş isim girildi
+        show_rename_message((current_lang_menu_items == menu_items_en) ? "Focus name cannot be empty!" : "Odak adı boş olamaz!", current_lang_menu_items);
+        return;
+    }
 
-        // Odak adını al
-        ptr++; // Virgülü geç
-        start = ptr;
-        in_quote = false;
-        while (*ptr && (in_quote || *ptr != ',')) {
-            if (*ptr == '"') in_quote = !in_quote;
-            ptr++;
+    // Bu kategoride aynı adlı başka bir odak var mı kontrol et
+    for (int i = 0; i < cat->num_focuses; i++) {
+        if (i != index && strcmp(cat->focuses[i].name, new_name_buffer) == 0) {
+            show_rename_message((current_lang_menu_items == menu_items_en) ? "Focus already exists in this category!" : "Bu kategoride odak zaten mevcut!", current_lang_menu_items);
+            return;
         }
-        strncpy(focus_name, start + (*start == '"' ? 1 : 0), (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0));
-        focus_name[ (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0) ] = '\0';
+    }
+
+    char *new_name = arena_strndup(&category_strings, new_name_buffer, strlen(new_name_buffer));
+    if (new_name == NULL) {
+        show_rename_message("Out of memory!", current_lang_menu_items);
+        return;
+    }
+    cat->focuses[index].name = new_name;
+    cat->focuses[index].name_width = text_width(new_name);
+    save_data();
+    show_rename_message((current_lang_menu_items == menu_items_en) ? "Focus renamed." : "Odak yeniden adlandırıldı.", current_lang_menu_items);
+}
+
+// --- Log Tarayıcı ---
+
+// Tarayıcının [pos, pos + need) aralığını kapsayan bir pencere eşlemesini sağlar.
+// Dosya RAM'den büyük olsa bile yalnızca bu pencere adres alanında tutulur.
+static bool log_scanner_map(LogScanner *scanner, size_t need) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    off_t map_offset = scanner->pos - (scanner->pos % page_size);
+    size_t map_len = LOG_SCAN_WINDOW_BYTES;
+    if (map_len < need + (size_t)(scanner->pos - map_offset)) {
+        map_len = need + (size_t)(scanner->pos - map_offset);
+    }
+    if ((off_t)map_len > scanner->end - map_offset) {
+        map_len = (size_t)(scanner->end - map_offset);
+    }
+
+    if (scanner->map != NULL) {
+        munmap(scanner->map, scanner->map_len);
+        scanner->map = NULL;
+        scanner->map_len = 0;
+    }
+    if (map_len == 0) {
+        return false;
+    }
+
+    void *map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, scanner->fd, map_offset);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    madvise(map, map_len, MADV_SEQUENTIAL);
+    scanner->map = map;
+    scanner->map_len = map_len;
+    scanner->map_offset = map_offset;
+    return true;
+}
+
+// Return: true (başarılı), false (dosya açılamadı)
+bool log_scanner_open(LogScanner *scanner, const char *path, off_t start) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        memset(scanner, 0, sizeof(*scanner));
+        scanner->fd = -1;
+        return false;
+    }
+    return log_scanner_open_fd(scanner, fd, start);
+}
+
+// Açık bir tanımlayıcı üzerinde tarayıcı kurar; tanımlayıcının sahipliği tarayıcıya geçer.
+// Tarayıcı yalnızca mmap kullandığından aynı dosyanın dup() kopyaları eşzamanlı taranabilir.
+bool log_scanner_open_fd(LogScanner *scanner, int fd, off_t start) {
+    memset(scanner, 0, sizeof(*scanner));
+    scanner->fd = fd;
+
+    struct stat st;
+    if (fstat(scanner->fd, &st) != 0) {
+        close(scanner->fd);
+        scanner->fd = -1;
+        return false;
+    }
+    scanner->end = st.st_size;
+    scanner->pos = (start < scanner->end) ? start : scanner->end;
+    return true;
+}
 
-        // Diğer alanları atla (Başlangıç Zamanı, Bitiş Zamanı, Süre)
-        for (int i = 0; i < 2; i++) {
-            ptr++; // Virgülü geç
-            start = ptr;
-            in_quote = false;
-            while (*ptr && (in_quote || *ptr != ',')) {
-                if (*ptr == '"') in_quote = !in_quote;
-                ptr++;
+// Bir sonraki tam satırı okur ve alanlarına ayırır.
+// Return: true (satır hazır), false (dosya sonu veya henüz '\n' ile bitmemiş son satır)
+bool log_scanner_next(LogScanner *scanner) {
+    size_t need = 1;
+
+    while (scanner->pos < scanner->end) {
+        off_t window_end = scanner->map_offset + (off_t)scanner->map_len;
+        if (scanner->map == NULL || scanner->pos < scanner->map_offset || scanner->pos >= window_end) {
+            if (!log_scanner_map(scanner, need)) {
+                return false;
             }
+            window_end = scanner->map_offset + (off_t)scanner->map_len;
         }
 
-        bool should_delete = false;
-        if (deleted_category != NULL && strcmp(category_name, deleted_category) == 0) {
-            if (deleted_focus == NULL || strcmp(focus_name, deleted_focus) == 0) {
-                should_delete = true;
+        const char *row = scanner->map + (scanner->pos - scanner->map_offset);
+        size_t available = (size_t)(window_end - scanner->pos);
+        const char *newline = memchr(row, '\n', available);
+
+        if (newline == NULL) {
+            if (window_end >= scanner->end) {
+                return false; // Yazımı süren son satır
             }
+            // Satır pencere sınırını aşıyor: pencereyi satırın başından yeniden eşle
+            need = available * 2;
+            if (!log_scanner_map(scanner, need)) {
+                return false;
+            }
+            continue;
         }
 
-        if (!should_delete) {
-            fputs(line_buffer, temp_file); // Orijinal satırı yeni dosyaya yaz
+        scanner->row = row;
+        scanner->row_len = (size_t)(newline - row);
+        scanner->row_offset = scanner->pos;
+        scanner->pos += (off_t)scanner->row_len + 1;
+
+        size_t len = scanner->row_len;
+        if (len > 0 && row[len - 1] == '\r') len--;
+        scanner->num_fields = split_log_row(row, len, scanner->fields, LOG_MAX_FIELDS);
+        return true;
+    }
+    return false;
+}
+
+// Geçerli konumdan itibaren en az 'need' baytın (dosya sonu izin verdiği ölçüde)
+// eşlendiğinden emin olur ve bu baytları gösterir. Konum ilerletilmez.
+const unsigned char *log_scanner_peek(LogScanner *scanner, size_t need, size_t *available) {
+    *available = 0;
+    if (scanner->pos >= scanner->end) {
+        return NULL;
+    }
+    if ((off_t)need > scanner->end - scanner->pos) {
+        need = (size_t)(scanner->end - scanner->pos);
+    }
+    off_t window_end = scanner->map_offset + (off_t)scanner->map_len;
+    if (scanner->map == NULL || scanner->pos < scanner->map_offset || scanner->pos + (off_t)need > window_end) {
+        if (!log_scanner_map(scanner, need)) {
+            return NULL;
         }
+        window_end = scanner->map_offset + (off_t)scanner->map_len;
     }
+    *available = (size_t)(window_end - scanner->pos);
+    return (const unsigned char *)scanner->map + (scanner->pos - scanner->map_offset);
+}
 
-    fclose(src_file);
-    fclose(temp_file);
+void log_scanner_close(LogScanner *scanner) {
+    if (scanner->map != NULL) {
+        munmap(scanner->map, scanner->map_len);
+    }
+    if (scanner->fd != -1) {
+        close(scanner->fd);
+    }
+    scanner->map = NULL;
+    scanner->fd = -1;
+}
 
-    // Orijinal dosyayı sil ve geçici dosyayı yeniden adlandır
-    remove(work_log_file_path);
-    rename(temp_file_path, work_log_file_path);
+// Alanın başındaki ve sonundaki tırnakları atarak bir LogField oluşturur
+static LogField make_log_field(const char *start, const char *end) {
+    LogField field = { start, (size_t)(end - start) };
+    if (field.len > 0 && *field.ptr == '"') {
+        field.ptr++;
+        field.len--;
+        if (field.len > 0 && field.ptr[field.len - 1] == '"') field.len--;
+    }
+    return field;
 }
 
+// Satırı virgülle ayrılmış alanlara böler; tırnak içindeki virgüller alanı bölmez.
+// Alanlar satırın içini gösterir, dıştaki tırnaklar hariç tutulur.
+// Bu memchr tabanlı sürüm, vektörel çekirdeğin referans (skaler) yoludur.
+// Return: Bulunan alan sayısı
+int split_log_row_scalar(const char *row, size_t len, LogField *fields, int max_fields) {
+    const char *p = row;
+    const char *row_end = row + len;
+    int num_fields = 0;
+
+    while (num_fields < max_fields) {
+        const char *start = p;
+        const char *delim;
+
+        // Tırnak dışındayken sıradaki virgülü ara; arada tırnak varsa kapanışını atla
+        while (1) {
+            delim = memchr(p, ',', row_end - p);
+            const char *limit = delim ? delim : row_end;
+            const char *quote = memchr(p, '"', limit - p);
+            if (quote == NULL) break;
+            const char *closing = memchr(quote + 1, '"', row_end - (quote + 1));
+            if (closing == NULL) {
+                delim = NULL;
+                break;
+            }
+            p = closing + 1;
+        }
+        const char *field_end = delim ? delim : row_end;
+
+        fields[num_fields++] = make_log_field(start, field_end);
 
-void create_data_directory() {
-    const char *home_dir = getenv("HOME");
-    if (home_dir == NULL) {
-        fprintf(stderr, "Hata: HOME ortam değişkeni bulunamadı.\n");
-        exit(EXIT_FAILURE);
+        if (delim == NULL) break;
+        p = delim + 1;
     }
+    return num_fields;
+}
 
-    snprintf(focuslog_data_dir, sizeof(focuslog_data_dir), "%s/.config/focuslog", home_dir);
+// 64 baytlık bir bloktaki tırnak ve virgül konumlarını bit maskesi olarak çıkarır
+typedef void (*CsvClassifyFn)(const unsigned char *block, uint64_t *quote_mask, uint64_t *comma_mask);
 
-    if (mkdir(focuslog_data_dir, 0755) == -1 && errno != EEXIST) {
-        fprintf(stderr, "Hata: Dizin oluşturulamadı: %s\n", focuslog_data_dir);
-        exit(EXIT_FAILURE);
+static void csv_classify_scalar(const unsigned char *block, uint64_t *quote_mask, uint64_t *comma_mask) {
+    uint64_t quotes = 0, commas = 0;
+    for (int i = 0; i < CSV_KERNEL_BLOCK_BYTES; i++) {
+        quotes |= (uint64_t)(block[i] == '"') << i;
+        commas |= (uint64_t)(block[i] == ',') << i;
     }
-
-    snprintf(categories_file_path, sizeof(categories_file_path), "%s/categories_and_focuses.txt", focuslog_data_dir);
-    snprintf(work_log_file_path, sizeof(work_log_file_path), "%s/work_log.csv", focuslog_data_dir);
+    *quote_mask = quotes;
+    *comma_mask = commas;
 }
 
-void load_data() {
-    FILE *file = fopen(categories_file_path, "r");
-    if (file == NULL) {
-        num_user_categories = 0;
-        return;
+#ifdef FOCUSLOG_HAVE_X86_SIMD
+static void csv_classify_sse2(const unsigned char *block, uint64_t *quote_mask, uint64_t *comma_mask) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i comma = _mm_set1_epi8(',');
+    uint64_t quotes = 0, commas = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(block + i * 16));
+        quotes |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)) << (i * 16);
+        commas |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, comma)) << (i * 16);
     }
+    *quote_mask = quotes;
+    *comma_mask = commas;
+}
 
-    num_user_categories = 0;
-    next_available_color_pair_id = MIN_CUSTOM_COLOR_PAIR;
+__attribute__((target("avx2")))
+static void csv_classify_avx2(const unsigned char *block, uint64_t *quote_mask, uint64_t *comma_mask) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i comma = _mm256_set1_epi8(',');
+    __m256i lo = _mm256_loadu_si256((const __m256i *)block);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(block + 32));
+    *quote_mask = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)) |
+                  (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)) << 32;
+    *comma_mask = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, comma)) |
+                  (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, comma)) << 32;
+}
+#endif
+
+// Her bitin kendisinden önceki (kendisi dahil) tüm bitlerin XOR'u ile değiştirildiği maske.
+// Tırnak maskesine uygulandığında açılış tırnağından kapanışa kadar olan baytlar 1 olur.
+static inline uint64_t prefix_xor(uint64_t mask) {
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    mask ^= mask << 16;
+    mask ^= mask << 32;
+    return mask;
+}
 
-    char line[MAX_CATEGORY_NAME_LEN + MAX_FOCUS_NAME_LEN + 5 + 10];
-    while (fgets(line, sizeof(line), file) != NULL) {
-        line[strcspn(line, "\n")] = 0;
+CsvKernelLevel detect_csv_kernel_level() {
+#ifdef FOCUSLOG_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return CSV_KERNEL_AVX2;
+    if (__builtin_cpu_supports("sse2")) return CSV_KERNEL_SSE2;
+#endif
+    return CSV_KERNEL_SCALAR;
+}
 
-        if (strlen(line) == 0) continue;
+// Satırı, 64 baytlık bloklar halinde tırnak/virgül maskeleri çıkararak alanlara böler.
+// Tırnak içi bölgeler prefix-XOR ile bulunur; bloklar arası durum 'carry' ile taşınır.
+// Sonuç split_log_row_scalar ile birebir aynıdır.
+int split_log_row_with_kernel(CsvKernelLevel level, const char *row, size_t len, LogField *fields, int max_fields) {
+    CsvClassifyFn classify = csv_classify_scalar;
+#ifdef FOCUSLOG_HAVE_X86_SIMD
+    if (level == CSV_KERNEL_AVX2) classify = csv_classify_avx2;
+    else if (level == CSV_KERNEL_SSE2) classify = csv_classify_sse2;
+#endif
+
+    const char *field_start = row;
+    int num_fields = 0;
+    uint64_t carry = 0; // Önceki blok tırnak içinde bittiyse tüm bitler 1
+
+    if (max_fields <= 0) return 0;
+
+    for (size_t offset = 0; offset < len; offset += CSV_KERNEL_BLOCK_BYTES) {
+        unsigned char padded[CSV_KERNEL_BLOCK_BYTES];
+        const unsigned char *block = (const unsigned char *)row + offset;
+        if (len - offset < CSV_KERNEL_BLOCK_BYTES) {
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded, block, len - offset);
+            block = padded;
+        }
 
-        if (line[0] == '#') {
-            if (num_user_categories < MAX_CATEGORIES) {
-                char *temp_line = strdup(line + 1);
-                if (temp_line == NULL) { continue; }
-
-                char *name_part = strtok(temp_line, ";");
-                char *id_part = strtok(NULL, ";");
-
-                if (name_part != NULL) {
-                    strncpy(user_categories[num_user_categories].name, name_part, MAX_CATEGORY_NAME_LEN - 1);
-                    user_categories[num_user_categories].name[MAX_CATEGORY_NAME_LEN - 1] = '\0';
-                    user_categories[num_user_categories].num_focuses = 0;
-                    if (id_part != NULL) {
-                        user_categories[num_user_categories].color_pair_id = atoi(id_part);
-                        if (user_categories[num_user_categories].color_pair_id >= next_available_color_pair_id) {
-                            next_available_color_pair_id = user_categories[num_user_categories].color_pair_id + 1;
-                        }
-                    } else {
-                        // Eğer renk ID'si dosyada yoksa yeni bir tane ata
-                        user_categories[num_user_categories].color_pair_id = get_random_color_pair();
-                    }
-                    // init_pair çağrısı ensure_all_color_pairs_initialized() içinde yapılacak
-                    num_user_categories++;
-                }
-                free(temp_line);
-            }
-        } else {
-            if (num_user_categories > 0) {
-                Category *current_cat = &user_categories[num_user_categories - 1];
-                if (current_cat->num_focuses < MAX_FOCUSES_PER_CATEGORY) {
-                    char *temp_line = strdup(line);
-                    if (temp_line == NULL) { continue; }
-
-                    char *name_part = strtok(temp_line, ";");
-                    char *id_part = strtok(NULL, ";");
-
-                    if (name_part != NULL) {
-                        strncpy(current_cat->focuses[current_cat->num_focuses].name, name_part, MAX_FOCUS_NAME_LEN - 1);
-                        current_cat->focuses[current_cat->num_focuses].name[MAX_FOCUS_NAME_LEN - 1] = '\0';
-                        if (id_part != NULL) {
-                            current_cat->focuses[current_cat->num_focuses].color_pair_id = atoi(id_part);
-                            if (current_cat->focuses[current_cat->num_focuses].color_pair_id >= next_available_color_pair_id) {
-                                next_available_color_pair_id = current_cat->focuses[current_cat->num_focuses].color_pair_id + 1;
-                            }
-                        } else {
-                            // Eğer renk ID'si dosyada yoksa yeni bir tane ata
-                            current_cat->focuses[current_cat->num_focuses].color_pair_id = get_random_color_pair();
-                        }
-                        // init_pair çağrısı ensure_all_color_pairs_initialized() içinde yapılacak
-                        current_cat->num_focuses++;
-                    }
-                    free(temp_line);
-                }
-            }
+        uint64_t quote_mask, comma_mask;
+        classify(block, &quote_mask, &comma_mask);
+
+        uint64_t in_quote = prefix_xor(quote_mask) ^ carry;
+        carry = (uint64_t)((int64_t)in_quote >> 63);
+        uint64_t delimiters = comma_mask & ~in_quote;
+
+        while (delimiters != 0) {
+            const char *delim = row + offset + __builtin_ctzll(delimiters);
+            fields[num_fields++] = make_log_field(field_start, delim);
+            if (num_fields == max_fields) return num_fields;
+            field_start = delim + 1;
+            delimiters &= delimiters - 1;
         }
     }
-    fclose(file);
+
+    fields[num_fields++] = make_log_field(field_start, row + len);
+    return num_fields;
 }
 
-void save_data() {
-    FILE *file = fopen(categories_file_path, "w");
-    if (file == NULL) {
-        fprintf(stderr, "Hata: Kategori ve odak dosyasına yazılamadı: %s\n", categories_file_path);
-        return;
-    }
+// Çekirdek seviyesi bir kez belirlenir; paralel yükleme ve arka plan yapımı iş parçacıkları
+// aynı anda ilk satırlarını ayırabildiğinden tespit pthread_once ile yapılır
+static CsvKernelLevel csv_kernel_level = CSV_KERNEL_SCALAR;
+static pthread_once_t csv_kernel_once = PTHREAD_ONCE_INIT;
 
-    for (int i = 0; i < num_user_categories; i++) {
-        fprintf(file, "#%s;%d\n", user_categories[i].name, user_categories[i].color_pair_id);
-        for (int j = 0; j < user_categories[i].num_focuses; j++) {
-            fprintf(file, "%s;%d\n", user_categories[i].focuses[j].name, user_categories[i].focuses[j].color_pair_id);
-        }
+static void detect_csv_kernel_once(void) {
+    csv_kernel_level = detect_csv_kernel_level();
+}
+
+int split_log_row(const char *row, size_t len, LogField *fields, int max_fields) {
+    pthread_once(&csv_kernel_once, detect_csv_kernel_once);
+    if (csv_kernel_level == CSV_KERNEL_SCALAR) {
+        return split_log_row_scalar(row, len, fields, max_fields);
     }
-    fclose(file);
+    return split_log_row_with_kernel(csv_kernel_level, row, len, fields, max_fields);
 }
 
-void record_work_session(const char *category, const char *focus, time_t start_time, time_t end_time, long duration) {
-    FILE *file = fopen(work_log_file_path, "a");
-    if (file == NULL) {
-        fprintf(stderr, "Hata: Çalışma kayıt dosyasına yazılamadı: %s\n", work_log_file_path);
-        return;
+// Rastgele satırlarla tüm desteklenen çekirdek seviyelerini skaler yolla karşılaştırır.
+// Return: true (tüm sonuçlar aynı), false (uyuşmazlık bulundu)
+bool csv_kernel_self_check() {
+    static const char alphabet[] = "ab ,\"\",,\xc3\xa7x1";
+    static const char *level_names[] = { "scalar", "sse2", "avx2" };
+    CsvKernelLevel max_level = detect_csv_kernel_level();
+    char row[600];
+    LogField expected[LOG_MAX_FIELDS], actual[LOG_MAX_FIELDS];
+    int mismatches = 0;
+
+    for (int iteration = 0; iteration < 200000 && mismatches < 10; iteration++) {
+        size_t len = (size_t)(random() % (long)sizeof(row));
+        for (size_t i = 0; i < len; i++) {
+            row[i] = alphabet[random() % (long)(sizeof(alphabet) - 1)];
+        }
+        int max_fields = 1 + (int)(random() % LOG_MAX_FIELDS);
+        int expected_count = split_log_row_scalar(row, len, expected, max_fields);
+
+        for (int level = CSV_KERNEL_SCALAR; level <= (int)max_level; level++) {
+            int actual_count = split_log_row_with_kernel((CsvKernelLevel)level, row, len, actual, max_fields);
+            bool same = actual_count == expected_count;
+            for (int f = 0; same && f < expected_count; f++) {
+                same = actual[f].ptr == expected[f].ptr && actual[f].len == expected[f].len;
+            }
+            if (!same) {
+                fprintf(stderr, "Uyuşmazlık (%s): %.*s\n", level_names[level], (int)len, row);
+                mismatches++;
+            }
+        }
     }
 
-    char start_time_str[20], end_time_str[20];
-    strftime(start_time_str, sizeof(start_time_str), "%Y-%m-%d %H:%M:%S", localtime(&start_time));
-    strftime(end_time_str, sizeof(end_time_str), "%Y-%m-%d %H:%M:%S", localtime(&end_time));
+    printf("CSV çekirdeği: %s, skaler yol ile karşılaştırma: %s\n",
+           level_names[max_level], mismatches == 0 ? "OK" : "HATA");
+    return mismatches == 0;
+}
 
-    fprintf(file, "\"%s\",\"%s\",\"%s\",\"%s\",%ld\n", category, focus, start_time_str, end_time_str, duration);
-    fclose(file);
+bool log_field_equals(const LogField *field, const char *str) {
+    return strlen(str) == field->len && memcmp(field->ptr, str, field->len) == 0;
 }
 
-int get_random_color_pair() {
-    if (next_available_color_pair_id > MAX_CUSTOM_COLOR_PAIR) {
-        return COLOR_PAIR_DEFAULT;
+long parse_log_long(const LogField *field) {
+    long value = 0;
+    size_t i = 0;
+    bool negative = false;
+    while (i < field->len && field->ptr[i] == ' ') i++;
+    if (i < field->len && field->ptr[i] == '-') {
+        negative = true;
+        i++;
     }
-    if (!has_colors()) {
-        return COLOR_PAIR_DEFAULT;
+    for (; i < field->len && isdigit((unsigned char)field->ptr[i]); i++) {
+        value = value * 10 + (field->ptr[i] - '0');
     }
+    return negative ? -value : value;
+}
 
-    int fg_color;
-    // COLOR_BLACK (0) ve COLOR_WHITE (7) dışında rastgele bir renk seç
-    // Daha belirgin renkler için 1-6 arasındaki renkleri tercih et
-    do {
-        fg_color = (rand() % 6) + 1; // 1-6 arası (Kırmızı, Yeşil, Sarı, Mavi, Magenta, Cyan)
-    } while (fg_color == COLOR_BLACK || fg_color == COLOR_WHITE);
-
-    // Yeni renk çiftini başlat ve başlatıldığını işaretle.
-    // Arka planı siyah tutarak, ACS_BLOCK ile ön plan rengini kullanarak görünürlük sağlayacağız.
-    init_pair(next_available_color_pair_id, fg_color, COLOR_BLACK);
-    g_initialized_color_pairs[next_available_color_pair_id] = true;
+// --- Log Biçimleri (CSV / İkili) ---
 
-    return next_available_color_pair_id++;
+const char *active_log_path() {
+    return (active_log_format == LOG_FORMAT_BINARY) ? work_log_bin_path : work_log_file_path;
 }
 
-// Tüm yüklü renk çiftlerinin başlatıldığından emin olmak için fonksiyon
-void ensure_all_color_pairs_initialized() {
-    if (!has_colors()) return;
+// work_log.bin varsa ikili log etkin biçimdir
+void detect_active_log_format() {
+    active_log_format = (access(work_log_bin_path, F_OK) == 0) ? LOG_FORMAT_BINARY : LOG_FORMAT_CSV;
+}
 
-    // Başlatma dizisini sıfırla
-    for (int i = 0; i < MAX_COLOR_PAIRS; i++) {
-        g_initialized_color_pairs[i] = false;
+static unsigned long hash_dictionary_name(const char *name, size_t len) {
+    unsigned long hash = 14695981039346656037UL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 1099511628211UL;
     }
+    return hash;
+}
 
-    // Varsayılan renk çiftlerini işaretle (main'de zaten başlatıldılar)
-    g_initialized_color_pairs[COLOR_PAIR_DEFAULT] = true;
-    g_initialized_color_pairs[COLOR_PAIR_HIGHLIGHT] = true;
-    g_initialized_color_pairs[COLOR_PAIR_TITLE] = true;
-    g_initialized_color_pairs[COLOR_PAIR_RED] = true;
+static void name_dictionary_free(NameDictionary *dict) {
+    for (int i = 0; i < dict->count; i++) {
+        free(dict->names[i]);
+    }
+    free(dict->names);
+    free(dict->lengths);
+    free(dict->slots);
+    memset(dict, 0, sizeof(*dict));
+}
 
-    for (int i = 0; i < num_user_categories; i++) {
-        int cat_id = user_categories[i].color_pair_id;
-        if (cat_id >= MIN_CUSTOM_COLOR_PAIR && cat_id < MAX_COLOR_PAIRS && !g_initialized_color_pairs[cat_id]) {
-            int fg_color = ((cat_id - MIN_CUSTOM_COLOR_PAIR) % 6) + 1; // Deterministic color based on ID
-            if (fg_color < 1 || fg_color > 6) fg_color = COLOR_WHITE; // Fallback for safety
-            init_pair(cat_id, fg_color, COLOR_BLACK);
-            g_initialized_color_pairs[cat_id] = true;
+// Return: Adın ID'si, -1 (sözlükte yok)
+static int name_dictionary_find(const NameDictionary *dict, const char *name, size_t len) {
+    if (dict->slot_capacity == 0) return -1;
+    unsigned long mask = (unsigned long)dict->slot_capacity - 1;
+    for (unsigned long i = hash_dictionary_name(name, len) & mask; dict->slots[i] != 0; i = (i + 1) & mask) {
+        int id = dict->slots[i] - 1;
+        if (dict->lengths[id] == len && memcmp(dict->names[id], name, len) == 0) {
+            return id;
         }
+    }
+    return -1;
+}
 
-        for (int j = 0; j < user_categories[i].num_focuses; j++) {
-            int focus_id = user_categories[i].focuses[j].color_pair_id;
-            if (focus_id >= MIN_CUSTOM_COLOR_PAIR && focus_id < MAX_COLOR_PAIRS && !g_initialized_color_pairs[focus_id]) {
-                int fg_color = ((focus_id - MIN_CUSTOM_COLOR_PAIR) % 6) + 1; // Deterministic color based on ID
-                if (fg_color < 1 || fg_color > 6) fg_color = COLOR_WHITE; // Fallback for safety
-                init_pair(focus_id, fg_color, COLOR_BLACK);
-                g_initialized_color_pairs[focus_id] = true;
-            }
+// Sözlüğe yeni bir ad ekler (varlığı önceden kontrol edilmelidir)
+// Return: Yeni ID, -1 (bellek hatası)
+static int name_dictionary_add(NameDictionary *dict, const char *name, size_t len) {
+    if (dict->count == dict->capacity) {
+        int new_capacity = dict->capacity ? dict->capacity * 2 : 64;
+        char **names = realloc(dict->names, new_capacity * sizeof(char *));
+        if (names == NULL) return -1;
+        dict->names = names;
+        size_t *lengths = realloc(dict->lengths, new_capacity * sizeof(size_t));
+        if (lengths == NULL) return -1;
+        dict->lengths = lengths;
+        dict->capacity = new_capacity;
+    }
+    if ((dict->count + 1) * 2 > dict->slot_capacity) {
+        // Yuvaları büyüt ve mevcut adları yeniden yerleştir
+        int new_slot_capacity = dict->slot_capacity ? dict->slot_capacity * 2 : 128;
+        int *slots = calloc(new_slot_capacity, sizeof(int));
+        if (slots == NULL) return -1;
+        unsigned long mask = (unsigned long)new_slot_capacity - 1;
+        for (int id = 0; id < dict->count; id++) {
+            unsigned long i = hash_dictionary_name(dict->names[id], dict->lengths[id]) & mask;
+            while (slots[i] != 0) i = (i + 1) & mask;
+            slots[i] = id + 1;
         }
+        free(dict->slots);
+        dict->slots = slots;
+        dict->slot_capacity = new_slot_capacity;
     }
-}
 
+    char *copy = malloc(len + 1);
+    if (copy == NULL) return -1;
+    memcpy(copy, name, len);
+    copy[len] = '\0';
+
+    int id = dict->count++;
+    dict->names[id] = copy;
+    dict->lengths[id] = len;
+    unsigned long mask = (unsigned long)dict->slot_capacity - 1;
+    unsigned long i = hash_dictionary_name(name, len) & mask;
+    while (dict->slots[i] != 0) i = (i + 1) & mask;
+    dict->slots[i] = id + 1;
+    return id;
+}
 
-// İstatistik yükleme fonksiyonu
-void load_statistics() {
-    num_stat_categories = 0; // İstatistikleri sıfırla
+void binary_log_state_reset(BinaryLogState *state) {
+    name_dictionary_free(&state->dict);
+    state->last_start = 0;
+    state->utc_offset = 0;
+    state->entity_ids = false;
+}
 
-    FILE *file = fopen(work_log_file_path, "r");
-    if (file == NULL) {
-        return;
+// Okuma durumunu kopyalar (sözlük ID'leri aynı sırayla yeniden eklenir)
+// Return: true (başarılı), false (bellek hatası)
+static bool binary_log_state_copy(BinaryLogState *dst, const BinaryLogState *src) {
+    binary_log_state_reset(dst);
+    for (int i = 0; i < src->dict.count; i++) {
+        if (name_dictionary_add(&dst->dict, src->dict.names[i], src->dict.lengths[i]) == -1) {
+            binary_log_state_reset(dst);
+            return false;
+        }
     }
+    dst->last_start = src->last_start;
+    dst->utc_offset = src->utc_offset;
+    dst->entity_ids = src->entity_ids;
+    return true;
+}
 
-    char line_buffer[512];
-
-    // CSV başlığını atla
-    if (fgets(line_buffer, sizeof(line_buffer), file) == NULL) {
-        fclose(file);
-        return;
+static bool read_varint(const unsigned char **cursor, const unsigned char *end, uint64_t *out) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*cursor >= end) return false;
+        unsigned char byte = *(*cursor)++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *out = value;
+            return true;
+        }
     }
+    return false;
+}
 
-    while (fgets(line_buffer, sizeof(line_buffer), file) != NULL) {
-        line_buffer[strcspn(line_buffer, "\n")] = 0;
+static unsigned char *write_varint(unsigned char *cursor, uint64_t value) {
+    while (value >= 0x80) {
+        *cursor++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *cursor++ = (unsigned char)value;
+    return cursor;
+}
 
-        char category_name[MAX_CATEGORY_NAME_LEN];
-        char focus_name[MAX_FOCUS_NAME_LEN];
-        char duration_str[20];
-        long duration_s = 0;
+static uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
 
-        char *ptr = line_buffer;
-        char *start = ptr;
-        bool in_quote = false;
+static int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
 
-        // Kategori adını al
-        while (*ptr && (in_quote || *ptr != ',')) {
-            if (*ptr == '"') in_quote = !in_quote;
-            ptr++;
+// "YYYY-MM-DD HH:MM:SS" biçimindeki yerel zamanı epoch'a çevirir
+static time_t parse_log_timestamp(const LogField *field) {
+    int values[6] = { 0 };
+    int index = 0;
+    for (size_t i = 0; i < field->len && index < 6; i++) {
+        char c = field->ptr[i];
+        if (isdigit((unsigned char)c)) {
+            values[index] = values[index] * 10 + (c - '0');
+        } else if (i > 0 && isdigit((unsigned char)field->ptr[i - 1])) {
+            index++;
         }
-        // Tırnakları kaldırarak kopyala
-        strncpy(category_name, start + (*start == '"' ? 1 : 0), (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0));
-        category_name[ (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0) ] = '\0';
+    }
+    struct tm tm_value = { 0 };
+    tm_value.tm_year = values[0] - 1900;
+    tm_value.tm_mon = values[1] - 1;
+    tm_value.tm_mday = values[2];
+    tm_value.tm_hour = values[3];
+    tm_value.tm_min = values[4];
+    tm_value.tm_sec = values[5];
+    tm_value.tm_isdst = -1;
+    return mktime(&tm_value);
+}
 
-        // Odak adını al
-        ptr++; // Virgülü geç
-        start = ptr;
-        in_quote = false;
-        while (*ptr && (in_quote || *ptr != ',')) {
-            if (*ptr == '"') in_quote = !in_quote;
-            ptr++;
-        }
-        // Tırnakları kaldırarak kopyala
-        strncpy(focus_name, start + (*start == '"' ? 1 : 0), (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0));
-        focus_name[ (ptr - start) - (*start == '"' ? 1 : 0) - (*(ptr-1) == '"' ? 1 : 0) ] = '\0';
+// Okuyucuyu açar; baştan okunuyorsa CSV başlığı veya ikili sihirli baytlar atlanır.
+// Return: true (başarılı), false (dosya açılamadı veya ikili başlık geçersiz)
+bool log_reader_open(LogReader *reader, const char *path, LogFormat format, off_t start, BinaryLogState *binary_state) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        memset(reader, 0, sizeof(*reader));
+        reader->scanner.fd = -1;
+        return false;
+    }
+    return log_reader_open_fd(reader, fd, format, start, binary_state);
+}
+
+// log_reader_open'ın açık tanımlayıcı alan biçimi; tanımlayıcının sahipliği okuyucuya geçer
+bool log_reader_open_fd(LogReader *reader, int fd, LogFormat format, off_t start, BinaryLogState *binary_state) {
+    memset(reader, 0, sizeof(*reader));
+    reader->format = format;
+    reader->binary_state = binary_state;
+    if (!log_scanner_open_fd(&reader->scanner, fd, 0)) {
+        return false;
+    }
 
-        // Diğer alanları atla (Başlangıç Zamanı, Bitiş Zamanı)
-        for (int i = 0; i < 2; i++) {
-            ptr++; // Virgülü geç
-            start = ptr;
-            in_quote = false;
-            while (*ptr && (in_quote || *ptr != ',')) {
-                if (*ptr == '"') in_quote = !in_quote;
-                ptr++;
+    if (format == LOG_FORMAT_CSV) {
+        // Sütun düzenini başlıktan belirle, ardından istenen konuma geç
+        static const CsvLogSchema entity_schema = { true, 8, 2, 3, 4, 5, 6, 7 };
+        static const CsvLogSchema epoch_schema = { true, 6, 2, 3, 4, 5, -1, -1 };
+        static const CsvLogSchema legacy_schema = { false, 5, 2, 3, -1, 4, -1, -1 };
+        reader->schema = entity_schema;
+        if (log_scanner_next(&reader->scanner)) {
+            if (reader->scanner.num_fields > 2 && log_field_equals(&reader->scanner.fields[2], LEGACY_CSV_START_COLUMN)) {
+                reader->schema = legacy_schema;
+            } else if (reader->scanner.num_fields <= 6 || !log_field_equals(&reader->scanner.fields[6], CSV_CATEGORY_ID_COLUMN)) {
+                reader->schema = epoch_schema; // Kalıcı ID'ler öncesi log
             }
+        } else if (reader->scanner.end > 0) {
+            reader->schema = legacy_schema; // Başlığı olmayan eski log
+        }
+        if (start != 0) {
+            reader->scanner.pos = (start < reader->scanner.end) ? start : reader->scanner.end;
         }
+        return true;
+    }
 
-        // Süre adını al (son alan)
-        ptr++; // Virgülü geç
-        start = ptr;
-        strncpy(duration_str, start, sizeof(duration_str) - 1);
-        duration_str[sizeof(duration_str) - 1] = '\0';
+    if (start != 0) {
+        reader->scanner.pos = (start < reader->scanner.end) ? start : reader->scanner.end;
+        return true;
+    }
 
+    size_t available;
+    const unsigned char *header = log_scanner_peek(&reader->scanner, BINARY_LOG_MAGIC_LEN, &available);
+    if (reader->scanner.end == 0) {
+        return true; // Boş dosya
+    }
+    if (header == NULL || available < BINARY_LOG_MAGIC_LEN ||
+        (memcmp(header, BINARY_LOG_MAGIC, BINARY_LOG_MAGIC_LEN) != 0 && memcmp(header, BINARY_LOG_MAGIC_V1, BINARY_LOG_MAGIC_LEN) != 0)) {
+        log_scanner_close(&reader->scanner);
+        return false;
+    }
+    binary_state->entity_ids = (memcmp(header, BINARY_LOG_MAGIC, BINARY_LOG_MAGIC_LEN) == 0);
+    reader->scanner.pos += BINARY_LOG_MAGIC_LEN;
+    return true;
+}
 
-        duration_s = atol(duration_str);
+// İkili logdan bir sonraki oturum kaydını çözer; araya giren sözlük girdileri
+// okuyucunun durumuna eklenir. Yarım kalmış son kayıtta konum ilerletilmez.
+// Dosya sonundan önce çözülemeyen bir kayıt bozukluk sayılır: okuma sessizce bitmez,
+// bayt bayt ilerlenerek bir sonraki çözülebilen kayda geçilir ve atlanan baytlar
+// reader->skipped_bytes'ta toplanır.
+static bool binary_log_next(LogReader *reader, LogRecord *record) {
+    LogScanner *scanner = &reader->scanner;
+    NameDictionary *dict = &reader->binary_state->dict;
 
-        // İstatistiklere ekle
-        int cat_idx = get_stat_category_index(category_name);
-        if (cat_idx == -1) { // Yeni kategori
-            if (num_stat_categories < MAX_CATEGORIES) {
-                cat_idx = num_stat_categories++;
-                strncpy(stat_categories[cat_idx].name, category_name, MAX_CATEGORY_NAME_LEN - 1);
-                stat_categories[cat_idx].name[MAX_CATEGORY_NAME_LEN - 1] = '\0';
-                stat_categories[cat_idx].num_focuses = 0;
-            } else {
-                continue; // Maksimum kategori sayısına ulaşıldı
+    while (1) {
+        size_t available;
+        const unsigned char *data = log_scanner_peek(scanner, BINARY_MAX_RECORD_BYTES, &available);
+        if (data == NULL || available == 0) {
+            return false;
+        }
+        const unsigned char *cursor = data + 1;
+        const unsigned char *end = data + available;
+        bool at_end = (scanner->pos + (off_t)available >= scanner->end); // Kayıt yazımı sürüyor olabilir
+
+        if (data[0] == BINARY_TAG_NAME) {
+            uint64_t id, len;
+            if (!read_varint(&cursor, end, &id) || !read_varint(&cursor, end, &len)) {
+                goto truncated;
             }
+            if (id != (uint64_t)dict->count || len >= MAX_FOCUS_NAME_LEN) {
+                goto corrupt; // Sözlük sırası bozuk veya yazıcının üretemeyeceği uzunluk
+            }
+            if ((uint64_t)(end - cursor) < len) {
+                goto truncated;
+            }
+            if (name_dictionary_add(dict, (const char *)cursor, (size_t)len) == -1) {
+                return false; // Bellek hatası
+            }
+            cursor += len;
+            scanner->pos += cursor - data;
+        } else if (data[0] == BINARY_TAG_UTC_OFFSET) {
+            uint64_t utc_offset;
+            if (!read_varint(&cursor, end, &utc_offset)) {
+                goto truncated;
+            }
+            reader->binary_state->utc_offset = (long)zigzag_decode(utc_offset);
+            scanner->pos += cursor - data;
+        } else if (data[0] == BINARY_TAG_TOMBSTONE) {
+            uint64_t kind, category_id, focus_id = 0, category_entity = 0, focus_entity = 0, deleted_at;
+            if (!read_varint(&cursor, end, &kind) || !read_varint(&cursor, end, &category_id) ||
+                (kind == 1 && !read_varint(&cursor, end, &focus_id))) {
+                goto truncated;
+            }
+            if (reader->binary_state->entity_ids &&
+                (!read_varint(&cursor, end, &category_entity) || (kind == 1 && !read_varint(&cursor, end, &focus_entity)))) {
+                goto truncated;
+            }
+            if (!read_varint(&cursor, end, &deleted_at)) {
+                goto truncated;
+            }
+            if (kind > 1 || category_id >= (uint64_t)dict->count || focus_id >= (uint64_t)dict->count) {
+                goto corrupt;
+            }
+            record->type = (kind == 0) ? LOG_RECORD_DELETE_CATEGORY : LOG_RECORD_DELETE_FOCUS;
+            record->category.ptr = dict->names[category_id];
+            record->category.len = dict->lengths[category_id];
+            record->focus.ptr = dict->names[focus_id];
+            record->focus.len = (kind == 0) ? 0 : dict->lengths[focus_id];
+            record->category_id = (uint32_t)category_entity;
+            record->focus_id = (uint32_t)focus_entity;
+            record->start_time = (time_t)zigzag_decode(deleted_at);
+            record->end_time = record->start_time;
+            record->utc_offset = reader->binary_state->utc_offset;
+            record->duration = 0;
+            record->byte_length = (size_t)(cursor - data);
+            scanner->pos += cursor - data;
+            return true;
+        } else if (data[0] == BINARY_TAG_SESSION) {
+            uint64_t category_id, focus_id, category_entity = 0, focus_entity = 0, start_delta, span, duration;
+            if (!read_varint(&cursor, end, &category_id) || !read_varint(&cursor, end, &focus_id)) {
+                goto truncated;
+            }
+            if (reader->binary_state->entity_ids &&
+                (!read_varint(&cursor, end, &category_entity) || !read_varint(&cursor, end, &focus_entity))) {
+                goto truncated;
+            }
+            if (!read_varint(&cursor, end, &start_delta) || !read_varint(&cursor, end, &span) ||
+                !read_varint(&cursor, end, &duration)) {
+                goto truncated;
+            }
+            if (category_id >= (uint64_t)dict->count || focus_id >= (uint64_t)dict->count) {
+                goto corrupt;
+            }
+            reader->binary_state->last_start += (time_t)zigzag_decode(start_delta);
+            record->type = LOG_RECORD_SESSION;
+            record->category.ptr = dict->names[category_id];
+            record->category.len = dict->lengths[category_id];
+            record->focus.ptr = dict->names[focus_id];
+            record->focus.len = dict->lengths[focus_id];
+            record->category_id = (uint32_t)category_entity;
+            record->focus_id = (uint32_t)focus_entity;
+            record->start_time = reader->binary_state->last_start;
+            record->end_time = record->start_time + (time_t)span;
+            record->utc_offset = reader->binary_state->utc_offset;
+            record->duration = (long)duration;
+            record->byte_length = (size_t)(cursor - data);
+            scanner->pos += cursor - data;
+            return true;
+        } else {
+            goto corrupt; // Bilinmeyen kayıt türü
         }
+        continue;
 
-        int focus_idx = get_stat_focus_index(&stat_categories[cat_idx], focus_name);
-        if (focus_idx == -1) { // Yeni odak
-            if (stat_categories[cat_idx].num_focuses < MAX_FOCUSES_PER_CATEGORY) {
-                focus_idx = stat_categories[cat_idx].num_focuses++;
-                strncpy(stat_categories[cat_idx].focuses[focus_idx].name, focus_name, MAX_FOCUS_NAME_LEN - 1);
-                stat_categories[cat_idx].focuses[focus_idx].name[MAX_FOCUS_NAME_LEN - 1] = '\0';
-                stat_categories[cat_idx].focuses[focus_idx].total_duration = 0;
-                stat_categories[cat_idx].focuses[focus_idx].session_count = 0;
-            } else {
-                continue;
-            }
+    truncated:
+        if (at_end) {
+            return false; // Son kayıt henüz tamamlanmamış: bir sonraki yükleme yeniden dener
         }
-        stat_categories[cat_idx].focuses[focus_idx].total_duration += duration_s;
-        stat_categories[cat_idx].focuses[focus_idx].session_count++;
+    corrupt:
+        if (reader->skipped_bytes == 0) {
+            reader->first_skipped = scanner->pos;
+        }
+        reader->skipped_bytes++;
+        scanner->pos++;
     }
-    fclose(file);
 }
 
-int get_stat_category_index(const char *category_name) {
-    for (int i = 0; i < num_stat_categories; i++) {
-        if (strcmp(stat_categories[i].name, category_name) == 0) {
-            return i;
+// Return: true (kayıt hazır), false (log sonu)
+bool log_reader_next(LogReader *reader, LogRecord *record) {
+    if (reader->format == LOG_FORMAT_BINARY) {
+        return binary_log_next(reader, record);
+    }
+
+    const CsvLogSchema *schema = &reader->schema;
+    while (log_scanner_next(&reader->scanner)) {
+        const LogField *fields = reader->scanner.fields;
+        if (reader->scanner.row_len > 0 && reader->scanner.row[0] == '!') {
+            // Silme işareti: !DELETE_CATEGORY,"Kategori","",zaman,kategori_id,0 veya
+            // !DELETE_FOCUS,"Kategori","Odak",zaman,kategori_id,odak_id (ID'ler eski işaretlerde yoktur).
+            // Oturum satırları her zaman tırnakla başladığı için '!' ile başlayan adlarla karışmaz.
+            bool is_category = log_field_equals(&fields[0], CSV_TOMBSTONE_CATEGORY);
+            if (reader->scanner.num_fields < 4 || (!is_category && !log_field_equals(&fields[0], CSV_TOMBSTONE_FOCUS))) {
+                continue; // Tanınmayan işaret
+            }
+            record->type = is_category ? LOG_RECORD_DELETE_CATEGORY : LOG_RECORD_DELETE_FOCUS;
+            record->category = fields[1];
+            record->focus = is_category ? (LogField){ fields[2].ptr, 0 } : fields[2];
+            record->category_id = (reader->scanner.num_fields >= 6) ? (uint32_t)parse_log_long(&fields[4]) : 0;
+            record->focus_id = (reader->scanner.num_fields >= 6) ? (uint32_t)parse_log_long(&fields[5]) : 0;
+            record->start_time = (time_t)parse_log_long(&fields[3]);
+            record->end_time = record->start_time;
+            record->utc_offset = 0;
+            record->duration = 0;
+            record->byte_length = reader->scanner.row_len + 1;
+            return true;
+        }
+        if (reader->scanner.num_fields < schema->min_fields) {
+            continue; // Eksik satır
+        }
+        record->type = LOG_RECORD_SESSION;
+        record->byte_length = reader->scanner.row_len + 1;
+        record->category = fields[0];
+        record->focus = fields[1];
+        record->duration = parse_log_long(&fields[schema->duration_column]);
+        if (schema->category_id_column != -1) {
+            record->category_id = (uint32_t)parse_log_long(&fields[schema->category_id_column]);
+            record->focus_id = (uint32_t)parse_log_long(&fields[schema->focus_id_column]);
+        } else {
+            record->category_id = 0;
+            record->focus_id = 0;
         }
+        if (schema->epoch_times) {
+            // Zamanlar tam sayı: saat dilimi hesabı gerekmez
+            record->start_time = (time_t)parse_log_long(&fields[schema->start_column]);
+            record->end_time = (time_t)parse_log_long(&fields[schema->end_column]);
+            record->utc_offset = parse_log_long(&fields[schema->utc_offset_column]);
+        } else if (reader->parse_times) {
+            record->start_time = parse_log_timestamp(&fields[schema->start_column]);
+            record->end_time = parse_log_timestamp(&fields[schema->end_column]);
+            struct tm local_tm;
+            localtime_r(&record->start_time, &local_tm);
+            record->utc_offset = local_tm.tm_gmtoff;
+        } else {
+            record->start_time = 0;
+            record->end_time = 0;
+            record->utc_offset = 0;
+        }
+        return true;
     }
-    return -1;
+    return false;
+}
+
+void log_reader_close(LogReader *reader) {
+    log_scanner_close(&reader->scanner);
 }
 
-int get_stat_focus_index(StatCategory *stat_cat, const char *focus_name) {
-    for (int i = 0; i < stat_cat->num_focuses; i++) {
-        if (strcmp(stat_cat->focuses[i].name, focus_name) == 0) {
-            return i;
+// --- Log Kilidi ---
+// Eşzamanlılık protokolü:
+//  - CSV ekleyicileri kilidi paylaşımlı alır; her kayıt O_APPEND ile tek write() olduğundan
+//    birçok örnek aynı anda yazabilir ve satırlar iç içe geçmez.
+//  - İkili log ekleyicileri kilidi özel alır: sözlük ve fark kodlaması dosyanın sonundaki
+//    duruma bağlıdır, bu yüzden durum kilit altında senkronlanır.
+//  - Logu yeniden yazanlar (sıkıştırma, sıfırlama, yükseltme, dönüştürme) kilidi özel alır,
+//    kopyalayıp rename() eder ve kilit dosyasındaki kuşak numarasını artırır. Böylece hiçbir
+//    ekleme eski inode'a yazılıp kaybolmaz.
+//  - Okuyucular kilit almaz; kuşak numarası ve inode ile değişikliği fark eder.
+// Kilit, log yerine ayrı bir dosyadadır çünkü log rename() ile değiştirilir.
+
+// Return: kilidi tutan tanımlayıcı, -1 (kilit dosyası açılamadı)
+int lock_data_file(const char *lock_path, int operation) {
+    int lock_fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd == -1) {
+        return -1;
+    }
+    while (flock(lock_fd, operation) != 0) {
+        if (errno != EINTR) {
+            close(lock_fd);
+            return -1;
         }
     }
-    return -1;
+    return lock_fd;
 }
 
+int work_log_lock(int operation) {
+    return lock_data_file(work_log_lock_path, operation);
+}
 
-void view_statistics(const char **current_lang_menu_items) {
-    clear();
-    int yMax, xMax;
-    getmaxyx(stdscr, yMax, xMax);
-
-    const char *title = (current_lang_menu_items == menu_items_en) ? "Statistics" : "İstatistikler";
-    const char *no_data_msg = (current_lang_menu_items == menu_items_en) ? "No work log data found." : "Çalışma kaydı bulunamadı.";
-    const char *press_esc_to_return_msg = (current_lang_menu_items == menu_items_en) ? "Press ESC to return to menu..." : "Menüye dönmek için ESC tuşuna basın..."; // Updated message
+void unlock_data_file(int lock_fd) {
+    if (lock_fd != -1) close(lock_fd); // Kapatmak flock kilidini bırakır
+}
 
-    attron(COLOR_PAIR(COLOR_PAIR_TITLE));
-    mvprintw(0, (xMax - strlen(title)) / 2, "%s", title);
-    attroff(COLOR_PAIR(COLOR_PAIR_TITLE));
-    refresh();
+void work_log_unlock(int lock_fd) {
+    unlock_data_file(lock_fd);
+}
 
-    load_statistics(); // İstatistik verilerini yükle
+// Return: logun kuşak numarası (kilit dosyası yoksa 0)
+uint64_t read_work_log_generation() {
+    int fd = open(work_log_lock_path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return 0;
+    }
+    uint64_t generation = 0;
+    if (pread(fd, &generation, sizeof(generation), 0) != (ssize_t)sizeof(generation)) {
+        generation = 0;
+    }
+    close(fd);
+    return generation;
+}
 
-    if (num_stat_categories == 0) {
-        mvprintw(yMax / 2, (xMax - strlen(no_data_msg)) / 2, "%s", no_data_msg);
-        mvprintw(yMax / 2 + 2, (xMax - strlen(press_esc_to_return_msg)) / 2, "%s", press_esc_to_return_msg); // Updated message
-        refresh();
-        getch();
-        return;
+// Yalnızca özel kilit altında, yeniden yazılan log yerine konduktan sonra çağrılır
+void bump_work_log_generation(int lock_fd) {
+    uint64_t generation = 0;
+    if (pread(lock_fd, &generation, sizeof(generation), 0) != (ssize_t)sizeof(generation)) {
+        generation = 0;
+    }
+    generation++;
+    if (pwrite(lock_fd, &generation, sizeof(generation), 0) != (ssize_t)sizeof(generation)) {
+        /* Okuyucular yine inode ve kuyruk özetiyle değişikliği fark eder */
     }
+}
+
+// Kaydı yazıcıya tek parça olarak gönderir
+static bool log_writer_emit(LogWriter *writer, const void *data, size_t len) {
+    if (writer->file != NULL) {
+        return fwrite(data, 1, len, writer->file) == len;
+    }
+    ssize_t written;
+    do {
+        written = write(writer->fd, data, len);
+    } while (written == -1 && errno == EINTR);
+    return written == (ssize_t)len;
+}
+
+// Yazıcıyı açar; dosya boşsa önce CSV başlığını veya ikili sihirli baytları yazar.
+// "a" kipinde log kilidi alınır (CSV: paylaşımlı, ikili: özel) ve log_writer_close'a kadar tutulur.
+bool log_writer_open(LogWriter *writer, const char *path, LogFormat format, const char *mode, BinaryLogState *binary_state, bool commit_state) {
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = -1;
+    writer->lock_fd = -1;
+    writer->format = format;
+    writer->binary_state = binary_state;
+    writer->commit_state = commit_state;
+
+    off_t size;
+    if (mode[0] == 'a') {
+        writer->lock_fd = work_log_lock(format == LOG_FORMAT_BINARY ? LOCK_EX : LOCK_SH);
+        if ((strcmp(path, work_log_file_path) == 0 || strcmp(path, work_log_bin_path) == 0) &&
+            (access(work_log_bin_path, F_OK) == 0) != (format == LOG_FORMAT_BINARY)) {
+            // Biçim seçildikten sonra log dönüştürüldü: eski yola eklenen kayıt kaybolurdu
+            log_writer_close(writer);
+            errno = ESTALE;
+            return false;
+        }
+        writer->fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        struct stat st;
+        if (writer->fd == -1 || fstat(writer->fd, &st) != 0) {
+            log_writer_close(writer);
+            return false;
+        }
+        size = st.st_size;
+        if (size == 0 && writer->lock_fd != -1 && format == LOG_FORMAT_CSV) {
+            // Başlığı yalnızca bir ekleyici yazsın: özel kilitle yeniden denetle
+            flock(writer->lock_fd, LOCK_EX);
+            size = (fstat(writer->fd, &st) == 0) ? st.st_size : 0;
+        }
+    } else {
+        writer->file = fopen(path, mode);
+        if (writer->file == NULL) {
+            return false;
+        }
+        fseek(writer->file, 0, SEEK_END);
+        size = ftell(writer->file);
+    }
+
+    if (size == 0) {
+        bool ok;
+        if (format == LOG_FORMAT_BINARY) {
+            ok = log_writer_emit(writer, BINARY_LOG_MAGIC, BINARY_LOG_MAGIC_LEN);
+            binary_state->entity_ids = true;
+        } else {
+            ok = log_writer_emit(writer, CSV_LOG_HEADER, strlen(CSV_LOG_HEADER));
+        }
+        if (!ok) {
+            log_writer_close(writer);
+            return false;
+        }
+    }
+    if (writer->lock_fd != -1 && format == LOG_FORMAT_CSV) {
+        flock(writer->lock_fd, LOCK_SH); // Başlık yazıldıysa diğer ekleyicilere yol ver
+    }
+    return true;
+}
+
+// Adın sözlük ID'sini döndürür; yoksa bir sözlük girdisi kodlar.
+// commit_state false ise yeni ID'ler sözlüğe eklenmeden geçici olarak atanır.
+static uint64_t encode_dictionary_name(LogWriter *writer, const LogField *name, unsigned char **cursor,
+                                       LogField *pending, int *num_pending) {
+    NameDictionary *dict = &writer->binary_state->dict;
+    // Uzun ad karakter sınırında kesilir; sözlükteki ad bellekteki modelle aynı kalır
+    size_t len = name->len < MAX_FOCUS_NAME_LEN ? name->len : utf8_prefix_len(name->ptr, MAX_FOCUS_NAME_LEN - 1);
+
+    int id = name_dictionary_find(dict, name->ptr, len);
+    if (id != -1) {
+        return (uint64_t)id;
+    }
+    for (int i = 0; i < *num_pending; i++) {
+        if (pending[i].len == len && memcmp(pending[i].ptr, name->ptr, len) == 0) {
+            return (uint64_t)(dict->count + i);
+        }
+    }
+
+    id = dict->count + *num_pending;
+    if (writer->commit_state) {
+        name_dictionary_add(dict, name->ptr, len);
+    } else {
+        pending[(*num_pending)++] = (LogField){ name->ptr, len };
+    }
+    *(*cursor)++ = BINARY_TAG_NAME;
+    *cursor = write_varint(*cursor, (uint64_t)id);
+    *cursor = write_varint(*cursor, (uint64_t)len);
+    memcpy(*cursor, name->ptr, len);
+    *cursor += len;
+    return (uint64_t)id;
+}
+
+bool log_writer_append(LogWriter *writer, const LogRecord *record) {
+    if (writer->format == LOG_FORMAT_CSV) {
+        // Satır önce tamamen biçimlendirilir, ardından tek parça yazılır
+        char line[CSV_MAX_RECORD_BYTES];
+        int len;
+        if (record->type != LOG_RECORD_SESSION) {
+            len = snprintf(line, sizeof(line), "%s,\"%.*s\",\"%.*s\",%lld,%u,%u\n",
+                           record->type == LOG_RECORD_DELETE_CATEGORY ? CSV_TOMBSTONE_CATEGORY : CSV_TOMBSTONE_FOCUS,
+                           (int)record->category.len, record->category.ptr,
+                           (int)record->focus.len, record->focus.ptr,
+                           (long long)record->start_time, record->category_id, record->focus_id);
+        } else {
+            len = snprintf(line, sizeof(line), "\"%.*s\",\"%.*s\",%lld,%lld,%ld,%ld,%u,%u\n",
+                           (int)record->category.len, record->category.ptr,
+                           (int)record->focus.len, record->focus.ptr,
+                           (long long)record->start_time, (long long)record->end_time,
+                           record->utc_offset, record->duration,
+                           record->category_id, record->focus_id);
+        }
+        if (len < 0 || len >= (int)sizeof(line)) {
+            return false; // Kesik satır yazılmaz
+        }
+        return log_writer_emit(writer, line, (size_t)len);
+    }
+
+    // İki olası sözlük girdisi + UTC farkı + oturum kaydı
+    unsigned char buffer[2 * BINARY_MAX_RECORD_BYTES];
+    unsigned char *cursor = buffer;
+    LogField pending[2] = { { NULL, 0 }, { NULL, 0 } };
+    int num_pending = 0;
+
+    uint64_t category_id = encode_dictionary_name(writer, &record->category, &cursor, pending, &num_pending);
+    if (record->type != LOG_RECORD_SESSION) {
+        // Silme işareti: fark kodlaması ve UTC farkı durumunu etkilemez
+        bool is_category = (record->type == LOG_RECORD_DELETE_CATEGORY);
+        uint64_t focus_id = is_category ? 0 : encode_dictionary_name(writer, &record->focus, &cursor, pending, &num_pending);
+        *cursor++ = BINARY_TAG_TOMBSTONE;
+        cursor = write_varint(cursor, is_category ? 0 : 1);
+        cursor = write_varint(cursor, category_id);
+        if (!is_category) {
+            cursor = write_varint(cursor, focus_id);
+        }
+        if (writer->binary_state->entity_ids) {
+            cursor = write_varint(cursor, record->category_id);
+            if (!is_category) {
+                cursor = write_varint(cursor, record->focus_id);
+            }
+        }
+        cursor = write_varint(cursor, zigzag_encode((int64_t)record->start_time));
+        return log_writer_emit(writer, buffer, (size_t)(cursor - buffer));
+    }
+    uint64_t focus_id = encode_dictionary_name(writer, &record->focus, &cursor, pending, &num_pending);
+
+    if (record->utc_offset != writer->binary_state->utc_offset) {
+        *cursor++ = BINARY_TAG_UTC_OFFSET;
+        cursor = write_varint(cursor, zigzag_encode((int64_t)record->utc_offset));
+        if (writer->commit_state) {
+            writer->binary_state->utc_offset = record->utc_offset;
+        }
+    }
+
+    time_t span = record->end_time - record->start_time;
+    *cursor++ = BINARY_TAG_SESSION;
+    cursor = write_varint(cursor, category_id);
+    cursor = write_varint(cursor, focus_id);
+    if (writer->binary_state->entity_ids) {
+        cursor = write_varint(cursor, record->category_id);
+        cursor = write_varint(cursor, record->focus_id);
+    }
+    cursor = write_varint(cursor, zigzag_encode((int64_t)(record->start_time - writer->binary_state->last_start)));
+    cursor = write_varint(cursor, (uint64_t)(span > 0 ? span : 0));
+    cursor = write_varint(cursor, (uint64_t)(record->duration > 0 ? record->duration : 0));
+    if (writer->commit_state) {
+        writer->binary_state->last_start = record->start_time;
+    }
+
+    return log_writer_emit(writer, buffer, (size_t)(cursor - buffer));
+}
+
+bool log_writer_close(LogWriter *writer) {
+    bool ok = (writer->file != NULL || writer->fd != -1);
+    if (writer->file != NULL) {
+        ok = fclose(writer->file) == 0;
+        writer->file = NULL;
+    }
+    if (writer->fd != -1) {
+        ok = close(writer->fd) == 0 && ok;
+        writer->fd = -1;
+    }
+    work_log_unlock(writer->lock_fd);
+    writer->lock_fd = -1;
+    return ok;
+}
+
+// Silme indeksinin ad anahtarı: "<kategori>\x1e" (kategori) veya "<kategori>\x1f<odak>" (odak).
+// from_entity ise anahtar '\x1c' ile başlar: ID'li bir silme işaretinin adı, yalnızca kimlik
+// geçişinden önce adla yazılmış oturumları eşler (aynı adla sonradan oluşturulan varlığı değil).
+static size_t make_tombstone_name_key(const LogRecord *record, bool whole_category, bool from_entity, char *key, size_t key_size) {
+    size_t cat_len = record->category.len < MAX_CATEGORY_NAME_LEN ? record->category.len : MAX_CATEGORY_NAME_LEN - 1;
+    size_t focus_len = record->focus.len < MAX_FOCUS_NAME_LEN ? record->focus.len : MAX_FOCUS_NAME_LEN - 1;
+    size_t len = 0;
+    if (from_entity) key[len++] = '\x1c';
+    memcpy(key + len, record->category.ptr, cat_len);
+    len += cat_len;
+    key[len++] = whole_category ? '\x1e' : '\x1f';
+    if (!whole_category && len + focus_len <= key_size) {
+        memcpy(key + len, record->focus.ptr, focus_len);
+        len += focus_len;
+    }
+    return len;
+}
+
+// Silme indeksinin anahtarı. Kalıcı ID'li kayıtlarda "\x1d<kategori id>\x1e" (kategori)
+// veya "\x1d<kategori id>\x1f<odak id>" (odak); ID'siz eski kayıtlarda ad anahtarı kullanılır.
+static size_t make_tombstone_key(const LogRecord *record, bool whole_category, char *key, size_t key_size) {
+    if (record->category_id != 0) {
+        int len = whole_category ? snprintf(key, key_size, "\x1d%u\x1e", record->category_id)
+                                 : snprintf(key, key_size, "\x1d%u\x1f%u", record->category_id, record->focus_id);
+        return (size_t)len;
+    }
+    return make_tombstone_name_key(record, whole_category, false, key, key_size);
+}
+
+// Anahtarın son silme sıra numarasını günceller
+// Return: true (başarılı), false (bellek hatası)
+static bool tombstone_index_put(TombstoneIndex *index, const char *key, size_t key_len, long sequence) {
+    int id = name_dictionary_find(&index->keys, key, key_len);
+    if (id == -1) {
+        id = name_dictionary_add(&index->keys, key, key_len);
+        if (id == -1) {
+            return false;
+        }
+        long *last_sequence = realloc(index->last_sequence, index->keys.capacity * sizeof(long));
+        if (last_sequence == NULL) {
+            return false;
+        }
+        index->last_sequence = last_sequence;
+    }
+    index->last_sequence[id] = sequence;
+    return true;
+}
+
+// Anahtar için son silme işareti kaydın sıra numarasından sonra mı?
+static bool tombstone_index_covers(const TombstoneIndex *index, const char *key, size_t key_len, long sequence) {
+    int id = name_dictionary_find(&index->keys, key, key_len);
+    return id != -1 && index->last_sequence[id] > sequence;
+}
+
+void tombstone_index_free(TombstoneIndex *index) {
+    name_dictionary_free(&index->keys);
+    free(index->last_sequence);
+    index->last_sequence = NULL;
+}
+
+// Logu bir kez okuyup her silinen kategori/odak için son silme işaretinin sıra
+// numarasını toplar. Sıra numarası, okuyucunun döndürdüğü kayıtların sayacıdır.
+// Return: true (başarılı), false (log okunamadı veya bellek hatası)
+bool build_tombstone_index(const char *path, LogFormat format, TombstoneIndex *index) {
+    BinaryLogState state = { 0 };
+    LogReader reader;
+    LogRecord record;
+    memset(index, 0, sizeof(*index));
+    if (!log_reader_open(&reader, path, format, 0, &state)) {
+        return false;
+    }
+
+    bool ok = true;
+    long sequence = 0;
+    while (ok && log_reader_next(&reader, &record)) {
+        if (record.type != LOG_RECORD_SESSION) {
+            bool whole_category = (record.type == LOG_RECORD_DELETE_CATEGORY);
+            char key[MAX_CATEGORY_NAME_LEN + MAX_FOCUS_NAME_LEN + 2];
+            size_t key_len = make_tombstone_key(&record, whole_category, key, sizeof(key));
+            ok = tombstone_index_put(index, key, key_len, sequence);
+            if (ok && record.category_id != 0) {
+                // Kimlik geçişinden önce adla yazılmış oturumlar da silinir
+                key_len = make_tombstone_name_key(&record, whole_category, true, key, sizeof(key));
+                ok = tombstone_index_put(index, key, key_len, sequence);
+            }
+        }
+        sequence++;
+    }
+
+    log_reader_close(&reader);
+    binary_log_state_reset(&state);
+    if (!ok) {
+        tombstone_index_free(index);
+    }
+    return ok;
+}
+
+// Kayıt silinmiş mi? Silme işaretleri her zaman ölü sayılır; oturumlar, kendilerinden
+// sonra gelen bir kategori veya odak silme işareti varsa ölüdür.
+bool is_record_deleted(const TombstoneIndex *index, const LogRecord *record, long sequence) {
+    if (record->type != LOG_RECORD_SESSION) {
+        return true;
+    }
+    if (index->keys.count == 0) {
+        return false;
+    }
+
+    // ID'li oturum kendi ID anahtarlarıyla ve ID'siz eski silme işaretlerinin ad anahtarlarıyla;
+    // ID'siz oturum hem eski hem ID'li silme işaretlerinin ad anahtarlarıyla eşlenir
+    char key[MAX_CATEGORY_NAME_LEN + MAX_FOCUS_NAME_LEN + 2];
+    for (int whole_category = 1; whole_category >= 0; whole_category--) {
+        size_t key_len = make_tombstone_key(record, whole_category, key, sizeof(key));
+        if (tombstone_index_covers(index, key, key_len, sequence)) {
+            return true;
+        }
+        key_len = make_tombstone_name_key(record, whole_category, record->category_id == 0, key, sizeof(key));
+        if (tombstone_index_covers(index, key, key_len, sequence)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Logu bir dosyadan diğerine kopyalar ve istenirse biçimi dönüştürür. Silme indeksi
+// verilirse ölü oturumlar ve silme işaretleri atlanır (sıkıştırma); NULL ise tüm
+// kayıtlar aynen kopyalanır. assign_entity_ids true ise ID'siz kayıtlara adlarından
+// kalıcı ID atanır. CSV'den CSV'ye satırlar mümkünse yeniden kodlanmadan kopyalanır.
+// final_state verilirse yeni ikili logun sonundaki durum oraya taşınır (NULL: bırakılır).
+// Return: true (başarılı), false (hata)
+bool copy_work_log(const char *src_path, LogFormat src_format, const char *dst_path, LogFormat dst_format, const TombstoneIndex *tombstones, bool assign_entity_ids, BinaryLogState *final_state) {
+    BinaryLogState src_state = { 0 };
+    BinaryLogState dst_state = { 0 };
+    LogReader reader;
+    LogWriter writer;
+
+    if (!log_reader_open(&reader, src_path, src_format, 0, &src_state)) {
+        return false;
+    }
+    reader.parse_times = true;
+    if (!log_writer_open(&writer, dst_path, dst_format, "w", &dst_state, true)) {
+        fprintf(stderr, "Hata: Geçici dosya oluşturulamadı: %s\n", dst_path);
+        log_reader_close(&reader);
+        return false;
+    }
+
+    bool ok = true;
+    bool raw_copy = (src_format == LOG_FORMAT_CSV && dst_format == LOG_FORMAT_CSV && reader.schema.category_id_column != -1);
+    LogRecord record;
+    long sequence = 0;
+    while (ok && log_reader_next(&reader, &record)) {
+        if (tombstones != NULL && is_record_deleted(tombstones, &record, sequence++)) {
+            continue;
+        }
+        if (assign_entity_ids && record.category_id == 0) {
+            resolve_record_entity_ids(&record);
+        }
+        if (raw_copy && !assign_entity_ids) {
+            // Orijinal satırı yeni dosyaya yaz
+            ok = fwrite(reader.scanner.row, 1, reader.scanner.row_len, writer.file) == reader.scanner.row_len && fputc('\n', writer.file) != EOF;
+        } else {
+            ok = log_writer_append(&writer, &record);
+        }
+    }
+    if (reader.skipped_bytes > 0) {
+        // Bozuk baytlar yeni dosyaya taşınmaz; kurtarma imkânı kalsın diye log yeniden yazılmaz
+        fprintf(stderr, "Hata: %s içinde %lld bozuk bayt var (ilki %lld. baytta); log yeniden yazılmadı.\n",
+                src_path, (long long)reader.skipped_bytes, (long long)reader.first_skipped);
+        ok = false;
+    }
+
+    log_reader_close(&reader);
+    ok = log_writer_close(&writer) && ok;
+    binary_log_state_reset(&src_state);
+    if (ok && final_state != NULL) {
+        binary_log_state_reset(final_state);
+        *final_state = dst_state;
+    } else {
+        binary_log_state_reset(&dst_state);
+    }
+    return ok;
+}
+
+// Zamanı kaydedildiği andaki UTC farkıyla "YYYY-MM-DD HH:MM:SS" olarak biçimlendirir.
+// Saat dilimi veritabanına başvurmaz; yalnızca gösterim ve dışa aktarım içindir.
+void format_log_timestamp(time_t epoch, long utc_offset, char *buffer, size_t buffer_size) {
+    time_t shifted = epoch + utc_offset;
+    struct tm tm_value;
+    gmtime_r(&shifted, &tm_value);
+    strftime(buffer, buffer_size, "%Y-%m-%d %H:%M:%S", &tm_value);
+}
+
+// Eski logu bir kez güncel biçime yükseltir:
+//  - yerel zaman metinli CSV -> epoch sütunları (eski dosya work_log.csv.legacy.bak olarak saklanır)
+//  - kalıcı ID'siz CSV/ikili log -> ID'li kayıtlar (eski dosya .v1.bak olarak saklanır)
+// ID'ler kategori dosyasındaki adlardan atanır, bu yüzden önce load_data() çağrılmalıdır.
+// Adla yazılmış silme işaretleri ID'li kayıtlara uygulanamayacağı için yükseltmede
+// uygulanıp atılır.
+// Return: true (yükseltme gerekmedi veya başarılı), false (hata)
+bool upgrade_work_log_schema() {
+    const char *log_path = active_log_path();
+    BinaryLogState state = { 0 };
+    LogReader reader;
+    if (!log_reader_open(&reader, log_path, active_log_format, 0, &state)) {
+        binary_log_state_reset(&state);
+        return true; // Henüz log yok
+    }
+    bool empty = (reader.scanner.end == 0);
+    bool legacy_times = (active_log_format == LOG_FORMAT_CSV && !reader.schema.epoch_times);
+    bool missing_ids = (active_log_format == LOG_FORMAT_CSV) ? (reader.schema.category_id_column == -1) : !state.entity_ids;
+    log_reader_close(&reader);
+    binary_log_state_reset(&state);
+    if (empty || (!legacy_times && !missing_ids)) {
+        return true;
+    }
+
+    char temp_path[320], backup_path[320];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", log_path);
+    snprintf(backup_path, sizeof(backup_path), "%s%s", log_path, legacy_times ? ".legacy.bak" : ".v1.bak");
+
+    // Kopya kilit altında alınır: bu sırada eklenen kayıt eski dosyada kalıp kaybolmaz
+    int lock_fd = work_log_lock(LOCK_EX);
+    TombstoneIndex tombstones;
+    if (!build_tombstone_index(log_path, active_log_format, &tombstones)) {
+        work_log_unlock(lock_fd);
+        return false;
+    }
+    bool ok = copy_work_log(log_path, active_log_format, temp_path, active_log_format, &tombstones, true, NULL);
+    tombstone_index_free(&tombstones);
+    if (!ok) {
+        remove(temp_path);
+        work_log_unlock(lock_fd);
+        return false;
+    }
+    ok = (rename(log_path, backup_path) == 0 && rename(temp_path, log_path) == 0);
+    if (ok && lock_fd != -1) bump_work_log_generation(lock_fd);
+    work_log_unlock(lock_fd);
+    invalidate_statistics();
+    return ok;
+}
+
+// Bir alanı çift tırnak içinde yazar; alandaki " karakteri "" olarak ikilenir (RFC 4180)
+static void print_csv_field(FILE *out, const char *text, size_t len) {
+    fputc('"', out);
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] == '"') fputc('"', out);
+        fputc(text[i], out);
+    }
+    fputc('"', out);
+}
+
+// Bir alanı sekmeyle ayrılmış satıra yazar; sekme, satır sonu ve ters bölü \t, \n, \r, \\ olarak kaçırılır
+static void print_tsv_field(FILE *out, const char *text, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        switch (text[i]) {
+            case '\t': fputs("\\t", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\\': fputs("\\\\", out); break;
+            default: fputc(text[i], out); break;
+        }
+    }
+}
+
+// Etkin logu insan tarafından okunabilir zamanlarla CSV olarak yazdırır
+bool export_work_log(FILE *out) {
+    BinaryLogState state = { 0 };
+    TombstoneIndex tombstones;
+    LogReader reader;
+    LogRecord record;
+    if (!build_tombstone_index(active_log_path(), active_log_format, &tombstones)) {
+        return false;
+    }
+    if (!log_reader_open(&reader, active_log_path(), active_log_format, 0, &state)) {
+        tombstone_index_free(&tombstones);
+        return false;
+    }
+    reader.parse_times = true;
+
+    // Yalnızca canlı oturumlar aktarılır
+    fprintf(out, "\"Category\",\"Focus\",\"StartTime\",\"EndTime\",\"Duration\"\n");
+    long sequence = 0;
+    while (log_reader_next(&reader, &record)) {
+        if (is_record_deleted(&tombstones, &record, sequence++)) {
+            continue;
+        }
+        // Kalıcı ID'si bilinen kayıtlar güncel (yeniden adlandırılmış olabilecek) adlarla yazılır
+        int cat_idx, focus_idx;
+        if (record.focus_id != 0 && lookup_entity(record.focus_id, &cat_idx, &focus_idx) && focus_idx != -1) {
+            record.category = (LogField){ user_categories[cat_idx].name, strlen(user_categories[cat_idx].name) };
+            record.focus = (LogField){ user_categories[cat_idx].focuses[focus_idx].name, strlen(user_categories[cat_idx].focuses[focus_idx].name) };
+        }
+        char start_str[32], end_str[32];
+        format_log_timestamp(record.start_time, record.utc_offset, start_str, sizeof(start_str));
+        format_log_timestamp(record.end_time, record.utc_offset, end_str, sizeof(end_str));
+        print_csv_field(out, record.category.ptr, record.category.len);
+        fputc(',', out);
+        print_csv_field(out, record.focus.ptr, record.focus.len);
+        fprintf(out, ",\"%s\",\"%s\",%ld\n", start_str, end_str, record.duration);
+    }
+    if (reader.skipped_bytes > 0) {
+        fprintf(stderr, "Uyarı: çalışma logunda %lld bozuk bayt atlandı (ilki %lld. baytta).\n",
+                (long long)reader.skipped_bytes, (long long)reader.first_skipped);
+    }
+    log_reader_close(&reader);
+    binary_log_state_reset(&state);
+    tombstone_index_free(&tombstones);
+    return true;
+}
+
+// --since değerini çözer: "30m", "12h", "7d", "2w" (şimdiden geriye), "today" (bugün
+// gece yarısı) veya "YYYY-MM-DD" (o günün yerel gece yarısı)
+// Return: true (geçerli), false (tanınmayan biçim)
+bool parse_since_argument(const char *text, time_t now, time_t *since) {
+    struct tm local_tm;
+    localtime_r(&now, &local_tm);
+    if (strcmp(text, "today") == 0) {
+        local_tm.tm_hour = 0;
+        local_tm.tm_min = 0;
+        local_tm.tm_sec = 0;
+        local_tm.tm_isdst = -1;
+        *since = mktime(&local_tm);
+        return *since != (time_t)-1;
+    }
+
+    int year, month, day;
+    char trailing;
+    if (sscanf(text, "%4d-%2d-%2d%c", &year, &month, &day, &trailing) == 3) {
+        memset(&local_tm, 0, sizeof(local_tm));
+        local_tm.tm_year = year - 1900;
+        local_tm.tm_mon = month - 1;
+        local_tm.tm_mday = day;
+        local_tm.tm_isdst = -1;
+        *since = mktime(&local_tm);
+        return *since != (time_t)-1;
+    }
+
+    char *end;
+    long amount = strtol(text, &end, 10);
+    if (end == text || amount < 0 || end[0] == '\0' || end[1] != '\0') {
+        return false;
+    }
+    long unit;
+    switch (end[0]) {
+        case 'm': unit = 60; break;
+        case 'h': unit = 60 * 60; break;
+        case 'd': unit = 24 * 60 * 60; break;
+        case 'w': unit = 7 * 24 * 60 * 60; break;
+        default: return false;
+    }
+    *since = now - (time_t)(amount * unit);
+    return true;
+}
+
+// Kalıcı ID'si bilinen istatistik girdilerinin güncel (yeniden adlandırılmış olabilecek) adları
+static const char *stats_query_category_name(const StatCategory *stat_cat) {
+    int cat_idx, focus_idx;
+    if (stat_cat->id != 0 && lookup_entity(stat_cat->id, &cat_idx, &focus_idx) && focus_idx == -1) {
+        return user_categories[cat_idx].name;
+    }
+    return stat_cat->name;
+}
+
+static const char *stats_query_focus_name(const StatFocus *stat_focus) {
+    int cat_idx, focus_idx;
+    if (stat_focus->id != 0 && lookup_entity(stat_focus->id, &cat_idx, &focus_idx) && focus_idx != -1) {
+        return user_categories[cat_idx].focuses[focus_idx].name;
+    }
+    return stat_focus->name;
+}
+
+// Bir sorgu satırını yazar; CSV alanları dışa aktarımdaki gibi tırnaklanır, TSV alanlarında
+// ayırıcı ve satır sonu kaçırılır
+static void print_stats_query_row(FILE *out, bool csv, const char *category, const char *focus, int sessions, long seconds) {
+    const char *names[2] = { category, focus };
+    char separator = csv ? ',' : '\t';
+    for (int i = 0; i < 2; i++) {
+        if (names[i] == NULL) continue;
+        if (csv) {
+            print_csv_field(out, names[i], strlen(names[i]));
+        } else {
+            print_tsv_field(out, names[i], strlen(names[i]));
+        }
+        fputc(separator, out);
+    }
+    fprintf(out, "%d%c%ld\n", sessions, separator, seconds);
+}
+
+// `focuslog stats` alt komutu: ncurses başlatılmadan istatistik toplamlarını yazdırır.
+// Toplamlar arayüzle aynı load_statistics() yolundan gelir.
+//   --since 7d|12h|today|YYYY-MM-DD  yalnızca bu andan sonra başlayan oturumlar
+//   --category AD / --focus AD        yalnızca bu kategori / odak
+//   --by focus|category|total         satır başına odak (varsayılan), kategori veya tek toplam
+//   --format tsv|csv                  sekmeyle ayrılmış başlıksız satırlar (varsayılan) veya başlıklı CSV
+// Return: çıkış kodu
+int run_stats_query(int argc, char **argv, FILE *out) {
+    const char *category_filter = NULL;
+    const char *focus_filter = NULL;
+    const char *group_by = "focus";
+    bool csv = false;
+    time_t since = 0;
+
+    for (int i = 2; i < argc; i++) {
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool valid = (value != NULL);
+        if (strcmp(argv[i], "--since") == 0) {
+            valid = valid && parse_since_argument(value, time(NULL), &since);
+        } else if (strcmp(argv[i], "--category") == 0) {
+            category_filter = value;
+        } else if (strcmp(argv[i], "--focus") == 0) {
+            focus_filter = value;
+        } else if (strcmp(argv[i], "--by") == 0) {
+            group_by = value;
+            valid = valid && (strcmp(value, "focus") == 0 || strcmp(value, "category") == 0 || strcmp(value, "total") == 0);
+        } else if (strcmp(argv[i], "--format") == 0) {
+            csv = valid && strcmp(value, "csv") == 0;
+            valid = valid && (csv || strcmp(value, "tsv") == 0);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            fprintf(stderr, "Kullanım: %s stats [--since 7d|12h|today|YYYY-MM-DD] [--category AD] [--focus AD] "
+                            "[--by focus|category|total] [--format tsv|csv]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    load_data(); // Kalıcı ID'li girdiler güncel adlarla eşlenir
+    stats_since_time = since;
+    // Aralıksız sorgular önceki sorgunun toplamlarından devam eder; yalnızca yeni kayıtlar okunur
+    bool cached = (since == 0 && load_stats_cache());
+    unsigned long loaded_generation = stats_generation;
+    load_statistics();
+    if (since == 0 && (!cached || stats_generation != loaded_generation)) {
+        save_stats_cache();
+    }
+    if (global_stat_table.corrupt_bytes > 0) {
+        fprintf(stderr, "Uyarı: çalışma logunda %lld bozuk bayt atlandı; toplamlar eksik olabilir.\n", global_stat_table.corrupt_bytes);
+    }
+
+    bool by_focus = (strcmp(group_by, "focus") == 0);
+    bool by_category = (strcmp(group_by, "category") == 0);
+    if (csv) {
+        fprintf(out, "%s\"Sessions\",\"Seconds\"\n",
+                by_focus ? "\"Category\",\"Focus\"," : (by_category ? "\"Category\"," : ""));
+    }
+
+    bool category_found = (category_filter == NULL);
+    int total_sessions = 0;
+    long total_seconds = 0;
+    for (int i = 0; i < global_stat_table.num_categories; i++) {
+        const StatCategory *stat_cat = &global_stat_table.categories[i];
+        const char *category_name = stats_query_category_name(stat_cat);
+        if (category_filter != NULL && strcmp(category_name, category_filter) != 0) {
+            continue;
+        }
+        category_found = true;
+
+        int category_sessions = 0;
+        long category_seconds = 0;
+        for (int j = 0; j < stat_cat->num_focuses; j++) {
+            const StatFocus *stat_focus = &stat_cat->focuses[j];
+            if (stat_focus->session_count == 0) {
+                continue; // Silinmiş veya aralık dışında kalmış
+            }
+            const char *focus_name = stats_query_focus_name(stat_focus);
+            if (focus_filter != NULL && strcmp(focus_name, focus_filter) != 0) {
+                continue;
+            }
+            if (by_focus) {
+                print_stats_query_row(out, csv, category_name, focus_name, stat_focus->session_count, stat_focus->total_duration);
+            }
+            category_sessions += stat_focus->session_count;
+            category_seconds += stat_focus->total_duration;
+        }
+        if (by_category && category_sessions > 0) {
+            print_stats_query_row(out, csv, category_name, NULL, category_sessions, category_seconds);
+        }
+        total_sessions += category_sessions;
+        total_seconds += category_seconds;
+    }
+
+    // Henüz oturumu olmayan ama tanımlı kategori de geçerli bir sorgudur
+    for (int i = 0; !category_found && i < num_user_categories; i++) {
+        category_found = (strcmp(user_categories[i].name, category_filter) == 0);
+    }
+    if (!category_found) {
+        fprintf(stderr, "Hata: Kategori bulunamadı: %s\n", category_filter);
+        return EXIT_FAILURE;
+    }
+    if (!by_focus && !by_category) {
+        print_stats_query_row(out, csv, NULL, NULL, total_sessions, total_seconds);
+    }
+    return EXIT_SUCCESS;
+}
+
+// `focuslog record KATEGORİ ODAK SANİYE`: şimdi biten bir oturumu kaydeder. Modelde bulunan
+// kategori/odak kalıcı ID'leriyle, bulunmayanlar (resolve_record_entity_ids gibi) adla yazılır.
+// Return: çıkış kodu
+int run_record_command(int argc, char **argv) {
+    char *end = NULL;
+    long duration = (argc == 5) ? strtol(argv[4], &end, 10) : 0;
+    if (argc != 5 || end == argv[4] || *end != '\0' || duration <= 0) {
+        fprintf(stderr, "Kullanım: %s record KATEGORİ ODAK SANİYE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    load_data();
+    Category category = { 0 };
+    Focus focus = { 0 };
+    category.name = argv[2];
+    focus.name = argv[3];
+    for (int i = 0; i < num_user_categories; i++) {
+        if (strcmp(user_categories[i].name, argv[2]) != 0) continue;
+        for (int j = 0; j < user_categories[i].num_focuses; j++) {
+            if (strcmp(user_categories[i].focuses[j].name, argv[3]) == 0) {
+                category.id = user_categories[i].id;
+                focus.id = user_categories[i].focuses[j].id;
+                break;
+            }
+        }
+        break;
+    }
+
+    time_t end_time = time(NULL);
+    return record_work_session(&category, &focus, end_time - (time_t)duration, end_time, duration) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Silinen kategori (deleted_focus NULL) veya odak için loga bir silme işareti ekler.
+// Eski kayıtlar okunurken yok sayılır ve sonraki sıkıştırmada fiziksel olarak atılır;
+// böylece silme işlemi logun tamamını yeniden yazmaz.
+// Return: true (başarılı), false (hata)
+bool append_work_log_tombstone(const Category *deleted_category, const Focus *deleted_focus) {
+    if (access(active_log_path(), F_OK) != 0) {
+        // Dosya yoksa silinecek kayıt da yok.
+        return true;
+    }
+    LogWriter writer;
+    if (!log_writer_open(&writer, active_log_path(), active_log_format, "a", &writer_binary_state, false)) {
+        fprintf(stderr, "Hata: Çalışma kayıt dosyasına yazılamadı: %s\n", active_log_path());
+        return false;
+    }
+    if (active_log_format == LOG_FORMAT_BINARY) {
+        // Sözlük durumunu, özel kilit altında dosyanın sonuna getir
+        sync_binary_log_state();
+    }
+
+    LogRecord record = { 0 };
+    record.type = (deleted_focus == NULL) ? LOG_RECORD_DELETE_CATEGORY : LOG_RECORD_DELETE_FOCUS;
+    record.category = (LogField){ deleted_category->name, strlen(deleted_category->name) };
+    record.focus = (deleted_focus == NULL) ? (LogField){ "", 0 } : (LogField){ deleted_focus->name, strlen(deleted_focus->name) };
+    record.category_id = deleted_category->id;
+    record.focus_id = (deleted_focus == NULL) ? 0 : deleted_focus->id;
+    record.start_time = time(NULL);
+    record.end_time = record.start_time;
+    bool ok = log_writer_append(&writer, &record);
+    return log_writer_close(&writer) && ok;
+}
+
+// Ölü oturumları ve silme işaretlerini atarak etkin logu yeniden yazar
+// Return: true (başarılı veya log yok), false (hata)
+bool compact_work_log() {
+    const char *log_path = active_log_path();
+    if (access(log_path, F_OK) != 0) {
+        return true;
+    }
+
+    char temp_file_path[300];
+    snprintf(temp_file_path, sizeof(temp_file_path), "%s/work_log_temp%s", focuslog_data_dir,
+             active_log_format == LOG_FORMAT_BINARY ? ".bin" : ".csv");
+
+    // Silme indeksi ve kopya aynı kilit altında: araya giren ekleme veya silme kaybolmaz
+    int lock_fd = work_log_lock(LOCK_EX);
+    TombstoneIndex tombstones;
+    if (!build_tombstone_index(log_path, active_log_format, &tombstones)) {
+        work_log_unlock(lock_fd);
+        return false;
+    }
+    BinaryLogState final_state = { 0 };
+    bool ok = copy_work_log(log_path, active_log_format, temp_file_path, active_log_format, &tombstones, false, &final_state);
+    tombstone_index_free(&tombstones);
+
+    // Orijinal dosyayı geçici dosyayla değiştir
+    if (ok && rename(temp_file_path, log_path) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        remove(temp_file_path);
+    } else if (lock_fd != -1) {
+        bump_work_log_generation(lock_fd);
+        if (active_log_format == LOG_FORMAT_BINARY) {
+            adopt_binary_writer_state(&final_state); // Sonraki ekleme yeni logu baştan okumaz
+        }
+    }
+    binary_log_state_reset(&final_state);
+    work_log_unlock(lock_fd);
+    if (ok) {
+        invalidate_statistics(); // Log yeniden yazıldı, istatistikler baştan yüklenmeli
+    }
+    return ok;
+}
+
+// Ölü baytlar hem COMPACT_MIN_DEAD_BYTES'ı hem de logun COMPACT_DEAD_PERCENT
+// yüzdesini aşarsa logu sıkıştırır. Karar yayımlanan görüntünün ölü baytlarıyla verilir;
+// görüntü arka planda kuruluyorsa log burada okunmaz ve karar sonraki silmeye kalır.
+// Return: true (sıkıştırıldı), false (gerek yok, görüntü hazır değil veya hata)
+bool maybe_compact_work_log() {
+    if (stats_build.running || !stats_checkpoint.valid) {
+        return false;
+    }
+    request_statistics(); // Yeni silme işaretleri yalnızca logun sonundan okunur
+    if (stats_build.running || !stats_checkpoint.valid || stats_retry_at_ms != 0) {
+        return false; // Eklenen kısım büyük: arka plana verildi (veya yapım başlatılamadı)
+    }
+
+    struct stat st;
+    if (stat(active_log_path(), &st) != 0) {
+        return false;
+    }
+    long long dead_bytes = global_stat_table.dead_bytes;
+    if (dead_bytes < COMPACT_MIN_DEAD_BYTES || dead_bytes * 100 < (long long)st.st_size * COMPACT_DEAD_PERCENT) {
+        return false;
+    }
+    return compact_work_log();
+}
+
+// Etkin logu yalnızca başlığı olan yeni bir dosyayla değiştirir. Yerinde kısaltmak
+// yerine rename() kullanılır; eski dosyayı okumakta olan örnekler tutarlı bir görüntü görür.
+bool reset_work_log() {
+    char temp_path[320];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", active_log_path());
+
+    int lock_fd = work_log_lock(LOCK_EX);
+    LogWriter writer;
+    BinaryLogState state = { 0 };
+    bool ok = log_writer_open(&writer, temp_path, active_log_format, "w", &state, true);
+    ok = ok && log_writer_close(&writer) && rename(temp_path, active_log_path()) == 0;
+    if (!ok) {
+        remove(temp_path);
+    } else if (lock_fd != -1) {
+        bump_work_log_generation(lock_fd);
+    }
+    work_log_unlock(lock_fd);
+    invalidate_statistics();
+    return ok;
+}
+
+// Etkin logu hedef biçime dönüştürür. Eski dosya .bak uzantısıyla saklanır.
+// Return: true (başarılı), false (hata)
+bool convert_work_log(LogFormat target_format) {
+    detect_active_log_format();
+    if (active_log_format == target_format) {
+        printf("Çalışma logu zaten %s biçiminde.\n", target_format == LOG_FORMAT_BINARY ? "ikili" : "CSV");
+        return true;
+    }
+
+    const char *src_path = active_log_path();
+    const char *dst_path = (target_format == LOG_FORMAT_BINARY) ? work_log_bin_path : work_log_file_path;
+    char temp_path[320], backup_path[320];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", dst_path);
+    snprintf(backup_path, sizeof(backup_path), "%s.bak", src_path);
+
+    int lock_fd = work_log_lock(LOCK_EX);
+    if (access(src_path, F_OK) != 0) {
+        // Henüz log yok: boş bir hedef log oluştur
+        LogWriter writer;
+        BinaryLogState state = { 0 };
+        if (!log_writer_open(&writer, dst_path, target_format, "w", &state, true) || !log_writer_close(&writer)) {
+            fprintf(stderr, "Hata: Log oluşturulamadı: %s\n", dst_path);
+            work_log_unlock(lock_fd);
+            return false;
+        }
+    } else {
+        if (!copy_work_log(src_path, active_log_format, temp_path, target_format, NULL, false, NULL)) {
+            fprintf(stderr, "Hata: Log dönüştürülemedi: %s\n", src_path);
+            remove(temp_path);
+            work_log_unlock(lock_fd);
+            return false;
+        }
+        if (rename(temp_path, dst_path) != 0 || rename(src_path, backup_path) != 0) {
+            fprintf(stderr, "Hata: Dönüştürülen log yerine konamadı: %s\n", dst_path);
+            work_log_unlock(lock_fd);
+            return false;
+        }
+    }
+    if (lock_fd != -1) bump_work_log_generation(lock_fd);
+    work_log_unlock(lock_fd);
+
+    struct stat st;
+    long long size = (stat(dst_path, &st) == 0) ? (long long)st.st_size : 0;
+    printf("Çalışma logu dönüştürüldü: %s (%lld bayt)\n", dst_path, size);
+    detect_active_log_format();
+    invalidate_statistics();
+    return true;
+}
+
+
+void create_data_directory() {
+    const char *home_dir = getenv("HOME");
+    if (home_dir == NULL) {
+        fprintf(stderr, "Hata: HOME ortam değişkeni bulunamadı.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    snprintf(focuslog_data_dir, sizeof(focuslog_data_dir), "%s/.config/focuslog", home_dir);
+
+    if (mkdir(focuslog_data_dir, 0755) == -1 && errno != EEXIST) {
+        fprintf(stderr, "Hata: Dizin oluşturulamadı: %s\n", focuslog_data_dir);
+        exit(EXIT_FAILURE);
+    }
+
+    snprintf(categories_file_path, sizeof(categories_file_path), "%s/categories_and_focuses.txt", focuslog_data_dir);
+    snprintf(settings_file_path, sizeof(settings_file_path), "%s/settings.conf", focuslog_data_dir);
+    snprintf(work_log_file_path, sizeof(work_log_file_path), "%s/work_log.csv", focuslog_data_dir);
+    snprintf(work_log_bin_path, sizeof(work_log_bin_path), "%s/work_log.bin", focuslog_data_dir);
+    snprintf(daemon_socket_path, sizeof(daemon_socket_path), "%s/%s", focuslog_data_dir, DAEMON_SOCKET_NAME);
+    snprintf(work_log_lock_path, sizeof(work_log_lock_path), "%s/%s", focuslog_data_dir, WORK_LOG_LOCK_NAME);
+    snprintf(categories_lock_path, sizeof(categories_lock_path), "%s/%s", focuslog_data_dir, CATEGORIES_LOCK_NAME);
+    snprintf(stats_cache_path, sizeof(stats_cache_path), "%s/%s", focuslog_data_dir, STATS_CACHE_NAME);
+    detect_active_log_format();
+}
+
+// --- Kategori Dosyası ---
+// Birden fazla örnek (ör. iki terminal) aynı kategori dosyasını düzenleyebilir. Her örnek
+// dosyanın son okuduğu/yazdığı halini (category_base) saklar. Kaydederken veya başka bir
+// örneğin değişikliği geldiğinde taban, bellekteki model ve diskteki sürüm kalıcı ID'lerle
+// üç yönlü birleştirilir; hiçbir örnek diğerinin düzenlemesinin üzerine yazmaz.
+
+static bool category_snapshot_add(CategorySnapshot *snapshot, const char *name, int color_pair_id, uint32_t id, int parent) {
+    if (snapshot->count == snapshot->capacity) {
+        int capacity = (snapshot->capacity > 0) ? snapshot->capacity * 2 : MODEL_MIN_CAPACITY;
+        CategoryEntry *grown = realloc(snapshot->entries, (size_t)capacity * sizeof(CategoryEntry));
+        if (grown == NULL) return false;
+        snapshot->entries = grown;
+        snapshot->capacity = capacity;
+    }
+    char *name_copy = strdup(name);
+    if (name_copy == NULL) return false;
+    snapshot->entries[snapshot->count++] = (CategoryEntry){ name_copy, color_pair_id, id, parent };
+    free(snapshot->by_id); // ID indeksi bir sonraki aramada yeniden kurulur
+    snapshot->by_id = NULL;
+    return true;
+}
+
+void category_snapshot_free(CategorySnapshot *snapshot) {
+    for (int i = 0; i < snapshot->count; i++) free(snapshot->entries[i].name);
+    free(snapshot->entries);
+    free(snapshot->by_id);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+static void category_snapshot_set_identity(CategorySnapshot *snapshot, const struct stat *st) {
+    snapshot->has_file = true;
+    snapshot->dev = st->st_dev;
+    snapshot->ino = st->st_ino;
+    snapshot->size = st->st_size;
+    snapshot->mtime = st->st_mtim;
+}
+
+// Kategori dosyasının anlık görüntü alındığından beri değişip değişmediğini yalnızca stat() ile söyler
+// Return: true (aynı dosya; yeniden okumaya gerek yok)
+static bool category_file_matches(const CategorySnapshot *snapshot) {
+    struct stat st;
+    if (stat(categories_file_path, &st) != 0) {
+        return !snapshot->has_file;
+    }
+    return snapshot->has_file && st.st_dev == snapshot->dev && st.st_ino == snapshot->ino &&
+           st.st_size == snapshot->size && st.st_mtim.tv_sec == snapshot->mtime.tv_sec &&
+           st.st_mtim.tv_nsec == snapshot->mtime.tv_nsec;
+}
+
+static int compare_entry_keys(const void *a, const void *b) {
+    uint64_t key_a = *(const uint64_t *)a;
+    uint64_t key_b = *(const uint64_t *)b;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+// Return: girdinin konumu, -1 (ID anlık görüntüde yok veya 0)
+static int category_snapshot_find(CategorySnapshot *snapshot, uint32_t id) {
+    if (id == 0 || snapshot->count == 0) return -1;
+    if (snapshot->by_id == NULL) {
+        // Anahtar: üst 32 bit ID, alt 32 bit konum
+        snapshot->by_id = malloc((size_t)snapshot->count * sizeof(uint64_t));
+        if (snapshot->by_id == NULL) {
+            for (int i = 0; i < snapshot->count; i++) {
+                if (snapshot->entries[i].id == id) return i;
+            }
+            return -1;
+        }
+        for (int i = 0; i < snapshot->count; i++) {
+            snapshot->by_id[i] = ((uint64_t)snapshot->entries[i].id << 32) | (uint32_t)i;
+        }
+        qsort(snapshot->by_id, (size_t)snapshot->count, sizeof(uint64_t), compare_entry_keys);
+    }
+    int low = 0, high = snapshot->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if ((uint32_t)(snapshot->by_id[mid] >> 32) < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < snapshot->count && (uint32_t)(snapshot->by_id[low] >> 32) == id) {
+        return (int)(snapshot->by_id[low] & 0xFFFFFFFFu);
+    }
+    return -1;
+}
+
+static bool category_snapshots_equal(const CategorySnapshot *a, const CategorySnapshot *b) {
+    if (a->count != b->count || a->next_id != b->next_id) return false;
+    for (int i = 0; i < a->count; i++) {
+        const CategoryEntry *x = &a->entries[i];
+        const CategoryEntry *y = &b->entries[i];
+        if (x->id != y->id || x->parent != y->parent || x->color_pair_id != y->color_pair_id || strcmp(x->name, y->name) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Dosya yoksa anlık görüntü boş kalır
+// Return: true (okundu), false (bellek yetersiz)
+bool read_category_snapshot(const char *path, CategorySnapshot *snapshot) {
+    category_snapshot_free(snapshot);
+    snapshot->next_id = 1;
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return true;
+    }
+    struct stat st;
+    if (fstat(fileno(file), &st) == 0) {
+        category_snapshot_set_identity(snapshot, &st);
+    }
+
+    bool ok = true;
+    int current_category = -1;
+    char line[MAX_CATEGORY_NAME_LEN + MAX_FOCUS_NAME_LEN + 5 + 10 + 12];
+    while (ok && fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\n")] = 0;
+
+        if (strlen(line) == 0) continue;
+
+        if (strncmp(line, CATEGORIES_NEXT_ID_PREFIX, strlen(CATEGORIES_NEXT_ID_PREFIX)) == 0) {
+            // Silinen kategori/odakların ID'leri yeniden kullanılmasın diye sayaç saklanır
+            uint32_t stored_next_id = (uint32_t)strtoul(line + strlen(CATEGORIES_NEXT_ID_PREFIX), NULL, 10);
+            if (stored_next_id > snapshot->next_id) snapshot->next_id = stored_next_id;
+            continue;
+        }
+
+        bool is_category = (line[0] == '#');
+        if (!is_category && current_category == -1) continue; // Kategorisiz odak satırı
+
+        char *save_ptr;
+        char *name_part = strtok_r(is_category ? line + 1 : line, ";", &save_ptr);
+        char *color_part = strtok_r(NULL, ";", &save_ptr);
+        char *entity_id_part = strtok_r(NULL, ";", &save_ptr);
+        if (name_part == NULL) continue;
+
+        uint32_t entity_id = (entity_id_part != NULL) ? (uint32_t)strtoul(entity_id_part, NULL, 10) : 0;
+        if (entity_id >= snapshot->next_id) snapshot->next_id = entity_id + 1;
+        int color_pair_id = (color_part != NULL) ? atoi(color_part) : -1;
+        if (is_category) current_category = snapshot->count;
+        ok = category_snapshot_add(snapshot, name_part, color_pair_id, entity_id, is_category ? -1 : current_category);
+    }
+    fclose(file);
+    return ok;
+}
+
+// Return: true, false (bellek yetersiz)
+static bool snapshot_user_categories(CategorySnapshot *snapshot) {
+    category_snapshot_free(snapshot);
+    snapshot->next_id = next_entity_id;
+    for (int i = 0; i < num_user_categories; i++) {
+        const Category *cat = &user_categories[i];
+        int parent = snapshot->count;
+        if (!category_snapshot_add(snapshot, cat->name, cat->color_pair_id, cat->id, -1)) return false;
+        for (int j = 0; j < cat->num_focuses; j++) {
+            if (!category_snapshot_add(snapshot, cat->focuses[j].name, cat->focuses[j].color_pair_id, cat->focuses[j].id, parent)) return false;
+        }
+    }
+    return true;
+}
+
+// Modeli anlık görüntüden yeniden kurar; önceden alınan tüm Category/Focus işaretçileri ve
+// adlar geçersiz olur. init_pair çağrısı ensure_all_color_pairs_initialized() içinde yapılır.
+// Return: true (ID'siz eski girdiler var; çağıran ID atamalı)
+static bool build_user_categories(const CategorySnapshot *snapshot) {
+    reset_user_categories(); // Önceki modelin dizileri ve adları tek seferde bırakılır
+    next_available_color_pair_id = MIN_CUSTOM_COLOR_PAIR;
+    next_entity_id = (snapshot->next_id > 0) ? snapshot->next_id : 1;
+
+    bool missing_entity_ids = false;
+    Category *current_cat = NULL;
+    for (int i = 0; i < snapshot->count; i++) {
+        const CategoryEntry *entry = &snapshot->entries[i];
+        if (entry->id == 0) {
+            missing_entity_ids = true;
+        } else if (entry->id >= next_entity_id) {
+            next_entity_id = entry->id + 1;
+        }
+        int color_pair_id = entry->color_pair_id;
+        if (color_pair_id < 0) {
+            color_pair_id = get_random_color_pair(); // Dosyada renk yoksa yeni bir tane ata
+        } else if (color_pair_id >= next_available_color_pair_id) {
+            next_available_color_pair_id = color_pair_id + 1;
+        }
+
+        if (entry->parent == -1) {
+            current_cat = add_user_category(entry->name, color_pair_id, entry->id);
+            if (current_cat == NULL) {
+                fprintf(stderr, "Hata: Kategori için bellek ayrılamadı: %s\n", entry->name);
+            }
+        } else if (current_cat != NULL) {
+            if (add_user_focus(current_cat, entry->name, color_pair_id, entry->id) == NULL) {
+                fprintf(stderr, "Hata: Odak için bellek ayrılamadı: %s\n", entry->name);
+            }
+        }
+    }
+    return missing_entity_ids;
+}
+
+// Anlık görüntüyü geçici dosyaya yazıp rename() ile yerine koyar; dosyayı okuyan örnekler
+// hiçbir zaman yarım yazılmış bir liste görmez. Yazılan dosyanın kimliği anlık görüntüye geçer.
+// Return: true (yazıldı), false
+static bool write_category_snapshot(CategorySnapshot *snapshot) {
+    char temp_path[320];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", categories_file_path);
+    FILE *file = fopen(temp_path, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "%s%u\n", CATEGORIES_NEXT_ID_PREFIX, snapshot->next_id);
+    for (int i = 0; i < snapshot->count; i++) {
+        const CategoryEntry *entry = &snapshot->entries[i];
+        fprintf(file, "%s%s;%d;%u\n", (entry->parent == -1) ? "#" : "", entry->name, entry->color_pair_id, entry->id);
+    }
+    struct stat st;
+    bool ok = (fflush(file) == 0 && fstat(fileno(file), &st) == 0);
+    ok = (fclose(file) == 0) && ok;
+    if (ok && rename(temp_path, categories_file_path) == 0) {
+        category_snapshot_set_identity(snapshot, &st);
+        return true;
+    }
+    unlink(temp_path);
+    return false;
+}
+
+// Return: paylaşılan ID sayacı (kilit dosyası yok veya boşsa 0); yalnızca kategori kilidi altında
+static uint32_t read_shared_entity_id(int lock_fd) {
+    uint32_t next_id = 0;
+    if (lock_fd == -1 || pread(lock_fd, &next_id, sizeof(next_id), 0) != (ssize_t)sizeof(next_id)) {
+        return 0;
+    }
+    return next_id;
+}
+
+// Paylaşılan sayacı en az next_id'ye ilerletir (hiç geri almaz); yalnızca kategori kilidi altında
+static void write_shared_entity_id(int lock_fd, uint32_t next_id) {
+    if (lock_fd == -1 || read_shared_entity_id(lock_fd) >= next_id) {
+        return;
+    }
+    if (pwrite(lock_fd, &next_id, sizeof(next_id), 0) != (ssize_t)sizeof(next_id)) {
+        /* Kategori dosyasındaki !NextId satırı yine yerel sayacı ileri taşır */
+    }
+}
+
+// Bellekteki modelde bir kalıcı ID'yi değiştirir (konumlar ve işaretçiler geçerli kalır)
+static void remap_user_entity_id(uint32_t old_id, uint32_t new_id) {
+    for (int i = 0; i < num_user_categories; i++) {
+        if (user_categories[i].id == old_id) user_categories[i].id = new_id;
+        for (int j = 0; j < user_categories[i].num_focuses; j++) {
+            if (user_categories[i].focuses[j].id == old_id) user_categories[i].focuses[j].id = new_id;
+        }
+    }
+}
+
+// İki tarafın ayrı ayrı eklediği girdiler aynı mı (aynı tür, ad ve kategori)
+static bool category_entries_match(const CategorySnapshot *a, int i, const CategorySnapshot *b, int j) {
+    const CategoryEntry *x = &a->entries[i];
+    const CategoryEntry *y = &b->entries[j];
+    if ((x->parent == -1) != (y->parent == -1) || strcmp(x->name, y->name) != 0) return false;
+    return x->parent == -1 || a->entries[x->parent].id == b->entries[y->parent].id;
+}
+
+// Diskte kategoriye eklenmiş (tabanda olmayan ve henüz kullanılmamış) odakları birleştirilmiş
+// kategorinin sonuna ekler. Diskteki odaklar kategorilerinin hemen ardından gelir.
+static bool append_theirs_focuses(CategorySnapshot *base, const CategorySnapshot *theirs, bool *theirs_used, int theirs_category, CategorySnapshot *merged, int merged_category) {
+    if (theirs_category == -1 || merged_category == -1) return true;
+    for (int t = theirs_category + 1; t < theirs->count && theirs->entries[t].parent == theirs_category; t++) {
+        const CategoryEntry *entry = &theirs->entries[t];
+        if (theirs_used[t] || category_snapshot_find(base, entry->id) != -1) continue; // Bizde silinmiş
+        theirs_used[t] = true;
+        uint32_t id = (entry->id != 0) ? entry->id : merged->next_id++;
+        if (!category_snapshot_add(merged, entry->name, entry->color_pair_id, id, merged_category)) return false;
+    }
+    return true;
+}
+
+// Taban, bizim ve diskteki sürümü kalıcı ID'lerle birleştirir:
+//  - Ad ve renk alan alan birleşir: tabana göre bizde değişen alan bizden, değilse diskten alınır.
+//  - İki taraftan birinde silinen girdi silinir; kategorisi silinen odaklar da düşer.
+//  - Diskte eklenenler korunur: odaklar kategorilerinin sonuna, kategoriler listenin sonuna.
+//  - İki taraf aynı ID'yi bağımsız olarak farklı girdilere verdiyse bizimkine yeni ID verilir
+//    (bellekteki model de güncellenir). ID'ler paylaşılan sayaçtan verildiği için bu yalnızca
+//    sayacı bilmeyen eski sürümlerin yazdığı dosyalarda olur.
+// Sıra bizim sıramızdır; böylece modeldeki konumlar mümkün olduğunca korunur.
+// Return: true, false (bellek yetersiz)
+bool merge_category_snapshots(CategorySnapshot *base, CategorySnapshot *ours, CategorySnapshot *theirs, CategorySnapshot *merged) {
+    category_snapshot_free(merged);
+    merged->next_id = (ours->next_id > theirs->next_id) ? ours->next_id : theirs->next_id;
+    for (int i = 0; i < ours->count; i++) {
+        if (ours->entries[i].id >= merged->next_id) merged->next_id = ours->entries[i].id + 1;
+    }
+    for (int t = 0; t < theirs->count; t++) {
+        if (theirs->entries[t].id >= merged->next_id) merged->next_id = theirs->entries[t].id + 1;
+    }
+    bool *theirs_used = calloc((size_t)theirs->count + 1, sizeof(bool));
+    if (theirs_used == NULL) return false;
+
+    bool ok = true;
+    int theirs_category = -1; // Açık kategorinin diskteki konumu (-1: diskte yok)
+    int merged_category = -1; // Açık kategorinin birleştirilmiş konumu (-1: kategori düştü)
+    for (int i = 0; ok && i < ours->count; i++) {
+        CategoryEntry *entry = &ours->entries[i];
+        bool is_category = (entry->parent == -1);
+        if (is_category) {
+            ok = append_theirs_focuses(base, theirs, theirs_used, theirs_category, merged, merged_category);
+            theirs_category = -1;
+            merged_category = -1;
+        } else if (merged_category == -1) {
+            continue; // Kategorisi düştü
+        }
+
+        int b = category_snapshot_find(base, entry->id);
+        int t = category_snapshot_find(theirs, entry->id);
+        if (t != -1 && b == -1 && !category_entries_match(ours, i, theirs, t)) {
+            // İki örnek aynı sayaç değerinden farklı girdilere ID vermiş
+            uint32_t new_id = merged->next_id++;
+            remap_user_entity_id(entry->id, new_id);
+            entry->id = new_id; // Odakların kategori eşleşmesi de yeni ID'yi görür
+            t = -1;
+        }
+        if (t == -1 && b != -1) continue; // Diğer örnek silmiş
+
+        const char *name = entry->name;
+        int color_pair_id = entry->color_pair_id;
+        if (t != -1) {
+            theirs_used[t] = true;
+            if (b != -1 && strcmp(entry->name, base->entries[b].name) == 0) name = theirs->entries[t].name;
+            if (b != -1 && entry->color_pair_id == base->entries[b].color_pair_id) color_pair_id = theirs->entries[t].color_pair_id;
+        }
+        ok = category_snapshot_add(merged, name, color_pair_id, entry->id, is_category ? -1 : merged_category);
+        if (is_category) {
+            merged_category = merged->count - 1;
+            theirs_category = t;
+        }
+    }
+    ok = ok && append_theirs_focuses(base, theirs, theirs_used, theirs_category, merged, merged_category);
+
+    // Diskte eklenen kategoriler odaklarıyla birlikte sona
+    for (int t = 0; ok && t < theirs->count; t++) {
+        const CategoryEntry *entry = &theirs->entries[t];
+        if (entry->parent != -1 || theirs_used[t] || category_snapshot_find(base, entry->id) != -1) continue;
+        theirs_used[t] = true;
+        uint32_t id = (entry->id != 0) ? entry->id : merged->next_id++;
+        ok = category_snapshot_add(merged, entry->name, entry->color_pair_id, id, -1) &&
+             append_theirs_focuses(base, theirs, theirs_used, t, merged, merged->count - 1);
+    }
+    free(theirs_used);
+    return ok;
+}
+
+void load_data() {
+    CategorySnapshot snapshot = { 0 };
+    if (!read_category_snapshot(categories_file_path, &snapshot)) {
+        fprintf(stderr, "Hata: Kategori dosyası için bellek ayrılamadı: %s\n", categories_file_path);
+    }
+    bool missing_entity_ids = build_user_categories(&snapshot);
+    category_snapshot_free(&category_base);
+    category_base = snapshot; // Sonraki kayıtlar bu hale göre birleştirilir
+
+    if (missing_entity_ids) {
+        // ID'siz girdilere kalıcı ID ver ve hemen kaydet
+        for (int i = 0; i < num_user_categories; i++) {
+            if (user_categories[i].id == 0) user_categories[i].id = allocate_entity_id();
+            for (int j = 0; j < user_categories[i].num_focuses; j++) {
+                if (user_categories[i].focuses[j].id == 0) user_categories[i].focuses[j].id = allocate_entity_id();
+            }
+        }
+        save_data();
+    }
+    rebuild_entity_index();
+}
+
+// Modeli kategori dosyasına yazar. Dosya son okumadan beri başka bir örnekçe değiştirildiyse
+// önce onun düzenlemeleriyle birleştirilir. Çağıranlar kayıttan sonra konumlara (ör. yeni
+// eklenen girdinin indeksine) güvendiğinden bellekteki model burada yeniden kurulmaz;
+// birleştirilmiş hal bir sonraki güvenli noktada sync_category_model() ile uygulanır.
+void save_data() {
+    // Okuma, birleştirme ve yazma tek kilit altında: aynı anda kaydeden iki örnekten biri
+    // diğerinin yazdığını görür
+    int lock_fd = lock_data_file(categories_lock_path, LOCK_EX);
+    CategorySnapshot ours = { 0 };
+    CategorySnapshot theirs = { 0 };
+    CategorySnapshot merged = { 0 };
+    CategorySnapshot *output = &ours;
+
+    uint32_t shared_next_id = read_shared_entity_id(lock_fd);
+    if (shared_next_id > next_entity_id) next_entity_id = shared_next_id; // Birleştirmede verilen ID'ler de çakışmasın
+    bool ok = snapshot_user_categories(&ours);
+    if (ok && !category_file_matches(&category_base) && read_category_snapshot(categories_file_path, &theirs) &&
+        !category_snapshots_equal(&theirs, &category_base) &&
+        merge_category_snapshots(&category_base, &ours, &theirs, &merged)) {
+        output = &merged;
+    }
+
+    if (!ok || !write_category_snapshot(output)) {
+        fprintf(stderr, "Hata: Kategori ve odak dosyasına yazılamadı: %s\n", categories_file_path);
+    } else {
+        // Taban her zaman modelin yazıldığı andaki halidir. Birleştirildiyse dosya kimliği
+        // bırakılır: bir sonraki eşitleme dosyayı okur ve modelde eksik olan, diskte eklenmiş
+        // girdileri silinmiş değil eklenmiş sayar.
+        if (output == &merged) {
+            ours.has_file = false;
+            if (merged.next_id > next_entity_id) next_entity_id = merged.next_id; // Diskteki ID'ler yeniden verilmez
+            category_model_stale = true;
+        }
+        category_snapshot_free(&category_base);
+        category_base = ours;
+        memset(&ours, 0, sizeof(ours));
+    }
+    write_shared_entity_id(lock_fd, next_entity_id);
+    category_snapshot_free(&ours);
+    category_snapshot_free(&theirs);
+    category_snapshot_free(&merged);
+    unlock_data_file(lock_fd);
+    rebuild_entity_index(); // Ekleme/silme/yeniden adlandırma sonrası konumlar değişmiş olabilir
+}
+
+// Başka örneklerin kategori dosyasındaki değişikliklerini bellekteki modelle birleştirir.
+// Model yeniden kurulduğundan yalnızca hiçbir ekranın Category/Focus işaretçisi veya adı
+// tutmadığı noktalarda çağrılır (bkz. category_model_pins). Dosya değişmediyse yalnızca stat().
+// Return: true (model yeniden kuruldu; işaretçiler ve konumlar geçersiz)
+bool sync_category_model() {
+    category_model_stale = false;
+    if (category_file_matches(&category_base)) {
+        return false;
+    }
+
+    int lock_fd = lock_data_file(categories_lock_path, LOCK_EX);
+    CategorySnapshot theirs = { 0 };
+    CategorySnapshot ours = { 0 };
+    CategorySnapshot merged = { 0 };
+    bool rebuilt = false;
+    uint32_t shared_next_id = read_shared_entity_id(lock_fd);
+    if (shared_next_id > next_entity_id) next_entity_id = shared_next_id;
+    if (read_category_snapshot(categories_file_path, &theirs)) {
+        CategorySnapshot *new_base = &theirs;
+        if (!category_snapshots_equal(&theirs, &category_base) && snapshot_user_categories(&ours) &&
+            merge_category_snapshots(&category_base, &ours, &theirs, &merged)) {
+            build_user_categories(&merged);
+            ensure_all_color_pairs_initialized();
+            rebuild_entity_index();
+            rebuilt = true;
+            // Kaydedilmemiş kendi değişikliklerimiz de varsa birleştirilmiş hal hemen yazılır
+            if (!category_snapshots_equal(&merged, &theirs) && write_category_snapshot(&merged)) {
+                new_base = &merged;
+            }
+        }
+        category_snapshot_free(&category_base);
+        category_base = *new_base;
+        memset(new_base, 0, sizeof(*new_base));
+    }
+    write_shared_entity_id(lock_fd, next_entity_id);
+    category_snapshot_free(&theirs);
+    category_snapshot_free(&ours);
+    category_snapshot_free(&merged);
+    unlock_data_file(lock_fd);
+    return rebuilt;
+}
+
+// settings.conf: "anahtar=değer" satırları; bilinmeyen anahtarlar yok sayılır
+void load_settings() {
+    FILE *file = fopen(settings_file_path, "r");
+    if (file == NULL) {
+        return; // Varsayılanlar geçerli
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = 0;
+        char *value = strchr(line, '=');
+        if (line[0] == '#' || value == NULL) continue;
+        *value++ = '\0';
+        if (strcmp(line, SETTINGS_SUSPEND_POLICY_KEY) == 0) {
+            suspend_policy = (strcmp(value, "count") == 0) ? SUSPEND_POLICY_COUNT : SUSPEND_POLICY_EXCLUDE;
+        }
+    }
+    fclose(file);
+}
+
+void save_settings() {
+    FILE *file = fopen(settings_file_path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Hata: Ayar dosyasına yazılamadı: %s\n", settings_file_path);
+        return;
+    }
+    fprintf(file, "%s=%s\n", SETTINGS_SUSPEND_POLICY_KEY, (suspend_policy == SUSPEND_POLICY_COUNT) ? "count" : "exclude");
+    fclose(file);
+}
+
+// --- Arena ve Kategori Modeli ---
+
+// Arenadan hizalı bir alan ayırır; geçerli blok yetmezse yeni bir blok eklenir.
+// Return: alan (sıfırlanmamış) veya bellek yetersizse NULL
+void *arena_alloc(Arena *arena, size_t size, size_t align) {
+    ArenaBlock *block = arena->blocks;
+    if (block != NULL) {
+        size_t offset = (block->used + align - 1) & ~(align - 1);
+        if (offset + size <= block->size) {
+            block->used = offset + size;
+            return block->data + offset;
+        }
+    }
+    size_t block_size = ARENA_BLOCK_BYTES;
+    if (block_size < size + align) block_size = size + align;
+    block = malloc(sizeof(ArenaBlock) + block_size);
+    if (block == NULL) return NULL;
+    block->next = arena->blocks;
+    block->size = block_size;
+    arena->blocks = block;
+    size_t offset = (size_t)(-(uintptr_t)block->data) & (align - 1);
+    block->used = offset + size;
+    return block->data + offset;
+}
+
+// Adı dize havuzuna kopyalar; havuzdaki adlar bitişik bloklarda sıkıca paketlenir
+char *arena_strndup(Arena *pool, const char *str, size_t len) {
+    char *copy = arena_alloc(pool, len + 1, 1);
+    if (copy == NULL) return NULL;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+// Dizide count elemandan sonra yer kalmadıysa kapasiteyi ikiye katlayıp elemanları
+// arenadaki yeni alana taşır. Eski alan arena bırakılana kadar kullanılmadan kalır.
+// Return: (gerekirse yeni) dizi veya bellek yetersizse NULL
+void *arena_grow_array(Arena *arena, void *items, size_t item_size, int count, int *capacity) {
+    if (count < *capacity) return items;
+    int new_capacity = (*capacity < MODEL_MIN_CAPACITY) ? MODEL_MIN_CAPACITY : *capacity * 2;
+    void *grown = arena_alloc(arena, (size_t)new_capacity * item_size, sizeof(void *) * 2);
+    if (grown == NULL) return NULL;
+    if (count > 0) memcpy(grown, items, (size_t)count * item_size);
+    *capacity = new_capacity;
+    return grown;
+}
+
+void arena_free(Arena *arena) {
+    ArenaBlock *block = arena->blocks;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
+
+// Kategori listesinin sonuna yeni bir kategori ekler (ad en fazla MAX_CATEGORY_NAME_LEN - 1 bayt).
+// Dizi büyüyebileceğinden önceden alınan Category işaretçileri geçersiz olur.
+Category *add_user_category(const char *name, int color_pair_id, uint32_t id) {
+    Category *grown = arena_grow_array(&category_arena, user_categories, sizeof(Category), num_user_categories, &user_category_capacity);
+    if (grown == NULL) return NULL;
+    user_categories = grown;
+
+    char *name_copy = arena_strndup(&category_strings, name, utf8_prefix_len(name, MAX_CATEGORY_NAME_LEN - 1));
+    if (name_copy == NULL) return NULL;
+
+    Category *cat = &user_categories[num_user_categories++];
+    memset(cat, 0, sizeof(*cat));
+    cat->name = name_copy;
+    cat->name_width = text_width(name_copy);
+    cat->color_pair_id = color_pair_id;
+    cat->id = id;
+    return cat;
+}
+
+// Kategorinin odak listesinin sonuna yeni bir odak ekler (ad en fazla MAX_FOCUS_NAME_LEN - 1 bayt)
+Focus *add_user_focus(Category *cat, const char *name, int color_pair_id, uint32_t id) {
+    Focus *grown = arena_grow_array(&category_arena, cat->focuses, sizeof(Focus), cat->num_focuses, &cat->focus_capacity);
+    if (grown == NULL) return NULL;
+    cat->focuses = grown;
+
+    char *name_copy = arena_strndup(&category_strings, name, utf8_prefix_len(name, MAX_FOCUS_NAME_LEN - 1));
+    if (name_copy == NULL) return NULL;
+
+    Focus *focus = &cat->focuses[cat->num_focuses++];
+    focus->name = name_copy;
+    focus->name_width = text_width(name_copy);
+    focus->color_pair_id = color_pair_id;
+    focus->id = id;
+    return focus;
+}
+
+// Kategori modelini boşaltır; tüm diziler ve adlar arenalarla birlikte bırakılır
+void reset_user_categories() {
+    arena_free(&category_arena);
+    arena_free(&category_strings);
+    user_categories = NULL;
+    num_user_categories = 0;
+    user_category_capacity = 0;
+}
+
+// --- Kalıcı ID'ler ---
+
+// Sıradaki ID tüm örneklerin paylaştığı sayaçtan (kategori kilit dosyasının başı) kilit altında
+// alınır ve sayaç hemen ilerletilir. Böylece kaydetmeden önce bile iki örnek aynı ID'yi farklı
+// girdilere veremez; loglanmış oturumlar ve silme işaretleri hep doğru girdiye ait kalır.
+uint32_t allocate_entity_id() {
+    int lock_fd = lock_data_file(categories_lock_path, LOCK_EX);
+    uint32_t shared_next_id = read_shared_entity_id(lock_fd);
+    if (shared_next_id > next_entity_id) next_entity_id = shared_next_id;
+    uint32_t id = next_entity_id++;
+    write_shared_entity_id(lock_fd, next_entity_id);
+    unlock_data_file(lock_fd);
+    return id;
+}
+
+static unsigned long hash_entity_id(uint32_t id) {
+    return (unsigned long)id * 2654435761UL;
+}
+
+// Kalıcı ID -> (kategori, odak) konum indeksini user_categories'ten yeniden kurar
+void rebuild_entity_index() {
+    entity_generation++; // Önbelleğe alınmış ad/renk çözümlemeleri geçersiz
+    // Yuva sayısı girdi sayısının en az iki katı tutulur (doluluk %50'nin altında)
+    int needed = 0;
+    for (int i = 0; i < num_user_categories; i++) needed += 1 + user_categories[i].num_focuses;
+    int size = ENTITY_INDEX_MIN_SIZE;
+    while (size < needed * 2) size *= 2;
+    if (size != entity_index_size) {
+        EntitySlot *resized = realloc(entity_index, (size_t)size * sizeof(EntitySlot));
+        if (resized == NULL) {
+            free(entity_index);
+            entity_index = NULL;
+            entity_index_size = 0;
+            return;
+        }
+        entity_index = resized;
+        entity_index_size = size;
+    }
+    memset(entity_index, 0, (size_t)entity_index_size * sizeof(EntitySlot));
+    unsigned long mask = (unsigned long)entity_index_size - 1;
+    for (int i = 0; i < num_user_categories; i++) {
+        for (int j = -1; j < user_categories[i].num_focuses; j++) {
+            uint32_t id = (j == -1) ? user_categories[i].id : user_categories[i].focuses[j].id;
+            if (id == 0) continue;
+            unsigned long slot = hash_entity_id(id) & mask;
+            while (entity_index[slot].id != 0) slot = (slot + 1) & mask;
+            entity_index[slot].id = id;
+            entity_index[slot].category_index = i;
+            entity_index[slot].focus_index = j;
+        }
+    }
+}
+
+// Return: true (bulundu; kategori ID'lerinde *focus_index -1), false (ID bilinmiyor)
+bool lookup_entity(uint32_t id, int *category_index, int *focus_index) {
+    if (id == 0 || entity_index_size == 0) return false;
+    unsigned long mask = (unsigned long)entity_index_size - 1;
+    for (unsigned long slot = hash_entity_id(id) & mask; entity_index[slot].id != 0; slot = (slot + 1) & mask) {
+        if (entity_index[slot].id == id) {
+            *category_index = entity_index[slot].category_index;
+            *focus_index = entity_index[slot].focus_index;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ID'siz eski bir kayda, kategori dosyasındaki adlardan kalıcı ID'leri atar.
+// Adı bilinmeyen kayıtlar ID'siz kalır ve adla eşlenmeye devam eder.
+void resolve_record_entity_ids(LogRecord *record) {
+    for (int i = 0; i < num_user_categories; i++) {
+        if (!log_field_equals(&record->category, user_categories[i].name)) continue;
+        if (record->type == LOG_RECORD_DELETE_CATEGORY) {
+            record->category_id = user_categories[i].id;
+            return;
+        }
+        for (int j = 0; j < user_categories[i].num_focuses; j++) {
+            if (log_field_equals(&record->focus, user_categories[i].focuses[j].name)) {
+                record->category_id = user_categories[i].id;
+                record->focus_id = user_categories[i].focuses[j].id;
+                return;
+            }
+        }
+        return;
+    }
+}
+
+// Return: true (kaydedildi), false (log açılamadı veya kayıt yazılamadı)
+bool record_work_session(const Category *category, const Focus *focus, time_t start_time, time_t end_time, long duration) {
+    LogWriter writer;
+    bool opened = log_writer_open(&writer, active_log_path(), active_log_format, "a", &writer_binary_state, false);
+    if (!opened && errno == ESTALE) {
+        // Başka bir örnek logu dönüştürdü: yeni biçimle yeniden dene
+        detect_active_log_format();
+        invalidate_statistics();
+        opened = log_writer_open(&writer, active_log_path(), active_log_format, "a", &writer_binary_state, false);
+    }
+    if (!opened) {
+        fprintf(stderr, "Hata: Çalışma kayıt dosyasına yazılamadı: %s\n", active_log_path());
+        return false;
+    }
+    if (active_log_format == LOG_FORMAT_BINARY) {
+        // Fark kodlaması ve sözlük için okuma durumunu, özel kilit altında dosyanın sonuna getir
+        sync_binary_log_state();
+    }
+
+    LogRecord record;
+    record.type = LOG_RECORD_SESSION;
+    record.category = (LogField){ category->name, strlen(category->name) };
+    record.focus = (LogField){ focus->name, strlen(focus->name) };
+    record.category_id = category->id;
+    record.focus_id = focus->id;
+    record.start_time = start_time;
+    record.end_time = end_time;
+    struct tm local_tm;
+    localtime_r(&start_time, &local_tm);
+    record.utc_offset = local_tm.tm_gmtoff;
+    record.duration = duration;
+    bool ok = log_writer_append(&writer, &record);
+    log_writer_close(&writer);
+    if (!ok) {
+        fprintf(stderr, "Hata: Çalışma kaydı yazılamadı: %s\n", active_log_path());
+    }
+    return ok;
+}
+
+int get_random_color_pair() {
+    if (next_available_color_pair_id > MAX_CUSTOM_COLOR_PAIR) {
+        return COLOR_PAIR_DEFAULT;
+    }
+    if (!has_colors()) {
+        return COLOR_PAIR_DEFAULT;
+    }
+
+    int fg_color;
+    // COLOR_BLACK (0) ve COLOR_WHITE (7) dışında rastgele bir renk seç
+    // Daha belirgin renkler için 1-6 arasındaki renkleri tercih et
+    do {
+        fg_color = (rand() % 6) + 1; // 1-6 arası (Kırmızı, Yeşil, Sarı, Mavi, Magenta, Cyan)
+    } while (fg_color == COLOR_BLACK || fg_color == COLOR_WHITE);
+
+    // Yeni renk çiftini başlat ve başlatıldığını işaretle.
+    // Arka planı siyah tutarak, ACS_BLOCK ile ön plan rengini kullanarak görünürlük sağlayacağız.
+    init_pair(next_available_color_pair_id, fg_color, COLOR_BLACK);
+    g_initialized_color_pairs[next_available_color_pair_id] = true;
+
+    return next_available_color_pair_id++;
+}
+
+// Tüm yüklü renk çiftlerinin başlatıldığından emin olmak için fonksiyon
+void ensure_all_color_pairs_initialized() {
+    if (!has_colors()) return;
+
+    // Başlatma dizisini sıfırla
+    for (int i = 0; i < MAX_COLOR_PAIRS; i++) {
+        g_initialized_color_pairs[i] = false;
+    }
+
+    // Varsayılan renk çiftlerini işaretle (main'de zaten başlatıldılar)
+    g_initialized_color_pairs[COLOR_PAIR_DEFAULT] = true;
+    g_initialized_color_pairs[COLOR_PAIR_HIGHLIGHT] = true;
+    g_initialized_color_pairs[COLOR_PAIR_TITLE] = true;
+    g_initialized_color_pairs[COLOR_PAIR_RED] = true;
+
+    for (int i = 0; i < num_user_categories; i++) {
+        int cat_id = user_categories[i].color_pair_id;
+        if (cat_id >= MIN_CUSTOM_COLOR_PAIR && cat_id < MAX_COLOR_PAIRS && !g_initialized_color_pairs[cat_id]) {
+            int fg_color = ((cat_id - MIN_CUSTOM_COLOR_PAIR) % 6) + 1; // Deterministic color based on ID
+            if (fg_color < 1 || fg_color > 6) fg_color = COLOR_WHITE; // Fallback for safety
+            init_pair(cat_id, fg_color, COLOR_BLACK);
+            g_initialized_color_pairs[cat_id] = true;
+        }
+
+        for (int j = 0; j < user_categories[i].num_focuses; j++) {
+            int focus_id = user_categories[i].focuses[j].color_pair_id;
+            if (focus_id >= MIN_CUSTOM_COLOR_PAIR && focus_id < MAX_COLOR_PAIRS && !g_initialized_color_pairs[focus_id]) {
+                int fg_color = ((focus_id - MIN_CUSTOM_COLOR_PAIR) % 6) + 1; // Deterministic color based on ID
+                if (fg_color < 1 || fg_color > 6) fg_color = COLOR_WHITE; // Fallback for safety
+                init_pair(focus_id, fg_color, COLOR_BLACK);
+                g_initialized_color_pairs[focus_id] = true;
+            }
+        }
+    }
+}
+
+
+// Tek bir log kaydını istatistik tablosuna işler
+void ingest_log_record(StatTable *table, const LogRecord *record) {
+    long duration_s = record->duration;
+
+    if (record->type != LOG_RECORD_SESSION) {
+        apply_stat_tombstone(table, record);
+        table->dead_bytes += record->byte_length; // İşaretin kendisi de sıkıştırmada atılır
+        return;
+    }
+
+    if (record->start_time < table->since_time) {
+        return; // Sorgulanan aralıktan önce başlamış oturum
+    }
+
+    // İstatistiklere ekle (alan başına tek hash araması)
+    int cat_idx = intern_stat_category(table, record->category_id, record->category.ptr, record->category.len);
+    if (cat_idx == -1) {
+        return; // Bellek yetersiz
+    }
+
+    int focus_idx = intern_stat_focus(table, cat_idx, record->focus_id, record->focus.ptr, record->focus.len);
+    if (focus_idx == -1) {
+        return; // Bellek yetersiz
+    }
+    table->categories[cat_idx].focuses[focus_idx].total_duration += duration_s;
+    table->categories[cat_idx].focuses[focus_idx].session_count++;
+    table->categories[cat_idx].focuses[focus_idx].log_bytes += record->byte_length;
+}
+
+// FOCUSLOG_THREADS ortam değişkeni ile log ayrıştırmada kullanılacak iş parçacığı
+// sayısı seçilir (1 = seri). Tanımsız veya 0 ise çevrimiçi çekirdek sayısı kullanılır.
+int get_ingest_thread_count() {
+    const char *env = getenv("FOCUSLOG_THREADS");
+    long threads = (env != NULL) ? atol(env) : 0;
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_INGEST_THREADS) threads = MAX_INGEST_THREADS;
+    return (int)threads;
+}
+
+// Paralel yüklemede bir parçada görülen silme işaretinin kopyası
+typedef struct {
+    LogRecordType type;
+    char category[MAX_CATEGORY_NAME_LEN];
+    char focus[MAX_FOCUS_NAME_LEN];
+    uint32_t category_id;
+    uint32_t focus_id;
+} ChunkTombstone;
+
+// Paralel yüklemede bir iş parçacığının işlediği log parçası
+typedef struct {
+    off_t start;
+    off_t end;
+    off_t scanned_end;  // Son tam satırın bittiği konum
+    StatTable table;    // İş parçacığına özel toplamlar
+    ChunkTombstone *tombstones; // Önceki parçalara birleştirmede uygulanacak silme işaretleri
+    int num_tombstones;
+    int fd;             // Koordinatörün doğruladığı log (iş parçacığı kendi dup() kopyasını tarar)
+    StatsBuild *build;  // İlerleme bildirilecek arka plan yapımı (NULL: yok)
+    bool ok;
+} IngestChunk;
+
+// Arka plan yapımının ilerlemesini artırır ve arayüzü uyandırır. eventfd sayacı birikir;
+// arayüz birden çok bildirimi tek okumada boşaltır.
+static void stats_build_advance(StatsBuild *build, off_t bytes) {
+    __atomic_add_fetch(&build->progress_bytes, bytes, __ATOMIC_RELAXED);
+    uint64_t one = 1;
+    if (write(stats_event_fd, &one, sizeof(one)) < 0) { /* sayaç doluysa bildirim zaten bekliyor */ }
+}
+
+static void *ingest_chunk_worker(void *arg) {
+    IngestChunk *chunk = (IngestChunk *)arg;
+    LogReader reader;
+    LogRecord record;
+    chunk->scanned_end = chunk->start;
+    // Yol yeniden açılmaz: log yapım sırasında yeniden adlandırılsa da parçalar aynı dosyayı okur
+    int fd = dup(chunk->fd);
+    if (fd == -1 || !log_reader_open_fd(&reader, fd, LOG_FORMAT_CSV, chunk->start, NULL)) {
+        return NULL;
+    }
+    if (chunk->end < reader.scanner.end) {
+        reader.scanner.end = chunk->end;
+    }
+    reader.parse_times = (chunk->table.since_time != 0); // Eski CSV'de aralık filtresi için
+    bool ok = true;
+    off_t reported = reader.scanner.pos;
+    while (log_reader_next(&reader, &record)) {
+        ingest_log_record(&chunk->table, &record);
+        if (chunk->build != NULL && reader.scanner.pos - reported >= STATS_PROGRESS_STEP_BYTES) {
+            stats_build_advance(chunk->build, reader.scanner.pos - reported);
+            reported = reader.scanner.pos;
+        }
+        if (record.type != LOG_RECORD_SESSION) {
+            ChunkTombstone *tombstones = realloc(chunk->tombstones, (chunk->num_tombstones + 1) * sizeof(ChunkTombstone));
+            if (tombstones == NULL) {
+                ok = false;
+                break;
+            }
+            chunk->tombstones = tombstones;
+            ChunkTombstone *tombstone = &chunk->tombstones[chunk->num_tombstones++];
+            size_t cat_len = record.category.len < MAX_CATEGORY_NAME_LEN ? record.category.len : MAX_CATEGORY_NAME_LEN - 1;
+            size_t focus_len = record.focus.len < MAX_FOCUS_NAME_LEN ? record.focus.len : MAX_FOCUS_NAME_LEN - 1;
+            tombstone->type = record.type;
+            tombstone->category_id = record.category_id;
+            tombstone->focus_id = record.focus_id;
+            memcpy(tombstone->category, record.category.ptr, cat_len);
+            tombstone->category[cat_len] = '\0';
+            memcpy(tombstone->focus, record.focus.ptr, focus_len);
+            tombstone->focus[focus_len] = '\0';
+        }
+    }
+    chunk->scanned_end = reader.scanner.pos;
+    chunk->ok = ok;
+    log_reader_close(&reader);
+    return NULL;
+}
+
+// Verilen konumdan sonraki ilk satır başını bulur
+static off_t find_next_row_start(int fd, off_t pos, off_t end) {
+    char buffer[4096];
+    while (pos < end) {
+        ssize_t read_len = pread(fd, buffer, sizeof(buffer), pos);
+        if (read_len <= 0) break;
+        char *newline = memchr(buffer, '\n', (size_t)read_len);
+        if (newline != NULL) {
+            return pos + (newline - buffer) + 1;
+        }
+        pos += read_len;
+    }
+    return end;
+}
+
+// pos'tan sonraki ilk tam kaydın bitiş zamanını okur
+// Return: true (kayıt okundu), false (limit'e kadar kayıt yok)
+static bool probe_log_end_time(LogReader *reader, off_t pos, off_t limit, off_t *row, time_t *end_time) {
+    LogRecord record;
+    *row = find_next_row_start(reader->scanner.fd, pos, limit);
+    reader->scanner.pos = *row;
+    if (*row >= limit || !log_reader_next(reader, &record)) {
+        return false;
+    }
+    *end_time = record.end_time;
+    return true;
+}
+
+// Kayıtlar oturum bittiğinde eklendiği için CSV logunda bitiş zamanları normalde dosya sırasıyla
+// artar; eşzamanlı örnekler yüzünden en çok STATS_SINCE_SEEK_SLACK_SECONDS kadar sapabilir.
+// İkili arama ile bitişi target'tan önce olan kayıtların oluşturduğu öneki atlar; öneki izleyen
+// aralıktaki eski oturumlar yine ingest_log_record'da elenir. Saat geri alındıysa veya log elle
+// düzenlendiyse sıra bozulur: eşit aralıklı örnekler ya da aramanın okuduğu kayıtlar bu paydan
+// fazla geriye giderse arama bırakılır ve log baştan okunur.
+// Return: taramanın başlayacağı satır başı (arama yapılamazsa okuyucunun geçerli konumu)
+static off_t find_log_offset_since(LogReader *reader, time_t target) {
+    LogScanner *scanner = &reader->scanner;
+    off_t start = scanner->pos;
+    if (reader->format != LOG_FORMAT_CSV || !reader->schema.epoch_times) {
+        return start; // İkili log fark kodludur, eski CSV zamanları metindir: baştan okunur
+    }
+    off_t low = start; // Bu konumdan önce biten tüm kayıtlar target'tan öncedir
+    off_t high = scanner->end;
+    if (high - low <= STATS_SINCE_SEEK_MIN_BYTES) {
+        return start;
+    }
+
+    off_t row;
+    time_t end_time;
+    time_t previous_time = 0;
+    for (int i = 1; i < STATS_SINCE_ORDER_SAMPLES; i++) {
+        if (!probe_log_end_time(reader, start + (high - start) / STATS_SINCE_ORDER_SAMPLES * i, high, &row, &end_time)) {
+            break;
+        }
+        if (end_time + STATS_SINCE_SEEK_SLACK_SECONDS < previous_time) {
+            scanner->pos = start;
+            return start; // Sıra bozuk: ikili aramaya güvenilmez
+        }
+        if (end_time > previous_time) previous_time = end_time;
+    }
+
+    time_t low_time = 0; // low'daki kaydın bitişi
+    time_t high_time = (time_t)LLONG_MAX; // high'daki kaydın bitişi
+    while (high - low > STATS_SINCE_SEEK_MIN_BYTES) {
+        off_t mid = low + (high - low) / 2;
+        if (!probe_log_end_time(reader, mid, high, &row, &end_time)) {
+            high = mid;
+            continue;
+        }
+        if (end_time + STATS_SINCE_SEEK_SLACK_SECONDS < low_time ||
+            (high_time != (time_t)LLONG_MAX && end_time > high_time + STATS_SINCE_SEEK_SLACK_SECONDS)) {
+            scanner->pos = start;
+            return start;
+        }
+        if (end_time < target) {
+            low = row;
+            low_time = end_time;
+        } else {
+            high = row;
+            high_time = end_time;
+        }
+    }
+    scanner->pos = low;
+    return low;
+}
+
+// part'ın toplamlarını ve ölü baytlarını table'a ekler; yeni adlar part'taki sırayla eklenir
+static void merge_stat_aggregates(StatTable *table, const StatTable *part) {
+    table->dead_bytes += part->dead_bytes;
+    table->corrupt_bytes += part->corrupt_bytes;
+    for (int c = 0; c < part->num_categories; c++) {
+        const StatCategory *part_cat = &part->categories[c];
+        int cat_idx = intern_stat_category(table, part_cat->id, part_cat->name, strlen(part_cat->name));
+        if (cat_idx == -1) continue;
+        for (int f = 0; f < part_cat->num_focuses; f++) {
+            const StatFocus *part_focus = &part_cat->focuses[f];
+            int focus_idx = intern_stat_focus(table, cat_idx, part_focus->id, part_focus->name, strlen(part_focus->name));
+            if (focus_idx == -1) continue;
+            StatFocus *merged = &table->categories[cat_idx].focuses[focus_idx];
+            merged->total_duration += part_focus->total_duration;
+            merged->session_count += part_focus->session_count;
+            merged->log_bytes += part_focus->log_bytes;
+        }
+    }
+}
+
+// [data_start, file_end) aralığını satır sınırlarında parçalara bölüp her birini
+// ayrı bir iş parçacığında ayrıştırır, ardından özel tabloları parça sırasıyla table'a
+// birleştirir. Birleştirme sırası ilk görülme sırasını koruduğu için sonuç
+// seri yükleme ile aynıdır. Bir parçadaki silme işaretleri, o parçanın toplamları
+// eklenmeden önce önceki parçalardan birleştirilmiş toplamlara uygulanır.
+// Return: Son tam satırın bittiği konum, -1 (iş parçacığı başlatılamadı)
+static off_t ingest_log_parallel(StatTable *table, int fd, off_t data_start, off_t file_end, int num_threads, StatsBuild *build) {
+    IngestChunk chunks[MAX_INGEST_THREADS];
+    pthread_t threads[MAX_INGEST_THREADS];
+    bool started[MAX_INGEST_THREADS] = { false };
+    int started_count = 0;
+    off_t result = -1;
+
+    memset(chunks, 0, sizeof(chunks));
+    off_t chunk_size = (file_end - data_start) / num_threads;
+    off_t chunk_start = data_start;
+    for (int i = 0; i < num_threads; i++) {
+        off_t chunk_end = (i == num_threads - 1) ? file_end : find_next_row_start(fd, data_start + chunk_size * (i + 1), file_end);
+        if (chunk_end < chunk_start) chunk_end = chunk_start;
+        chunks[i].start = chunk_start;
+        chunks[i].end = chunk_end;
+        chunks[i].fd = fd;
+        chunks[i].table.since_time = table->since_time;
+        chunks[i].build = build;
+        chunk_start = chunk_end;
+
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&threads[i], NULL, ingest_chunk_worker, &chunks[i]) != 0) {
+            goto cleanup;
+        }
+        started[i] = true;
+        started_count++;
+    }
+
+cleanup:
+    for (int i = 0; i < num_threads; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+
+    if (started_count == num_threads) {
+        result = data_start;
+        for (int i = 0; i < num_threads; i++) {
+            if (!chunks[i].ok) {
+                result = -1;
+                break;
+            }
+        }
+    }
+
+    if (result != -1) {
+        // Parça sırasıyla birleştir
+        for (int i = 0; i < num_threads; i++) {
+            StatTable *part = &chunks[i].table;
+            for (int t = 0; t < chunks[i].num_tombstones; t++) {
+                ChunkTombstone *tombstone = &chunks[i].tombstones[t];
+                LogRecord record = { 0 };
+                record.type = tombstone->type;
+                record.category = (LogField){ tombstone->category, strlen(tombstone->category) };
+                record.focus = (LogField){ tombstone->focus, strlen(tombstone->focus) };
+                record.category_id = tombstone->category_id;
+                record.focus_id = tombstone->focus_id;
+                apply_stat_tombstone(table, &record);
+            }
+            merge_stat_aggregates(table, part);
+            if (chunks[i].scanned_end > result) {
+                result = chunks[i].scanned_end;
+            }
+        }
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        stat_table_free(&chunks[i].table);
+        free(chunks[i].tombstones);
+    }
+    return result;
+}
+
+// Kontrol noktasından önceki son baytların özetini hesaplar (FNV-1a).
+// Dosyanın işlenmiş kısmı sonradan değiştirildiyse bu özet tutmaz.
+static unsigned long hash_log_tail(int fd, off_t end_offset, size_t *out_len) {
+    unsigned char tail[STATS_CHECKPOINT_TAIL_BYTES];
+    off_t tail_start = end_offset - (off_t)sizeof(tail);
+    if (tail_start < 0) tail_start = 0;
+
+    ssize_t read_len = pread(fd, tail, (size_t)(end_offset - tail_start), tail_start);
+    size_t len = read_len > 0 ? (size_t)read_len : 0;
+
+    unsigned long hash = 14695981039346656037UL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= tail[i];
+        hash *= 1099511628211UL;
+    }
+    *out_len = len;
+    return hash;
+}
+
+// İstatistik anlık görüntüsünü geçersiz kılar; bir sonraki yüklemede log baştan okunur.
+// Sürmekte olan yapım eskimiş sayılır ve görüntüsü yayımlanmaz.
+void invalidate_statistics() {
+    stats_checkpoint.valid = false;
+    if (stats_build.running) {
+        stats_build.stale = true;
+    }
+}
+
+// Kontrol noktasını loga göre değerlendirir; logu okumaz (yalnızca fstat ve son baytların özeti)
+static StatsLoadKind plan_statistics_load(const StatCheckpoint *checkpoint, const char *log_path, uint64_t *log_generation, struct stat *st) {
+    *log_generation = read_work_log_generation(); // Log açılmadan önce: yarış olursa bir sonraki yükleme yakalar
+    int fd = open(log_path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return STATS_LOAD_MISSING;
+    }
+    if (fstat(fd, st) != 0) {
+        close(fd);
+        return STATS_LOAD_NONE;
+    }
+
+    bool rebuild = !checkpoint->valid ||
+                   *log_generation != checkpoint->log_generation ||
+                   st->st_dev != checkpoint->dev ||
+                   st->st_ino != checkpoint->ino ||
+                   st->st_size < checkpoint->offset;
+
+    if (!rebuild) {
+        size_t tail_len;
+        unsigned long tail_hash = hash_log_tail(fd, checkpoint->offset, &tail_len);
+        if (tail_len != checkpoint->tail_len || tail_hash != checkpoint->tail_hash) {
+            rebuild = true; // İşlenmiş kısım değişmiş
+        }
+    }
+    close(fd);
+
+    if (rebuild) return STATS_LOAD_REBUILD;
+    return (st->st_size == checkpoint->offset) ? STATS_LOAD_NONE : STATS_LOAD_APPEND; // Yeni kayıt yoksa görüntü güncel
+}
+
+// Bir istatistik görüntüsünü (toplamlar, kontrol noktası, ikili log durumu) loga göre
+// günceller. Yalnızca verilen yapılara yazar; arka plan yapımı kendi görüntüsüyle çağırır
+// ve build ile ilerleme bildirir (arayüzde NULL).
+// Return: true (toplamlar değişti)
+static bool load_statistics_into(StatTable *table, StatCheckpoint *checkpoint, BinaryLogState *binary_state, const char *log_path, LogFormat format, StatsBuild *build) {
+    uint64_t log_generation;
+    struct stat st;
+    StatsLoadKind kind = plan_statistics_load(checkpoint, log_path, &log_generation, &st);
+    if (kind == STATS_LOAD_MISSING) {
+        bool changed = (checkpoint->valid || table->num_categories > 0);
+        reset_stat_aggregates(table);
+        binary_log_state_reset(binary_state);
+        checkpoint->valid = false;
+        return changed;
+    }
+    if (kind == STATS_LOAD_NONE) {
+        return false;
+    }
+
+    bool rebuild = (kind == STATS_LOAD_REBUILD);
+    if (rebuild) {
+        reset_stat_aggregates(table); // İstatistikleri sıfırla
+        binary_log_state_reset(binary_state);
+    }
+
+    LogReader reader;
+    if (!log_reader_open(&reader, log_path, format, rebuild ? 0 : checkpoint->offset, binary_state)) {
+        checkpoint->valid = false;
+        return rebuild;
+    }
+    if (table->since_time != 0) {
+        reader.parse_times = true; // Eski CSV'de aralık filtresi için
+        if (rebuild) {
+            // Yalnızca sorgulanan aralık okunur; log boyutundan bağımsız
+            find_log_offset_since(&reader, table->since_time - STATS_SINCE_SEEK_SLACK_SECONDS);
+        }
+    }
+    if (build != NULL) {
+        __atomic_store_n(&build->total_bytes, reader.scanner.end - reader.scanner.pos, __ATOMIC_RELAXED);
+    }
+
+    bool ingested = false;
+    int num_threads = get_ingest_thread_count();
+    if (rebuild && format == LOG_FORMAT_CSV && num_threads > 1 &&
+        reader.scanner.end - reader.scanner.pos >= PARALLEL_INGEST_MIN_BYTES) {
+        // Büyük log baştan yükleniyor: parçalara bölüp paralel ayrıştır
+        off_t parallel_end = ingest_log_parallel(table, reader.scanner.fd, reader.scanner.pos, reader.scanner.end, num_threads, build);
+        if (parallel_end != -1) {
+            reader.scanner.pos = parallel_end;
+        } else {
+            reset_stat_aggregates(table); // Seri yola geri dön
+            if (build != NULL) __atomic_store_n(&build->progress_bytes, 0, __ATOMIC_RELAXED);
+        }
+    }
+
+    LogRecord record;
+    off_t reported = reader.scanner.pos;
+    while (log_reader_next(&reader, &record)) {
+        ingest_log_record(table, &record);
+        ingested = true;
+        if (build != NULL && reader.scanner.pos - reported >= STATS_PROGRESS_STEP_BYTES) {
+            stats_build_advance(build, reader.scanner.pos - reported);
+            reported = reader.scanner.pos;
+        }
+    }
+    table->corrupt_bytes += reader.skipped_bytes;
+
+    // Yazımı henüz bitmemiş son kayıt bir sonraki yüklemeye bırakılır
+    checkpoint->valid = true;
+    checkpoint->dev = st.st_dev;
+    checkpoint->ino = st.st_ino;
+    checkpoint->log_generation = log_generation;
+    checkpoint->offset = reader.scanner.pos;
+    checkpoint->tail_hash = hash_log_tail(reader.scanner.fd, reader.scanner.pos, &checkpoint->tail_len);
+    log_reader_close(&reader);
+    return rebuild || ingested;
+}
+
+// İstatistik yükleme fonksiyonu
+// Log yalnızca sona ekleme yapılarak büyüdüğü sürece, sadece son yüklemeden beri
+// eklenen satırlar ayrıştırılır. Dosya küçüldüyse, değiştirildiyse veya yerine
+// yenisi konduysa (filtreleme/sıfırlama) istatistikler baştan oluşturulur.
+// Çağıran iş parçacığında tamamlanır (komut satırı, servis ve log yazıcıları).
+void load_statistics() {
+    global_stat_table.since_time = stats_since_time;
+    if (load_statistics_into(&global_stat_table, &stats_checkpoint, &active_binary_state, active_log_path(), active_log_format, NULL)) {
+        stats_generation++;
+    }
+}
+
+// --- Sorgu Önbelleği ---
+// `focuslog stats` her çağrıda logu baştan okumasın diye toplamlar, kontrol noktası ve ikili
+// logun sözlüğü önbellek dosyasına yazılır. Önbellek yalnızca bu makinede ve aynı sürümce
+// okunur (yapılar ham yazılır); bir sonraki çağrı onu yükleyip load_statistics() ile yalnızca
+// sonradan eklenenleri okur. Log yeniden yazıldıysa kontrol noktası bunu yakalar ve log baştan
+// okunur; okunamayan veya bozuk önbellek de yok sayılır.
+
+static bool read_stats_cache_value(FILE *file, void *value, size_t size) {
+    return fread(value, size, 1, file) == 1;
+}
+
+// Return: true (ad buffer'a okundu), false (dosya bozuk)
+static bool read_stats_cache_name(FILE *file, char *buffer, size_t buffer_size, uint32_t *len) {
+    return read_stats_cache_value(file, len, sizeof(*len)) && *len < buffer_size &&
+           fread(buffer, 1, *len, file) == *len;
+}
+
+static void write_stats_cache_name(FILE *file, const char *name, size_t len) {
+    uint32_t stored_len = (uint32_t)len;
+    fwrite(&stored_len, sizeof(stored_len), 1, file);
+    fwrite(name, 1, len, file);
+}
+
+// Önbelleği global tabloya, kontrol noktasına ve ikili log durumuna yükler
+// Return: true (yüklendi), false (önbellek yok, başka bir log için veya bozuk; durum sıfırlanır)
+bool load_stats_cache() {
+    FILE *file = fopen(stats_cache_path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    char magic[sizeof(STATS_CACHE_MAGIC) - 1];
+    char name[MAX_CATEGORY_NAME_LEN > MAX_FOCUS_NAME_LEN ? MAX_CATEGORY_NAME_LEN : MAX_FOCUS_NAME_LEN];
+    StatCheckpoint checkpoint;
+    LogFormat format;
+    int count;
+    uint32_t len;
+    reset_stat_aggregates(&global_stat_table);
+    binary_log_state_reset(&active_binary_state);
+    bool ok = read_stats_cache_value(file, magic, sizeof(magic)) && memcmp(magic, STATS_CACHE_MAGIC, sizeof(magic)) == 0 &&
+              read_stats_cache_value(file, &checkpoint, sizeof(checkpoint)) &&
+              read_stats_cache_value(file, &format, sizeof(format)) && format == active_log_format &&
+              read_stats_cache_value(file, &global_stat_table.dead_bytes, sizeof(global_stat_table.dead_bytes)) &&
+              read_stats_cache_value(file, &global_stat_table.corrupt_bytes, sizeof(global_stat_table.corrupt_bytes)) &&
+              read_stats_cache_value(file, &active_binary_state.last_start, sizeof(active_binary_state.last_start)) &&
+              read_stats_cache_value(file, &active_binary_state.utc_offset, sizeof(active_binary_state.utc_offset)) &&
+              read_stats_cache_value(file, &active_binary_state.entity_ids, sizeof(active_binary_state.entity_ids)) &&
+              read_stats_cache_value(file, &count, sizeof(count));
+    for (int i = 0; ok && i < count; i++) {
+        ok = read_stats_cache_name(file, name, sizeof(name), &len) &&
+             name_dictionary_add(&active_binary_state.dict, name, len) == i;
+    }
+    ok = ok && read_stats_cache_value(file, &count, sizeof(count));
+    for (int c = 0; ok && c < count; c++) {
+        uint32_t category_entity;
+        int num_focuses;
+        ok = read_stats_cache_value(file, &category_entity, sizeof(category_entity)) &&
+             read_stats_cache_name(file, name, sizeof(name), &len) &&
+             read_stats_cache_value(file, &num_focuses, sizeof(num_focuses));
+        int cat_idx = ok ? intern_stat_category(&global_stat_table, category_entity, name, len) : -1;
+        ok = (cat_idx == c);
+        for (int f = 0; ok && f < num_focuses; f++) {
+            uint32_t focus_entity;
+            StatFocus values;
+            ok = read_stats_cache_value(file, &focus_entity, sizeof(focus_entity)) &&
+                 read_stats_cache_name(file, name, sizeof(name), &len) &&
+                 read_stats_cache_value(file, &values.total_duration, sizeof(values.total_duration)) &&
+                 read_stats_cache_value(file, &values.session_count, sizeof(values.session_count)) &&
+                 read_stats_cache_value(file, &values.log_bytes, sizeof(values.log_bytes));
+            int focus_idx = ok ? intern_stat_focus(&global_stat_table, cat_idx, focus_entity, name, len) : -1;
+            ok = (focus_idx == f);
+            if (ok) {
+                StatFocus *stat_focus = &global_stat_table.categories[cat_idx].focuses[focus_idx];
+                stat_focus->total_duration = values.total_duration;
+                stat_focus->session_count = values.session_count;
+                stat_focus->log_bytes = values.log_bytes;
+            }
+        }
+    }
+    fclose(file);
+    if (!ok) {
+        reset_stat_aggregates(&global_stat_table);
+        binary_log_state_reset(&active_binary_state);
+        stats_checkpoint.valid = false;
+        return false;
+    }
+    stats_checkpoint = checkpoint;
+    return true;
+}
+
+// Global tabloyu önbelleğe yazar; geçici dosya rename() ile konur, böylece eşzamanlı
+// sorgular yarım bir önbellek okumaz. Yazılamazsa bir sonraki sorgu logu yine okur.
+void save_stats_cache() {
+    if (!stats_checkpoint.valid || global_stat_table.since_time != 0) {
+        return; // Aralıkla süzülmüş tablo tüm log için kullanılamaz
+    }
+    char temp_path[320];
+    snprintf(temp_path, sizeof(temp_path), "%s.%d.tmp", stats_cache_path, (int)getpid());
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL) {
+        return;
+    }
+    fwrite(STATS_CACHE_MAGIC, 1, sizeof(STATS_CACHE_MAGIC) - 1, file);
+    fwrite(&stats_checkpoint, sizeof(stats_checkpoint), 1, file);
+    fwrite(&active_log_format, sizeof(active_log_format), 1, file);
+    fwrite(&global_stat_table.dead_bytes, sizeof(global_stat_table.dead_bytes), 1, file);
+    fwrite(&global_stat_table.corrupt_bytes, sizeof(global_stat_table.corrupt_bytes), 1, file);
+    fwrite(&active_binary_state.last_start, sizeof(active_binary_state.last_start), 1, file);
+    fwrite(&active_binary_state.utc_offset, sizeof(active_binary_state.utc_offset), 1, file);
+    fwrite(&active_binary_state.entity_ids, sizeof(active_binary_state.entity_ids), 1, file);
+    fwrite(&active_binary_state.dict.count, sizeof(active_binary_state.dict.count), 1, file);
+    for (int i = 0; i < active_binary_state.dict.count; i++) {
+        write_stats_cache_name(file, active_binary_state.dict.names[i], active_binary_state.dict.lengths[i]);
+    }
+    fwrite(&global_stat_table.num_categories, sizeof(global_stat_table.num_categories), 1, file);
+    for (int c = 0; c < global_stat_table.num_categories; c++) {
+        const StatCategory *stat_cat = &global_stat_table.categories[c];
+        fwrite(&stat_cat->id, sizeof(stat_cat->id), 1, file);
+        write_stats_cache_name(file, stat_cat->name, strlen(stat_cat->name));
+        fwrite(&stat_cat->num_focuses, sizeof(stat_cat->num_focuses), 1, file);
+        for (int f = 0; f < stat_cat->num_focuses; f++) {
+            const StatFocus *stat_focus = &stat_cat->focuses[f];
+            fwrite(&stat_focus->id, sizeof(stat_focus->id), 1, file);
+            write_stats_cache_name(file, stat_focus->name, strlen(stat_focus->name));
+            fwrite(&stat_focus->total_duration, sizeof(stat_focus->total_duration), 1, file);
+            fwrite(&stat_focus->session_count, sizeof(stat_focus->session_count), 1, file);
+            fwrite(&stat_focus->log_bytes, sizeof(stat_focus->log_bytes), 1, file);
+        }
+    }
+    bool ok = (ferror(file) == 0);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(temp_path, stats_cache_path) != 0) {
+        unlink(temp_path);
+    }
+}
+
+static void *stats_build_worker(void *arg) {
+    StatsBuild *build = (StatsBuild *)arg;
+    load_statistics_into(&build->table, &build->checkpoint, &build->binary_state, build->log_path, build->format, build);
+    __atomic_store_n(&build->finished, true, __ATOMIC_RELEASE);
+    uint64_t one = 1;
+    if (write(stats_event_fd, &one, sizeof(one)) < 0) { /* sayaç doluysa bildirim zaten bekliyor */ }
+    return NULL;
+}
+
+// Görüntüyü arka planda kurmaya başlar. from_snapshot ise yapım yayımlanan görüntünün bir
+// kopyasından başlar ve yalnızca kontrol noktasından sonra eklenen kayıtları okur; kopyalama
+// log boyutuna değil kategori/odak sayısına bağlıdır. Planlamada okunan kuşak ve inode
+// yapımla saklanır; yayımlarken log yeniden yazılmışsa görüntü atılır.
+// Return: true (iş parçacığı başladı), false (eventfd, bellek veya iş parçacığı hatası)
+static bool start_statistics_build(bool from_snapshot, uint64_t log_generation, const struct stat *st) {
+    StatsBuild *build = &stats_build;
+    if (stats_event_fd == -1) {
+        stats_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (stats_event_fd == -1) return false;
+    }
+    reset_stat_aggregates(&build->table);
+    binary_log_state_reset(&build->binary_state);
+    memset(&build->checkpoint, 0, sizeof(build->checkpoint));
+    if (from_snapshot) {
+        merge_stat_aggregates(&build->table, &global_stat_table);
+        if (!binary_log_state_copy(&build->binary_state, &active_binary_state)) {
+            return false;
+        }
+        build->checkpoint = stats_checkpoint;
+    }
+    build->table.since_time = stats_since_time;
+    snprintf(build->log_path, sizeof(build->log_path), "%s", active_log_path());
+    build->format = active_log_format;
+    build->log_generation = log_generation;
+    build->log_dev = st->st_dev;
+    build->log_ino = st->st_ino;
+    build->stale = false;
+    build->finished = false;
+    build->progress_bytes = 0;
+    build->total_bytes = 0;
+    if (pthread_create(&build->thread, NULL, stats_build_worker, build) != 0) {
+        return false;
+    }
+    build->running = true;
+    return true;
+}
+
+// Arayüz için istatistik yüklemesi; hiçbir zaman log boyutunda beklemez. Az sayıda yeni
+// kayıt hemen işlenir. Log baştan okunmalıysa (ilk açılış, yeniden yazılmış log) veya çok
+// büyüdüyse görüntü arka planda kurulur ve bu sırada son yayımlanan görüntü gösterilir.
+// Yapım başlatılamazsa log yine arayüzde okunmaz: son görüntü bir hata satırıyla gösterilir
+// ve wait_for_key STATS_RETRY_MS sonra yeniden dener.
+void request_statistics() {
+    if (stats_build.running) {
+        return; // Yapım yayımlanırken log yeniden denetlenir
+    }
+    uint64_t log_generation;
+    struct stat st;
+    StatsLoadKind kind = plan_statistics_load(&stats_checkpoint, active_log_path(), &log_generation, &st);
+    if (kind == STATS_LOAD_NONE) {
+        stats_retry_at_ms = 0;
+        return;
+    }
+    bool large = false;
+    if (kind == STATS_LOAD_REBUILD) {
+        large = (st.st_size >= STATS_ASYNC_MIN_BYTES);
+    } else if (kind == STATS_LOAD_APPEND) {
+        large = (st.st_size - stats_checkpoint.offset >= STATS_ASYNC_MIN_BYTES);
+    }
+    if (!large) {
+        load_statistics();
+        stats_retry_at_ms = 0;
+    } else if (start_statistics_build(kind == STATS_LOAD_APPEND, log_generation, &st)) {
+        stats_retry_at_ms = 0;
+    } else {
+        stats_retry_at_ms = monotonic_now_ms() + STATS_RETRY_MS;
+    }
+}
+
+// Biten yapımı toplar ve görüntüsünü öndeki görüntüyle değiştirir (yalnızca arayüz iş
+// parçacığı, iş parçacığı bildirimini yaptıktan sonra: pthread_join beklemez). Yapım sürerken
+// görüntü geçersiz kılındıysa veya logun kuşağı ya da inode'u değiştiyse eski bir logun
+// görüntüsü yayımlanmaz; yenisini çağıranın request_statistics()'i başlatır.
+// Return: true (yeni görüntü yayımlandı), false (görüntü atıldı)
+static bool publish_statistics_build() {
+    StatsBuild *build = &stats_build;
+    pthread_join(build->thread, NULL);
+    build->running = false;
+    uint64_t count;
+    if (read(stats_event_fd, &count, sizeof(count)) < 0) { /* bildirim yok */ }
+
+    struct stat st;
+    bool current = !build->stale && build->format == active_log_format &&
+                   strcmp(build->log_path, active_log_path()) == 0 &&
+                   read_work_log_generation() == build->log_generation &&
+                   stat(build->log_path, &st) == 0 && st.st_dev == build->log_dev && st.st_ino == build->log_ino;
+    if (!current) {
+        reset_stat_aggregates(&build->table);
+        binary_log_state_reset(&build->binary_state);
+        return false;
+    }
+
+    StatTable old_table = global_stat_table;
+    StatCheckpoint old_checkpoint = stats_checkpoint;
+    BinaryLogState old_binary_state = active_binary_state;
+    global_stat_table = build->table;
+    stats_checkpoint = build->checkpoint;
+    active_binary_state = build->binary_state;
+    build->table = old_table;
+    build->checkpoint = old_checkpoint;
+    build->binary_state = old_binary_state;
+    reset_stat_aggregates(&build->table); // Eski görüntünün toplamları bırakılır, isim indeksi sonraki yapımda kullanılır
+    binary_log_state_reset(&build->binary_state);
+    stats_generation++;
+    return true;
+}
+
+// Yapımın bildirimlerini boşaltır; görüntü hazırsa öndeki görüntüyle yer değiştirir.
+// Yalnızca arayüz iş parçacığında (wait_for_key içinde) çağrılır.
+// Return: true (ilerleme veya yeni görüntü: ekran güncellenmeli)
+bool drain_statistics_build() {
+    uint64_t count;
+    if (read(stats_event_fd, &count, sizeof(count)) < 0) { /* bildirim yok */ }
+    StatsBuild *build = &stats_build;
+    if (!build->running) {
+        return false;
+    }
+    if (!__atomic_load_n(&build->finished, __ATOMIC_ACQUIRE)) {
+        return true; // Yalnızca ilerleme
+    }
+    publish_statistics_build();
+    request_statistics(); // Yapım sürerken eklenen kayıtlar veya atılan görüntünün yerine yenisi
+    return true;
+}
+
+// Yazıcı durumunun kontrol noktasını logda offset'e kurar
+static void set_writer_checkpoint(int fd, off_t offset, uint64_t log_generation, const struct stat *st) {
+    writer_checkpoint.valid = true;
+    writer_checkpoint.dev = st->st_dev;
+    writer_checkpoint.ino = st->st_ino;
+    writer_checkpoint.log_generation = log_generation;
+    writer_checkpoint.offset = offset;
+    writer_checkpoint.tail_hash = hash_log_tail(fd, offset, &writer_checkpoint.tail_len);
+}
+
+// İkili log ekleyicilerinin durumunu (sözlük ve fark kodlaması) özel log kilidi altında
+// dosyanın sonuna getirir. İstatistik görüntüsüne ve arka plan yapımına dokunmaz, yapımı
+// beklemez: yazıcının kendi kontrol noktasından sonra eklenen kayıtlar yalnızca sözlük için
+// okunur. Log yeniden yazıldıysa durum, loga hâlâ uyan yayımlanmış görüntüden (veya sorgu
+// önbelleğinden) kopyalanıp yalnızca kuyruğu okunur; bu örneğin sıkıştırdığı log için durum
+// adopt_binary_writer_state ile zaten hazırdır. Hiçbiri uymuyorsa log bir kez baştan okunur.
+void sync_binary_log_state() {
+    const char *log_path = active_log_path();
+    uint64_t log_generation;
+    struct stat st;
+    StatsLoadKind kind = plan_statistics_load(&writer_checkpoint, log_path, &log_generation, &st);
+    if (kind == STATS_LOAD_NONE) {
+        return;
+    }
+    if (kind != STATS_LOAD_APPEND) {
+        StatsLoadKind snapshot_kind = plan_statistics_load(&stats_checkpoint, log_path, &log_generation, &st);
+        if ((snapshot_kind == STATS_LOAD_NONE || snapshot_kind == STATS_LOAD_APPEND) &&
+            binary_log_state_copy(&writer_binary_state, &active_binary_state)) {
+            writer_checkpoint = stats_checkpoint;
+        } else {
+            binary_log_state_reset(&writer_binary_state);
+            writer_checkpoint.valid = false;
+        }
+    }
+
+    LogReader reader;
+    if (!log_reader_open(&reader, log_path, LOG_FORMAT_BINARY, writer_checkpoint.valid ? writer_checkpoint.offset : 0, &writer_binary_state)) {
+        writer_checkpoint.valid = false;
+        return;
+    }
+    LogRecord record;
+    while (log_reader_next(&reader, &record)) {
+        // Yalnızca sözlük ve fark kodlaması durumu ilerler
+    }
+    set_writer_checkpoint(reader.scanner.fd, reader.scanner.pos, log_generation, &st);
+    log_reader_close(&reader);
+}
+
+// Bu örneğin yeniden yazdığı ikili logun, yazılırken kurulan son durumunu ekleyicilere devreder
+// (state boşaltılır). Özel log kilidi altında, log yerine konup kuşağı artırıldıktan sonra çağrılır.
+void adopt_binary_writer_state(BinaryLogState *state) {
+    binary_log_state_reset(&writer_binary_state);
+    writer_binary_state = *state;
+    memset(state, 0, sizeof(*state));
+
+    writer_checkpoint.valid = false;
+    uint64_t log_generation = read_work_log_generation();
+    int fd = open(active_log_path(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd != -1 && fstat(fd, &st) == 0) {
+        set_writer_checkpoint(fd, st.st_size, log_generation, &st); // Yeni log okunmaz
+    }
+    if (fd != -1) close(fd);
+}
+
+// Return: true (daha yeni bir görüntü hazırlanıyor; *percent okunan yüzde)
+bool statistics_build_progress(int *percent) {
+    if (!stats_build.running) {
+        return false;
+    }
+    off_t total = __atomic_load_n(&stats_build.total_bytes, __ATOMIC_RELAXED);
+    off_t done = __atomic_load_n(&stats_build.progress_bytes, __ATOMIC_RELAXED);
+    *percent = (total > 0) ? (int)(done * 100 / total) : 0;
+    if (*percent > 99) *percent = 99; // Yayımlanana kadar
+    return true;
+}
+
+// İsim indeksi için FNV-1a hash'i; odaklar kategori ID'si ile karıştırılır,
+// böylece farklı kategorilerdeki aynı adlı odaklar ayrı anahtarlar olur.
+static unsigned long hash_stat_name(const char *name, size_t name_len, int category_id) {
+    unsigned long hash = 14695981039346656037UL;
+    for (size_t i = 0; i < name_len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 1099511628211UL;
+    }
+    hash ^= (unsigned long)(category_id + 1);
+    hash *= 1099511628211UL;
+    return hash;
+}
+
+// Kalıcı ID'li girdilerin anahtarı ID'nin kendisidir; ad yeniden adlandırmada değişse de
+// girdi aynı kalır.
+static unsigned long hash_stat_entity(uint32_t entity_id, int category_id) {
+    unsigned long hash = (unsigned long)entity_id * 2654435761UL;
+    hash ^= (unsigned long)(category_id + 1) << 32;
+    return hash * 1099511628211UL;
+}
+
+static unsigned long hash_stat_key(uint32_t entity_id, const char *name, size_t name_len, int category_id) {
+    return (entity_id != 0) ? hash_stat_entity(entity_id, category_id) : hash_stat_name(name, name_len, category_id);
+}
+
+static bool stat_name_matches(const char *stored, const char *name, size_t name_len) {
+    return strncmp(stored, name, name_len) == 0 && stored[name_len] == '\0';
+}
+
+// Kalıcı ID'li anahtarlar ID ile, ID'siz (eski) anahtarlar yalnızca ID'siz girdiler arasında adla eşleşir
+static bool stat_key_matches(uint32_t stored_id, const char *stored_name, uint32_t entity_id, const char *name, size_t name_len) {
+    return (entity_id != 0) ? stored_id == entity_id : (stored_id == 0 && stat_name_matches(stored_name, name, name_len));
+}
+
+// Verilen anahtar için yuvayı bulur (doğrusal yoklama). Anahtar yoksa ilk boş yuvayı,
+// tablo henüz hiç büyütülmediyse NULL döndürür.
+static StatNameSlot *find_stat_name_slot(StatTable *table, uint32_t entity_id, const char *name, size_t name_len, int category_id, unsigned long hash) {
+    if (table->name_table_size == 0) return NULL;
+    unsigned long mask = (unsigned long)table->name_table_size - 1;
+    for (unsigned long i = hash & mask; ; i = (i + 1) & mask) {
+        StatNameSlot *slot = &table->name_table[i];
+        if (!slot->used) {
+            return slot;
+        }
+        if (slot->hash != hash) continue;
+        if (category_id == -1) {
+            StatCategory *stat_cat = &table->categories[slot->category_id];
+            if (slot->focus_id == -1 && stat_key_matches(stat_cat->id, stat_cat->name, entity_id, name, name_len)) {
+                return slot;
+            }
+        } else if (slot->focus_id != -1 && slot->category_id == category_id) {
+            StatFocus *stat_focus = &table->categories[category_id].focuses[slot->focus_id];
+            if (stat_key_matches(stat_focus->id, stat_focus->name, entity_id, name, name_len)) {
+                return slot;
+            }
+        }
+    }
+}
+
+// Bir istatistik odağının toplamlarını sıfırlar ve kapladığı baytları ölü bayt sayar
+static void clear_stat_focus(StatTable *table, StatFocus *stat_focus) {
+    table->dead_bytes += stat_focus->log_bytes;
+    stat_focus->total_duration = 0;
+    stat_focus->session_count = 0;
+    stat_focus->log_bytes = 0;
+}
+
+// Verilen anahtarla (ID veya ID'siz ad) bulunan kategorinin tüm odaklarını ya da tek odağını sıfırlar
+static void clear_stat_key(StatTable *table, uint32_t category_entity, const char *category_name, size_t category_len,
+                           uint32_t focus_entity, const char *focus_name, size_t focus_len, bool whole_category) {
+    StatNameSlot *slot = find_stat_name_slot(table, category_entity, category_name, category_len, -1,
+                                             hash_stat_key(category_entity, category_name, category_len, -1));
+    if (slot == NULL || !slot->used) {
+        return; // Bu kategoriye ait kayıt yok
+    }
+    StatCategory *stat_cat = &table->categories[slot->category_id];
+    if (whole_category) {
+        for (int i = 0; i < stat_cat->num_focuses; i++) {
+            clear_stat_focus(table, &stat_cat->focuses[i]);
+        }
+        return;
+    }
+    int category_id = slot->category_id;
+    slot = find_stat_name_slot(table, focus_entity, focus_name, focus_len, category_id,
+                               hash_stat_key(focus_entity, focus_name, focus_len, category_id));
+    if (slot->used) {
+        clear_stat_focus(table, &stat_cat->focuses[slot->focus_id]);
+    }
+}
+
+// Silme işaretinden önce gelen, silinen kategori/odağa ait toplamları sıfırlar ve
+// kapladıkları baytları ölü bayt olarak sayar. Kategori/odak tabloda kalır; aynı adla
+// sonradan eklenen oturumlar sıfırdan birikir. Kimlik geçişinin iki yanındaki oturumlar
+// da eşlenir: ID'li işaret aynı adla ID'siz yazılmış girdileri, ID'siz eski işaret ise
+// adı eşleşen ID'li girdileri de sıfırlar.
+void apply_stat_tombstone(StatTable *table, const LogRecord *record) {
+    bool whole_category = (record->type == LOG_RECORD_DELETE_CATEGORY);
+    size_t category_len = record->category.len < MAX_CATEGORY_NAME_LEN ? record->category.len : MAX_CATEGORY_NAME_LEN - 1;
+    size_t focus_len = record->focus.len < MAX_FOCUS_NAME_LEN ? record->focus.len : MAX_FOCUS_NAME_LEN - 1;
+    clear_stat_key(table, record->category_id, record->category.ptr, category_len,
+                   record->focus_id, record->focus.ptr, focus_len, whole_category);
+    if (record->category_id != 0) {
+        clear_stat_key(table, 0, record->category.ptr, category_len, 0, record->focus.ptr, focus_len, whole_category);
+        return;
+    }
+    for (int c = 0; c < table->num_categories; c++) {
+        StatCategory *stat_cat = &table->categories[c];
+        if (stat_cat->id == 0 || !stat_name_matches(stat_cat->name, record->category.ptr, category_len)) {
+            continue;
+        }
+        for (int f = 0; f < stat_cat->num_focuses; f++) {
+            StatFocus *stat_focus = &stat_cat->focuses[f];
+            if (whole_category || (stat_focus->id != 0 && stat_name_matches(stat_focus->name, record->focus.ptr, focus_len))) {
+                clear_stat_focus(table, stat_focus);
+            }
+        }
+    }
+}
+
+// İsim indeksinde bir girdi daha için yer açar; doluluk yarıyı geçecekse tablo
+// iki katına büyütülür ve girdiler saklı hash'leriyle yeniden yerleştirilir.
+static bool reserve_stat_name_slot(StatTable *table) {
+    if ((table->name_table_used + 1) * 2 <= table->name_table_size) return true;
+    int new_size = (table->name_table_size == 0) ? STAT_NAME_TABLE_MIN_SIZE : table->name_table_size * 2;
+    StatNameSlot *new_table = calloc((size_t)new_size, sizeof(StatNameSlot));
+    if (new_table == NULL) return false;
+    unsigned long mask = (unsigned long)new_size - 1;
+    for (int i = 0; i < table->name_table_size; i++) {
+        StatNameSlot *old_slot = &table->name_table[i];
+        if (!old_slot->used) continue;
+        unsigned long j = old_slot->hash & mask;
+        while (new_table[j].used) j = (j + 1) & mask;
+        new_table[j] = *old_slot;
+    }
+    free(table->name_table);
+    table->name_table = new_table;
+    table->name_table_size = new_size;
+    return true;
+}
+
+// Tüm istatistikleri ve isim indeksini sıfırlar. Diziler ve adlar arenalarla
+// birlikte bırakılır; isim indeksi boyutunu korur.
+void reset_stat_aggregates(StatTable *table) {
+    arena_free(&table->arena);
+    arena_free(&table->strings);
+    table->categories = NULL;
+    table->num_categories = 0;
+    table->category_capacity = 0;
+    table->dead_bytes = 0;
+    table->corrupt_bytes = 0;
+    table->name_table_used = 0;
+    if (table->name_table != NULL) {
+        memset(table->name_table, 0, (size_t)table->name_table_size * sizeof(StatNameSlot));
+    }
+}
+
+// Tablonun tüm belleğini bırakır (paralel yüklemedeki özel tablolar için)
+void stat_table_free(StatTable *table) {
+    reset_stat_aggregates(table);
+    free(table->name_table);
+    table->name_table = NULL;
+    table->name_table_size = 0;
+}
+
+// Kategori adının ID'sini döndürür, yoksa yeni bir kategori oluşturur.
+// Return: Kategori ID'si, -1 (bellek yetersiz)
+int intern_stat_category(StatTable *table, uint32_t entity_id, const char *category_name, size_t name_len) {
+    if (name_len > MAX_CATEGORY_NAME_LEN - 1) name_len = MAX_CATEGORY_NAME_LEN - 1;
+    if (!reserve_stat_name_slot(table)) {
+        return -1;
+    }
+    unsigned long hash = hash_stat_key(entity_id, category_name, name_len, -1);
+    StatNameSlot *slot = find_stat_name_slot(table, entity_id, category_name, name_len, -1, hash);
+    if (slot->used) {
+        return slot->category_id;
+    }
+
+    StatCategory *grown = arena_grow_array(&table->arena, table->categories, sizeof(StatCategory), table->num_categories, &table->category_capacity);
+    if (grown == NULL) {
+        return -1;
+    }
+    table->categories = grown;
+    char *name_copy = arena_strndup(&table->strings, category_name, name_len);
+    if (name_copy == NULL) {
+        return -1;
+    }
+
+    int cat_idx = table->num_categories++;
+    StatCategory *stat_cat = &table->categories[cat_idx];
+    memset(stat_cat, 0, sizeof(*stat_cat));
+    stat_cat->name = name_copy;
+    stat_cat->id = entity_id;
+
+    table->name_table_used++;
+    slot->used = true;
+    slot->hash = hash;
+    slot->category_id = cat_idx;
+    slot->focus_id = -1;
+    return cat_idx;
+}
+
+// Kategorideki odak adının ID'sini döndürür, yoksa yeni bir odak oluşturur.
+// Return: Odak ID'si, -1 (bellek yetersiz)
+int intern_stat_focus(StatTable *table, int category_id, uint32_t entity_id, const char *focus_name, size_t name_len) {
+    if (name_len > MAX_FOCUS_NAME_LEN - 1) name_len = MAX_FOCUS_NAME_LEN - 1;
+    if (!reserve_stat_name_slot(table)) {
+        return -1;
+    }
+    unsigned long hash = hash_stat_key(entity_id, focus_name, name_len, category_id);
+    StatNameSlot *slot = find_stat_name_slot(table, entity_id, focus_name, name_len, category_id, hash);
+    if (slot->used) {
+        return slot->focus_id;
+    }
+
+    StatCategory *stat_cat = &table->categories[category_id];
+    StatFocus *grown = arena_grow_array(&table->arena, stat_cat->focuses, sizeof(StatFocus), stat_cat->num_focuses, &stat_cat->focus_capacity);
+    if (grown == NULL) {
+        return -1;
+    }
+    stat_cat->focuses = grown;
+    char *name_copy = arena_strndup(&table->strings, focus_name, name_len);
+    if (name_copy == NULL) {
+        return -1;
+    }
+
+    int focus_idx = stat_cat->num_focuses++;
+    stat_cat->focuses[focus_idx].name = name_copy;
+    stat_cat->focuses[focus_idx].id = entity_id;
+    stat_cat->focuses[focus_idx].total_duration = 0;
+    stat_cat->focuses[focus_idx].session_count = 0;
+    stat_cat->focuses[focus_idx].log_bytes = 0;
+
+    slot->used = true;
+    slot->hash = hash;
+    table->name_table_used++;
+    slot->category_id = category_id;
+    slot->focus_id = focus_idx;
+    return focus_idx;
+}
+
+// Kalıcı ID ile istatistik kategorisini bulur (tek hash araması)
+int get_stat_category_index(uint32_t category_id) {
+    StatNameSlot *slot = find_stat_name_slot(&global_stat_table, category_id, NULL, 0, -1, hash_stat_entity(category_id, -1));
+    return (slot != NULL && slot->used) ? slot->category_id : -1;
+}
+
+int get_stat_focus_index(StatCategory *stat_cat, uint32_t focus_id) {
+    int category_id = (int)(stat_cat - global_stat_table.categories);
+    StatNameSlot *slot = find_stat_name_slot(&global_stat_table, focus_id, NULL, 0, category_id, hash_stat_entity(focus_id, category_id));
+    return (slot != NULL && slot->used) ? slot->focus_id : -1;
+}
+
+// Sıralamada a, b'den önce mi gelir: uzun süre önce, eşitlikte tablodaki sıra
+static bool ranked_focus_before(const RankedFocus *a, const RankedFocus *b) {
+    if (a->total_duration != b->total_duration) return a->total_duration > b->total_duration;
+    if (a->category_index != b->category_index) return a->category_index < b->category_index;
+    return a->focus_index < b->focus_index;
+}
+
+static StatFocus *ranked_stat_focus(const RankedFocus *ranked) {
+    return &global_stat_table.categories[ranked->category_index].focuses[ranked->focus_index];
+}
+
+// Kökte sıralamanın en sonundaki girdinin durduğu yığında i konumunu aşağı indirir
+static void ranking_heap_sift_down(RankedFocus *heap, int count, int i) {
+    while (1) {
+        int last = i, left = 2 * i + 1, right = left + 1;
+        if (left < count && ranked_focus_before(&heap[last], &heap[left])) last = left;
+        if (right < count && ranked_focus_before(&heap[last], &heap[right])) last = right;
+        if (last == i) return;
+        RankedFocus temp = heap[i];
+        heap[i] = heap[last];
+        heap[last] = temp;
+        i = last;
+    }
+}
+
+// En uzun süreli ilk limit odağı sıralı olarak döndürür. Seçim, K boyutlu bir yığınla
+// tek geçişte yapılır (O(n log K)); sonuç istatistikler değişene kadar önbellekte kalır.
+// Return: sıralama, NULL (bellek yetersiz)
+const FocusRanking *get_focus_ranking(int limit) {
+    FocusRanking *ranking = &focus_ranking;
+    if (ranking->valid && ranking->generation == stats_generation &&
+        (ranking->limit >= limit || ranking->count == ranking->num_focuses)) {
+        return ranking;
+    }
+
+    if (limit < 1) limit = 1;
+    if (ranking->capacity < limit) {
+        RankedFocus *grown = realloc(ranking->entries, (size_t)limit * sizeof(RankedFocus));
+        if (grown == NULL) return NULL;
+        ranking->entries = grown;
+        ranking->capacity = limit;
+    }
+
+    RankedFocus *heap = ranking->entries;
+    int count = 0;
+    ranking->num_focuses = 0;
+    ranking->total_duration = 0;
+    for (int i = 0; i < global_stat_table.num_categories; i++) {
+        StatCategory *stat_cat = &global_stat_table.categories[i];
+        for (int j = 0; j < stat_cat->num_focuses; j++) {
+            RankedFocus candidate = { i, j, stat_cat->focuses[j].total_duration };
+            ranking->total_duration += candidate.total_duration;
+            ranking->num_focuses++;
+            if (count < limit) {
+                // Yığın dolana kadar ekle; dolunca kökte en sondaki girdi olacak şekilde düzenle
+                heap[count++] = candidate;
+                if (count == limit) {
+                    for (int k = count / 2 - 1; k >= 0; k--) ranking_heap_sift_down(heap, count, k);
+                }
+            } else if (ranked_focus_before(&candidate, &heap[0])) {
+                heap[0] = candidate;
+                ranking_heap_sift_down(heap, count, 0);
+            }
+        }
+    }
+    if (count < limit) {
+        for (int k = count / 2 - 1; k >= 0; k--) ranking_heap_sift_down(heap, count, k);
+    }
+
+    // Yığın sıralaması: en sondaki girdi köktedir, dizinin sonuna taşınarak azalan sıra elde edilir
+    for (int end = count - 1; end > 0; end--) {
+        RankedFocus temp = heap[0];
+        heap[0] = heap[end];
+        heap[end] = temp;
+        ranking_heap_sift_down(heap, end, 0);
+    }
+
+    ranking->count = count;
+    ranking->limit = limit;
+    ranking->generation = stats_generation;
+    ranking->valid = true;
+    return ranking;
+}
+
+// İstatistik tablosunun kategori modeline bağlı düzenini döndürür; yalnızca kategori
+// modeli değiştiğinde O(kategori + odak) zamanda yeniden kurulur.
+// Return: düzen, NULL (bellek yetersiz)
+const StatsTableLayout *get_stats_table_layout() {
+    StatsTableLayout *layout = &stats_table_layout;
+    if (layout->valid && layout->entity_generation == entity_generation) {
+        return layout;
+    }
+
+    if (layout->capacity < num_user_categories + 1) {
+        int *grown = realloc(layout->focus_base, (size_t)(num_user_categories + 1) * sizeof(int));
+        if (grown == NULL) return NULL;
+        layout->focus_base = grown;
+        layout->capacity = num_user_categories + 1;
+    }
+
+    int base = 0;
+    layout->category_name_width = 0;
+    layout->focus_name_width = 0;
+    for (int i = 0; i < num_user_categories; i++) {
+        layout->focus_base[i] = base;
+        base += user_categories[i].num_focuses;
+        if (user_categories[i].name_width > layout->category_name_width) {
+            layout->category_name_width = user_categories[i].name_width;
+        }
+        for (int j = 0; j < user_categories[i].num_focuses; j++) {
+            if (user_categories[i].focuses[j].name_width > layout->focus_name_width) {
+                layout->focus_name_width = user_categories[i].focuses[j].name_width;
+            }
+        }
+    }
+    layout->focus_base[num_user_categories] = base;
+    // Her kategori için başlık ve boş satır; son kategoriden sonra boş satır yok
+    layout->num_rows = (num_user_categories > 0) ? base + 2 * num_user_categories - 1 : 0;
+
+    layout->entity_generation = entity_generation;
+    layout->valid = true;
+    return layout;
+}
+
+// Tablodaki her odağın ve kategorinin süre/oturum değerlerini döndürür; istatistikler
+// veya kategori modeli değişene kadar yeniden kullanılır.
+// Return: değerler, NULL (bellek yetersiz)
+const StatsTableValues *get_stats_table_values() {
+    StatsTableValues *values = &stats_table_values;
+    if (values->valid && values->stats_generation == stats_generation &&
+        values->entity_generation == entity_generation) {
+        return values;
+    }
+
+    const StatsTableLayout *layout = get_stats_table_layout();
+    if (layout == NULL) return NULL;
+    int total_focuses = layout->focus_base[num_user_categories];
+    if (values->focus_capacity < total_focuses + 1) {
+        StatsRowValue *grown = realloc(values->focus_values, (size_t)(total_focuses + 1) * sizeof(StatsRowValue));
+        if (grown == NULL) return NULL;
+        values->focus_values = grown;
+        values->focus_capacity = total_focuses + 1;
+    }
+    if (values->category_capacity < num_user_categories + 1) {
+        StatsRowValue *grown = realloc(values->category_values, (size_t)(num_user_categories + 1) * sizeof(StatsRowValue));
+        if (grown == NULL) return NULL;
+        values->category_values = grown;
+        values->category_capacity = num_user_categories + 1;
+    }
+
+    memset(values->focus_values, 0, (size_t)(total_focuses + 1) * sizeof(StatsRowValue));
+    memset(values->category_values, 0, (size_t)(num_user_categories + 1) * sizeof(StatsRowValue));
+    for (int i = 0; i < num_user_categories; i++) {
+        int stat_cat_idx = get_stat_category_index(user_categories[i].id);
+        if (stat_cat_idx == -1) continue; // Kategori istatistiklerde yoksa değerler 0 kalır
+        StatCategory *stat_cat = &global_stat_table.categories[stat_cat_idx];
+        StatsRowValue *category_value = &values->category_values[i];
+        for (int j = 0; j < user_categories[i].num_focuses; j++) {
+            int stat_focus_idx = get_stat_focus_index(stat_cat, user_categories[i].focuses[j].id);
+            if (stat_focus_idx == -1) continue;
+            StatsRowValue *focus_value = &values->focus_values[layout->focus_base[i] + j];
+            focus_value->total_duration = stat_cat->focuses[stat_focus_idx].total_duration;
+            focus_value->session_count = stat_cat->focuses[stat_focus_idx].session_count;
+            category_value->total_duration += focus_value->total_duration;
+            category_value->session_count += focus_value->session_count;
+        }
+    }
+
+    values->stats_generation = stats_generation;
+    values->entity_generation = entity_generation;
+    values->valid = true;
+    return values;
+}
+
+// qsort karşılaştırıcısının bağlamı (yalnızca get_stats_ordering içinde geçerli)
+static const StatsRowValue *stats_sort_values;
+static const Category *stats_sort_category; // NULL: kategoriler sıralanıyor
+static StatsSortKey stats_sort_key;
+static bool stats_sort_descending;
+
+static int compare_stats_rows(const void *a, const void *b) {
+    int left = *(const int *)a;
+    int right = *(const int *)b;
+    const StatsRowValue *lv = &stats_sort_values[left];
+    const StatsRowValue *rv = &stats_sort_values[right];
+    int result = 0;
+    switch (stats_sort_key) {
+        case STATS_SORT_TOTAL:
+            result = (lv->total_duration > rv->total_duration) - (lv->total_duration < rv->total_duration);
+            break;
+        case STATS_SORT_SESSIONS:
+            result = (lv->session_count > rv->session_count) - (lv->session_count < rv->session_count);
+            break;
+        case STATS_SORT_AVERAGE: {
+            // Ortalamalar bölme yapmadan çapraz çarpımla karşılaştırılır; oturumu olmayanın ortalaması 0
+            long long l = (lv->session_count > 0) ? (long long)lv->total_duration * (rv->session_count > 0 ? rv->session_count : 1) : 0;
+            long long r = (rv->session_count > 0) ? (long long)rv->total_duration * (lv->session_count > 0 ? lv->session_count : 1) : 0;
+            result = (l > r) - (l < r);
+            break;
+        }
+        case STATS_SORT_NAME: {
+            const char *left_name = (stats_sort_category != NULL) ? stats_sort_category->focuses[left].name : user_categories[left].name;
+            const char *right_name = (stats_sort_category != NULL) ? stats_sort_category->focuses[right].name : user_categories[right].name;
+            result = strcasecmp(left_name, right_name);
+            break;
+        }
+        default:
+            break;
+    }
+    if (stats_sort_descending) result = -result;
+    // Eşitlikte tanım sırası korunur (her iki yönde de)
+    return (result != 0) ? result : (left > right) - (left < right);
+}
+
+// Tablonun verilen anahtar ve yöndeki dizilişini döndürür. Her diziliş istatistik ve
+// kategori modeli nesli başına bir kez sıralanır; sıralama değiştirmek yalnızca önbellekten okur.
+// Return: diziliş, NULL (bellek yetersiz)
+const StatsOrdering *get_stats_ordering(StatsSortKey key, bool descending) {
+    StatsOrdering *ordering = &stats_orderings[key][descending ? 1 : 0];
+    if (ordering->valid && ordering->stats_generation == stats_generation &&
+        ordering->entity_generation == entity_generation) {
+        return ordering;
+    }
+
+    const StatsTableLayout *layout = get_stats_table_layout();
+    const StatsTableValues *values = get_stats_table_values();
+    if (layout == NULL || values == NULL) return NULL;
+    int total_focuses = layout->focus_base[num_user_categories];
+    if (ordering->category_capacity < num_user_categories + 1) {
+        int *grown_order = realloc(ordering->category_order, (size_t)(num_user_categories + 1) * sizeof(int));
+        if (grown_order == NULL) return NULL;
+        ordering->category_order = grown_order;
+        int *grown_rows = realloc(ordering->category_first_row, (size_t)(num_user_categories + 1) * sizeof(int));
+        if (grown_rows == NULL) return NULL;
+        ordering->category_first_row = grown_rows;
+        ordering->category_capacity = num_user_categories + 1;
+    }
+    if (ordering->focus_capacity < total_focuses + 1) {
+        int *grown = realloc(ordering->focus_order, (size_t)(total_focuses + 1) * sizeof(int));
+        if (grown == NULL) return NULL;
+        ordering->focus_order = grown;
+        ordering->focus_capacity = total_focuses + 1;
+    }
+
+    stats_sort_key = key;
+    stats_sort_descending = descending;
+    for (int i = 0; i < num_user_categories; i++) {
+        ordering->category_order[i] = i;
+        int *focus_order = &ordering->focus_order[layout->focus_base[i]];
+        for (int j = 0; j < user_categories[i].num_focuses; j++) focus_order[j] = j;
+        if (key != STATS_SORT_DEFINED) {
+            stats_sort_values = &values->focus_values[layout->focus_base[i]];
+            stats_sort_category = &user_categories[i];
+            qsort(focus_order, user_categories[i].num_focuses, sizeof(int), compare_stats_rows);
+        }
+    }
+    if (key != STATS_SORT_DEFINED) {
+        stats_sort_values = values->category_values;
+        stats_sort_category = NULL;
+        qsort(ordering->category_order, num_user_categories, sizeof(int), compare_stats_rows);
+    }
+
+    int row = 0;
+    for (int p = 0; p < num_user_categories; p++) {
+        ordering->category_first_row[p] = row;
+        row += user_categories[ordering->category_order[p]].num_focuses + 2; // Başlık, odaklar ve boş satır
+    }
+    ordering->category_first_row[num_user_categories] = row;
+
+    ordering->stats_generation = stats_generation;
+    ordering->entity_generation = entity_generation;
+    ordering->valid = true;
+    return ordering;
+}
+
+// Tablonun row. satırını çözer (kategori başlangıçları üzerinde ikili arama).
+// Return: kategorinin görüntüleme konumu; *focus_index odak indeksi, STATS_ROW_CATEGORY veya STATS_ROW_BLANK
+static int stats_table_row_at(const StatsTableLayout *layout, const StatsOrdering *ordering, int row, int *focus_index) {
+    int low = 0, high = num_user_categories - 1;
+    while (low < high) {
+        int mid = low + (high - low + 1) / 2;
+        if (ordering->category_first_row[mid] <= row) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    int i = ordering->category_order[low];
+    int offset = row - ordering->category_first_row[low];
+    if (offset == 0) {
+        *focus_index = STATS_ROW_CATEGORY;
+    } else if (offset <= user_categories[i].num_focuses) {
+        *focus_index = ordering->focus_order[layout->focus_base[i] + offset - 1];
+    } else {
+        *focus_index = STATS_ROW_BLANK;
+    }
+    return low;
+}
 
-    int current_y = 2;
-    int max_display_rows = yMax - current_y - 4;
+// Tablonun sütun genişliklerini ve konumlarını döndürür. Ad genişlikleri kategori
+// modeliyle önbelleğe alınmıştır; burada ad taranmaz, yalnızca ekran genişliği, dil veya
+// kategori modeli değiştiğinde konumlar yeniden hesaplanır.
+// Return: metrikler, NULL (bellek yetersiz)
+const StatsColumnMetrics *get_stats_column_metrics(bool english, int cols) {
+    StatsColumnMetrics *metrics = &stats_column_metrics;
+    if (metrics->valid && metrics->cols == cols && metrics->english == english &&
+        metrics->entity_generation == entity_generation) {
+        return metrics;
+    }
+    const StatsTableLayout *table = get_stats_table_layout();
+    if (table == NULL) return NULL;
 
     // Calculate max widths for alignment in the statistics table
-    int max_cat_name_len_display = strlen((current_lang_menu_items == menu_items_en) ? "Category" : "Kategori");
-    int max_focus_name_len_display = strlen((current_lang_menu_items == menu_items_en) ? "Focus" : "Odak");
+    metrics->category_width = text_width(english ? "Category" : "Kategori");
+    metrics->focus_width = text_width(english ? "Focus" : "Odak");
+    metrics->sessions_width = text_width(english ? "Sessions" : "Oturum");
     char temp_duration_buffer[20];
     format_duration_string(9999999, temp_duration_buffer, sizeof(temp_duration_buffer)); // Max possible duration string
-    int max_duration_str_len_display = strlen((current_lang_menu_items == menu_items_en) ? "Duration" : "Süre");
-    if (strlen(temp_duration_buffer) > max_duration_str_len_display) {
-        max_duration_str_len_display = strlen(temp_duration_buffer);
-    }
-
-
-    for (int i = 0; i < num_user_categories; i++) {
-        if (strlen(user_categories[i].name) > max_cat_name_len_display) {
-            max_cat_name_len_display = strlen(user_categories[i].name);
-        }
-        for (int j = 0; j < user_categories[i].num_focuses; j++) {
-            if (strlen(user_categories[i].focuses[j].name) > max_focus_name_len_display) {
-                max_focus_name_len_display = strlen(user_categories[i].focuses[j].name);
-            }
-        }
-    }
+    metrics->duration_width = strlen(temp_duration_buffer);
+    if (text_width(english ? "Duration" : "Süre") > metrics->duration_width) metrics->duration_width = text_width(english ? "Duration" : "Süre");
+    if (text_width(english ? "Average" : "Ortalama") > metrics->duration_width) metrics->duration_width = text_width(english ? "Average" : "Ortalama");
+    if (table->category_name_width > metrics->category_width) metrics->category_width = table->category_name_width;
+    if (table->focus_name_width > metrics->focus_width) metrics->focus_width = table->focus_name_width;
 
     // Add some padding to column widths
-    max_cat_name_len_display += 2;
-    max_focus_name_len_display += 2;
-    max_duration_str_len_display += 2;
-
-    // Calculate total line width for the table (Category + " | " + Focus + " | " + Duration)
-    int total_table_line_width = max_cat_name_len_display + strlen(" | ") + max_focus_name_len_display + strlen(" | ") + max_duration_str_len_display;
-
-    // Calculate start_x to center the entire table
-    int table_start_x = (xMax - total_table_line_width) / 2;
-    if (table_start_x < 0) table_start_x = 0;
-
+    metrics->category_width += 2;
+    metrics->focus_width += 2;
+    metrics->duration_width += 2;
+
+    // Total line width for the table (Category | Focus | Sessions | Average | Duration)
+    metrics->values_start = metrics->category_width + strlen(" | ") + metrics->focus_width;
+    metrics->line_width = metrics->values_start + 3 * strlen(" | ") + metrics->sessions_width + 2 * metrics->duration_width;
+
+    // Start x to center the entire table
+    metrics->start_x = (cols - metrics->line_width) / 2;
+    if (metrics->start_x < 0) metrics->start_x = 0;
+
+    metrics->cols = cols;
+    metrics->english = english;
+    metrics->entity_generation = entity_generation;
+    metrics->valid = true;
+    return metrics;
+}
 
-    const char *cat_header = (current_lang_menu_items == menu_items_en) ? "Category" : "Kategori";
-    const char *focus_header = (current_lang_menu_items == menu_items_en) ? "Focus" : "Odak";
-    const char *duration_header = (current_lang_menu_items == menu_items_en) ? "Duration" : "Süre";
+// Bir tablo satırının oturum, ortalama ve süre sütunlarını yazar
+static void draw_stats_value_columns(WINDOW *win, int y, const StatsColumnMetrics *metrics, const StatsRowValue *value) {
+    char average_str[20];
+    char total_str[20];
+    char line[128];
+    format_duration_string((value->session_count > 0) ? value->total_duration / value->session_count : 0, average_str, sizeof(average_str));
+    format_duration_string(value->total_duration, total_str, sizeof(total_str));
+    snprintf(line, sizeof(line), " | %*d | %*s | %*s",
+             metrics->sessions_width, value->session_count,
+             metrics->duration_width, average_str,
+             metrics->duration_width, total_str);
+    put_clipped(win, y, metrics->start_x + metrics->values_start, line);
+}
 
-    // Print headers
-    attron(A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-    mvprintw(current_y, table_start_x, "%-*s | %-*s | %*s",
-             max_cat_name_len_display, cat_header,
-             max_focus_name_len_display, focus_header,
-             max_duration_str_len_display, duration_header);
-    attroff(A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-    current_y++;
+// Arka planda yeni bir istatistik görüntüsü kuruluyorsa satırın ortasına ilerlemeyi yazar;
+// yapım başlatılamadıysa hatayı, logda bozuk bayt atlandıysa bir uyarı yazar, yoksa satırı temizler
+// Return: true (yapım sürüyor)
+static bool draw_stats_progress(WINDOW *win, int y, int cols, bool english) {
+    wmove(win, y, 0);
+    wclrtoeol(win);
+    int percent;
+    if (!statistics_build_progress(&percent)) {
+        if (stats_retry_at_ms != 0) {
+            const char *error_msg = english ? "Error: statistics could not be updated, retrying" : "Hata: istatistikler güncellenemedi, yeniden denenecek";
+            wattron(win, COLOR_PAIR(COLOR_PAIR_RED));
+            mvwprintw(win, y, (cols - text_width(error_msg)) / 2, "%s", error_msg);
+            wattroff(win, COLOR_PAIR(COLOR_PAIR_RED));
+        } else if (global_stat_table.corrupt_bytes > 0) {
+            char warning_msg[96];
+            snprintf(warning_msg, sizeof(warning_msg), english ? "Warning: skipped %lld corrupt bytes in the work log" : "Uyarı: çalışma logunda %lld bozuk bayt atlandı",
+                     global_stat_table.corrupt_bytes);
+            wattron(win, COLOR_PAIR(COLOR_PAIR_RED));
+            mvwprintw(win, y, (cols - text_width(warning_msg)) / 2, "%s", warning_msg);
+            wattroff(win, COLOR_PAIR(COLOR_PAIR_RED));
+        }
+        return false;
+    }
+    char progress_msg[64];
+    if (english) {
+        snprintf(progress_msg, sizeof(progress_msg), "Updating statistics... %d%%", percent);
+    } else {
+        snprintf(progress_msg, sizeof(progress_msg), "İstatistikler güncelleniyor... %%%d", percent);
+    }
+    wattron(win, A_DIM);
+    mvwprintw(win, y, (cols - text_width(progress_msg)) / 2, "%s", progress_msg);
+    wattroff(win, A_DIM);
+    return true;
+}
 
-    // Print separator line
-    mvhline(current_y, table_start_x, '-', total_table_line_width);
-    current_y++;
+// Tablo ekranının sabit kısmı: pencereleri temizler, başlığı ve ESC satırını yazar
+static void draw_stats_frame(const UiLayout *layout, const char *title, const char *footer_msg) {
+    werase(layout->header);
+    werase(layout->body);
+    werase(layout->footer);
+    wattron(layout->header, COLOR_PAIR(COLOR_PAIR_TITLE));
+    mvwprintw(layout->header, 0, (layout->cols - text_width(title)) / 2, "%s", title);
+    wattroff(layout->header, COLOR_PAIR(COLOR_PAIR_TITLE));
+    mvwprintw(layout->footer, 0, (layout->cols - text_width(footer_msg)) / 2, "%s", footer_msg);
+    wnoutrefresh(layout->header);
+    wnoutrefresh(layout->footer);
+}
 
+// İstatistik tablosu. Yalnızca görünen satırlar çizilir; değerler, sıralamalar ve sütun
+// metrikleri önbellekten okunduğundan kaydırma, sıralama değiştirme ve yeniden
+// boyutlandırma maliyeti toplam odak sayısından bağımsızdır.
+void view_statistics(const char **current_lang_menu_items) {
+    bool english = (current_lang_menu_items == menu_items_en);
+
+    const char *title = english ? "Statistics" : "İstatistikler";
+    const char *no_data_msg = english ? "No work log data found." : "Çalışma kaydı bulunamadı.";
+    const char *loading_msg = english ? "Reading work log..." : "Çalışma kaydı okunuyor...";
+    const char *press_esc_to_return_msg = english ? "Press ESC to return to menu..." : "Menüye dönmek için ESC tuşuna basın..."; // Updated message
+    const char *scroll_help_msg = english ? "Up/Down PgUp/PgDn Home/End: scroll  Tab/Shift+Tab: category  S: sort  R: reverse" : "Yukarı/Aşağı PgUp/PgDn Home/End: kaydır  Tab/Shift+Tab: kategori  S: sırala  R: ters çevir";
+    const char *sort_key_names_en[STATS_SORT_KEY_COUNT] = { "defined order", "total time", "sessions", "average session", "name" };
+    const char *sort_key_names_tr[STATS_SORT_KEY_COUNT] = { "tanım sırası", "toplam süre", "oturum sayısı", "ortalama oturum", "ad" };
+    const char **sort_key_names = english ? sort_key_names_en : sort_key_names_tr;
+
+    const UiLayout *layout = ui_layout_get();
+
+    // Büyük log arka planda okunur; o sırada son yayımlanan görüntü gösterilir
+    request_statistics();
+
+    const StatsTableLayout *table = get_stats_table_layout();
+    const StatsTableValues *values = get_stats_table_values();
+    if (table == NULL || values == NULL) {
+        return; // Bellek hatası
+    }
+    bool has_data = (global_stat_table.num_categories > 0 && table->num_rows > 0);
 
+    StatsSortKey sort_key = STATS_SORT_DEFINED;
+    bool sort_descending = false;
+    const StatsOrdering *ordering = get_stats_ordering(sort_key, sort_descending);
+    if (ordering == NULL) {
+        return; // Bellek hatası
+    }
+    const StatsColumnMetrics *metrics = NULL;
+    int top_row = 0;
+    int max_display_rows = 0;
+    int max_top_row = 0;
+    bool layout_dirty = true; // Başlangıçta ve her KEY_RESIZE sonrası
+    bool body_dirty = true;
+    unsigned long drawn_stats_generation = stats_generation;
+    unsigned long drawn_entity_generation = entity_generation;
     int ch;
 
     while (1) {
-        clear();
-        attron(COLOR_PAIR(COLOR_PAIR_TITLE));
-        mvprintw(0, (xMax - strlen(title)) / 2, "%s", title);
-        attroff(COLOR_PAIR(COLOR_PAIR_TITLE));
-
-        // Yeniden başlıkları ve ayırıcıyı çiz
-        attron(A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-        mvprintw(2, table_start_x, "%-*s | %-*s | %*s",
-                 max_cat_name_len_display, cat_header,
-                 max_focus_name_len_display, focus_header,
-                 max_duration_str_len_display, duration_header);
-        attroff(A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
-        mvhline(3, table_start_x, '-', total_table_line_width);
-
-        int display_row = 4; // Start drawing content from row 4 (after headers and separator)
-        int items_displayed = 0;
-
-        // Kullanıcı tanımlı kategorileri döngüye al
-        for (int i = 0; i < num_user_categories; i++) {
-            if (display_row + items_displayed >= yMax - 2) break; // Check if enough space for category header
-
-            const char *current_category_name = user_categories[i].name;
-            int category_color_id = user_categories[i].color_pair_id;
-
-            attron(COLOR_PAIR(category_color_id));
-            attron(A_BOLD);
-            mvprintw(display_row + items_displayed, table_start_x, "%s", current_category_name);
-            attroff(COLOR_PAIR(category_color_id));
-            attroff(A_BOLD);
-            items_displayed++;
-
-            // Her odağın detayları
-            for (int j = 0; j < user_categories[i].num_focuses; j++) {
-                if (display_row + items_displayed >= yMax - 2) break; // Check if enough space for focus line
+        if (stats_generation != drawn_stats_generation || entity_generation != drawn_entity_generation) {
+            // Başka bir örnek oturum ekledi veya kategorileri değiştirdi: önbellekler yeni nesle göre
+            // yeniden kurulur, sütun genişlikleri değişmiş olabileceğinden çerçeve de yeniden çizilir
+            table = get_stats_table_layout();
+            values = get_stats_table_values();
+            ordering = get_stats_ordering(sort_key, sort_descending);
+            if (table == NULL || values == NULL || ordering == NULL) {
+                return; // Bellek hatası
+            }
+            has_data = (global_stat_table.num_categories > 0 && table->num_rows > 0);
+            drawn_stats_generation = stats_generation;
+            drawn_entity_generation = entity_generation;
+            layout_dirty = true;
+        }
+        if (layout_dirty) {
+            layout = ui_layout_get(); // Boyut değiştiyse pencereler yeniden kurulur
+            metrics = get_stats_column_metrics(english, layout->cols);
+            if (layout->body == NULL || metrics == NULL) {
+                // Ekran tablo için çok küçük: büyütülene veya ESC'ye kadar boş bekle
+                erase();
+                ui_present(stdscr);
+                ch = getch();
+                if (ch == 27) break;
+                continue;
+            }
+            draw_stats_frame(layout, title, press_esc_to_return_msg);
+            max_display_rows = layout->body_rows;
+            bool building = draw_stats_progress(layout->header, 1, layout->cols, english);
+
+            if (!has_data) {
+                const char *msg = building ? loading_msg : no_data_msg;
+                mvwprintw(layout->body, max_display_rows / 2, (layout->cols - text_width(msg)) / 2, "%s", msg);
+                wnoutrefresh(layout->header);
+            } else {
+                const char *cat_header = english ? "Category" : "Kategori";
+                const char *focus_header = english ? "Focus" : "Odak";
+                const char *sessions_header = english ? "Sessions" : "Oturum";
+                const char *average_header = english ? "Average" : "Ortalama";
+                const char *duration_header = english ? "Duration" : "Süre";
+
+                // Print headers
+                char header_line[512];
+                snprintf(header_line, sizeof(header_line), "%-*s | %-*s | %*s | %*s | %*s",
+                         metrics->category_width, cat_header,
+                         metrics->focus_width, focus_header,
+                         metrics->sessions_width, sessions_header,
+                         metrics->duration_width, average_header,
+                         metrics->duration_width, duration_header);
+                wattron(layout->header, A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
+                put_clipped(layout->header, 2, metrics->start_x, header_line);
+                wattroff(layout->header, A_BOLD | COLOR_PAIR(COLOR_PAIR_HIGHLIGHT));
+
+                // Print separator line
+                mvwhline(layout->header, 3, metrics->start_x, '-', metrics->line_width);
+                wnoutrefresh(layout->header);
+            }
 
-                const char *current_focus_name = user_categories[i].focuses[j].name;
-                int focus_color_id = user_categories[i].focuses[j].color_pair_id;
-                long focus_total_duration = 0;
+            max_top_row = (table->num_rows > max_display_rows) ? table->num_rows - max_display_rows : 0;
+            if (top_row > max_top_row) top_row = max_top_row;
+            layout_dirty = false;
+            body_dirty = true;
+        }
 
-                int stat_cat_idx = get_stat_category_index(user_categories[i].name);
-                if (stat_cat_idx != -1) { // Kategori istatistiklerde varsa
-                    int stat_focus_idx = get_stat_focus_index(&stat_categories[stat_cat_idx], current_focus_name);
-                    if (stat_focus_idx != -1) { // Odak istatistiklerde varsa
-                        focus_total_duration = stat_categories[stat_cat_idx].focuses[stat_focus_idx].total_duration;
-                    }
+        if (!has_data) {
+            if (body_dirty) {
+                ui_present(layout->body);
+                body_dirty = false;
+            }
+            ch = wait_for_key(EVENT_NO_DEADLINE);
+            if (ch == KEY_RESIZE) {
+                layout_dirty = true;
+                continue;
+            }
+            if (ch == EVENT_DATA_CHANGED) {
+                if (category_model_pins == 0) sync_category_model();
+                if (stats_generation == drawn_stats_generation && entity_generation == drawn_entity_generation) {
+                    bool building = draw_stats_progress(layout->header, 1, layout->cols, english);
+                    if (!building) layout_dirty = true; // Yapım sonuç vermeden bitti: mesaj güncellenir
+                    ui_present(layout->header);
                 }
+                continue;
+            }
+            break; // Veri yokken herhangi bir tuş menüye döner
+        }
 
-                char focus_total_duration_str[20];
-                format_duration_string(focus_total_duration, focus_total_duration_str, sizeof(focus_total_duration_str));
+        if (body_dirty) {
+            WINDOW *body = layout->body;
+            WINDOW *footer = layout->footer;
+            werase(body);
+            int last_row = top_row + max_display_rows;
+            if (last_row > table->num_rows) last_row = table->num_rows;
+
+            for (int row = top_row; row < last_row; row++) {
+                int y = row - top_row;
+                int focus_index;
+                int i = ordering->category_order[stats_table_row_at(table, ordering, row, &focus_index)];
+
+                if (focus_index == STATS_ROW_BLANK) continue; // Kategoriler arasındaki boş satır
+
+                if (focus_index == STATS_ROW_CATEGORY) {
+                    // Kategori satırı odaklarının toplamını gösterir (kategoriler bu değerlere göre sıralanır)
+                    int category_color_id = user_categories[i].color_pair_id;
+                    wattron(body, COLOR_PAIR(category_color_id) | A_BOLD);
+                    put_clipped(body, y, metrics->start_x, user_categories[i].name);
+                    wattroff(body, COLOR_PAIR(category_color_id) | A_BOLD);
+                    put_clipped(body, y, metrics->start_x + metrics->category_width, " | ");
+                    draw_stats_value_columns(body, y, metrics, &values->category_values[i]);
+                    continue;
+                }
 
-                // Print category name (empty for subsequent focuses in same category)
-                mvprintw(display_row + items_displayed, table_start_x, "%-*s", max_cat_name_len_display, "");
+                const Focus *focus = &user_categories[i].focuses[focus_index];
 
-                // Print separator
-                mvprintw(display_row + items_displayed, table_start_x + max_cat_name_len_display, " | ");
+                // Print separator (category column stays empty for focus rows)
+                put_clipped(body, y, metrics->start_x + metrics->category_width, " | ");
 
                 // Print focus name with its color
-                attron(COLOR_PAIR(focus_color_id));
-                mvprintw(display_row + items_displayed, table_start_x + max_cat_name_len_display + strlen(" | "), "%-*s", max_focus_name_len_display, current_focus_name);
-                attroff(COLOR_PAIR(focus_color_id));
-
-                // Print separator
-                mvprintw(display_row + items_displayed, table_start_x + max_cat_name_len_display + strlen(" | ") + max_focus_name_len_display, " | ");
-
-                // Print duration (right-aligned within its column)
-                mvprintw(display_row + items_displayed, table_start_x + max_cat_name_len_display + strlen(" | ") + max_focus_name_len_display + strlen(" | "), "%*s", max_duration_str_len_display, focus_total_duration_str);
+                wattron(body, COLOR_PAIR(focus->color_pair_id));
+                put_clipped(body, y, metrics->start_x + metrics->category_width + strlen(" | "), focus->name);
+                wattroff(body, COLOR_PAIR(focus->color_pair_id));
 
-                items_displayed++;
+                // Sessions, average and total duration (right-aligned within their columns)
+                draw_stats_value_columns(body, y, metrics, &values->focus_values[table->focus_base[i] + focus_index]);
             }
-            if (items_displayed < max_display_rows) { // Add an empty line between categories
-                mvprintw(display_row + items_displayed, table_start_x, "");
-                items_displayed++;
-            }
-        }
 
-        mvprintw(yMax - 2, (xMax - strlen(press_esc_to_return_msg)) / 2, "%s", press_esc_to_return_msg); // Updated message
-        refresh();
-        ch = getch();
+            // Alt bilgi: tuşlar, sıralama ve görünen satır aralığı
+            char position_str[96];
+            snprintf(position_str, sizeof(position_str), "%s: %s %s  %d-%d / %d",
+                     english ? "Sort" : "Sıralama", sort_key_names[sort_key],
+                     (sort_key == STATS_SORT_DEFINED) ? "" : (sort_descending ? (english ? "(desc)" : "(azalan)") : (english ? "(asc)" : "(artan)")),
+                     top_row + 1, last_row, table->num_rows);
+            int position_x = layout->cols - text_width(position_str) - 1;
+            wmove(footer, 1, 0);
+            wclrtoeol(footer);
+            put_cells(footer, 1, 1, scroll_help_msg, position_x - 2); // Sağdaki konum bilgisine kadar
+            mvwprintw(footer, 1, position_x, "%s", position_str);
+            wnoutrefresh(body);
+            ui_present(footer); // Yalnızca değişen hücreler gönderilir
+            body_dirty = false;
+        }
 
+        ch = wait_for_key(EVENT_NO_DEADLINE);
         if (ch == 27) { // ESC
             break;
         }
+        if (ch == EVENT_DATA_CHANGED) {
+            if (category_model_pins == 0) sync_category_model(); // Tablo yalnızca konum tutar
+            if (stats_generation == drawn_stats_generation && entity_generation == drawn_entity_generation) {
+                draw_stats_progress(layout->header, 1, layout->cols, english); // Yalnızca ilerleme satırı
+                ui_present(layout->header);
+            }
+            continue;
+        }
+
+        int new_top_row = top_row;
+        int focus_index;
+        int current_category = stats_table_row_at(table, ordering, top_row, &focus_index);
+        switch (ch) {
+            case KEY_RESIZE: layout_dirty = true; break; // Pencereler ve sütunlar yeni boyuta yerleşir
+            case KEY_UP: new_top_row--; break;
+            case KEY_DOWN: new_top_row++; break;
+            case KEY_PPAGE: new_top_row -= max_display_rows; break;
+            case KEY_NPAGE: new_top_row += max_display_rows; break;
+            case KEY_HOME: new_top_row = 0; break;
+            case KEY_END: new_top_row = max_top_row; break;
+            case '\t': // Sonraki kategori başlığına atla
+                if (current_category + 1 < num_user_categories) {
+                    new_top_row = ordering->category_first_row[current_category + 1];
+                }
+                break;
+            case KEY_BTAB: // Görünen kategorinin başına, zaten oradaysa bir öncekine atla
+                if (ordering->category_first_row[current_category] < top_row) {
+                    new_top_row = ordering->category_first_row[current_category];
+                } else if (current_category > 0) {
+                    new_top_row = ordering->category_first_row[current_category - 1];
+                }
+                break;
+            case 's':
+            case 'S':
+            case 'r':
+            case 'R': {
+                // Sayısal anahtarlar büyükten küçüğe, ad ve tanım sırası baştan başlar
+                StatsSortKey next_key = sort_key;
+                bool next_descending = !sort_descending;
+                if (tolower(ch) == 's') {
+                    next_key = (StatsSortKey)((sort_key + 1) % STATS_SORT_KEY_COUNT);
+                    next_descending = (next_key != STATS_SORT_DEFINED && next_key != STATS_SORT_NAME);
+                }
+                const StatsOrdering *next_ordering = get_stats_ordering(next_key, next_descending);
+                if (next_ordering != NULL) {
+                    ordering = next_ordering;
+                    sort_key = next_key;
+                    sort_descending = next_descending;
+                    new_top_row = 0;
+                    body_dirty = true;
+                }
+                break;
+            }
+        }
+        if (new_top_row > max_top_row) new_top_row = max_top_row;
+        if (new_top_row < 0) new_top_row = 0;
+        if (new_top_row != top_row) {
+            top_row = new_top_row;
+            body_dirty = true;
+        }
     }
 }
 
-// Boşta kalma çubuğunu çizen fonksiyon
-void draw_idle_bar(const char **current_lang_menu_items) {
-    clear();
-    int yMax, xMax;
-    getmaxyx(stdscr, yMax, xMax);
-
-    load_statistics(); // En güncel istatistikleri yükle
+// Boşta ekranının çizim modelini döndürür; yalnızca istatistikler, kategori modeli veya
+// çubuk genişliği değiştiğinde yeniden kurulur. Odaklar kalıcı ID ile tek hash
+// aramasında kategorisine, rengine ve güncel adına çözülür.
+// Return: model, NULL (bellek yetersiz)
+const IdleRenderModel *get_idle_render_model(int bar_width) {
+    IdleRenderModel *model = &idle_render_model;
+    if (model->valid && model->stats_generation == stats_generation &&
+        model->entity_generation == entity_generation && model->bar_width == bar_width) {
+        return model;
+    }
 
-    // Toplam süreyi ve odakların listesini hazırla
-    long total_overall_duration = 0;
-    // Tüm odakları tek bir listede toplamak için dinamik dizi
-    StatFocus *all_focuses = (StatFocus *)malloc(MAX_CATEGORIES * MAX_FOCUSES_PER_CATEGORY * sizeof(StatFocus));
-    if (all_focuses == NULL) {
-        // Bellek hatası
-        return;
+    // Her segment en az bir sütun kapladığından çubukta en fazla bar_width odak görünür;
+    // sıralama yalnızca bu kadar odak için yapılır.
+    const FocusRanking *ranking = get_focus_ranking(bar_width > IDLE_TOP_FOCUS_COUNT ? bar_width : IDLE_TOP_FOCUS_COUNT);
+    if (ranking == NULL) return NULL;
+    if (model->segment_capacity < ranking->count) {
+        IdleBarSegment *grown = realloc(model->segments, (size_t)ranking->count * sizeof(IdleBarSegment));
+        if (grown == NULL) return NULL;
+        model->segments = grown;
+        model->segment_capacity = ranking->count;
     }
-    int num_all_focuses = 0;
 
-    for (int i = 0; i < num_stat_categories; i++) {
-        for (int j = 0; j < stat_categories[i].num_focuses; j++) {
-            total_overall_duration += stat_categories[i].focuses[j].total_duration;
-            if (num_all_focuses < MAX_CATEGORIES * MAX_FOCUSES_PER_CATEGORY) {
-                all_focuses[num_all_focuses++] = stat_categories[i].focuses[j];
+    model->num_segments = 0;
+    model->num_top = 0;
+    model->filled_width = 0;
+    model->category_column_width = 0;
+    model->focus_column_width = 0;
+    model->total_duration = ranking->total_duration;
+
+    for (int i = 0; i < ranking->count; i++) {
+        const RankedFocus *ranked = &ranking->entries[i];
+        const StatFocus *stat_focus = ranked_stat_focus(ranked);
+        int cat_idx, focus_idx;
+        const Category *category = NULL;
+        const Focus *focus = NULL;
+        if (lookup_entity(stat_focus->id, &cat_idx, &focus_idx) && focus_idx != -1) {
+            category = &user_categories[cat_idx];
+            focus = &category->focuses[focus_idx];
+        }
+
+        if (model->total_duration > 0 && model->filled_width < bar_width) {
+            double percentage = (double)ranked->total_duration / model->total_duration;
+            int segment_width = (int)(bar_width * percentage);
+            // Minimum segment genişliği: Eğer yüzde > 0 ise ve hesaplanan genişlik 0 ise, 1 sütun yap
+            if (percentage > 0 && segment_width == 0) {
+                segment_width = 1;
+            }
+            // Barın dışına taşmasını engelle
+            if (model->filled_width + segment_width > bar_width) {
+                segment_width = bar_width - model->filled_width;
+            }
+            if (segment_width > 0) {
+                IdleBarSegment *segment = &model->segments[model->num_segments++];
+                segment->width = segment_width;
+                segment->color_pair_id = (focus != NULL) ? focus->color_pair_id : COLOR_PAIR_DEFAULT;
+                model->filled_width += segment_width;
             }
         }
-    }
 
-    // Odakları süreye göre azalan sırada sırala (kabarcık sıralaması basitlik için)
-    for (int i = 0; i < num_all_focuses - 1; i++) {
-        for (int j = 0; j < num_all_focuses - i - 1; j++) {
-            if (all_focuses[j].total_duration < all_focuses[j+1].total_duration) {
-                StatFocus temp = all_focuses[j];
-                all_focuses[j] = all_focuses[j+1];
-                all_focuses[j+1] = temp;
+        if (model->num_top < IDLE_TOP_FOCUS_COUNT) {
+            IdleTopFocus *top = &model->top[model->num_top++];
+            // Kalıcı ID'si bilinen odak güncel adıyla gösterilir (yeniden adlandırılmış olabilir)
+            top->category_name = (category != NULL) ? category->name : NULL;
+            top->focus_name = (focus != NULL) ? focus->name : stat_focus->name;
+            top->category_name_width = (category != NULL) ? category->name_width : 0;
+            top->focus_name_width = (focus != NULL) ? focus->name_width : text_width(stat_focus->name);
+            top->category_color_id = (category != NULL) ? category->color_pair_id : COLOR_PAIR_DEFAULT;
+            top->focus_color_id = (focus != NULL) ? focus->color_pair_id : COLOR_PAIR_DEFAULT;
+            top->total_duration = ranked->total_duration;
+            if (top->category_name_width > model->category_column_width) {
+                model->category_column_width = top->category_name_width;
+            }
+            if (top->focus_name_width > model->focus_column_width) {
+                model->focus_column_width = top->focus_name_width;
             }
         }
     }
 
-    // Başlık
-    const char *idle_title = (current_lang_menu_items == menu_items_en) ? "Current Focus Distribution" : "Mevcut Odak Dağılımı";
-    attron(COLOR_PAIR(COLOR_PAIR_TITLE));
-    mvprintw(yMax / 2 - 10, (xMax - strlen(idle_title)) / 2, "%s", idle_title);
-    attroff(COLOR_PAIR(COLOR_PAIR_TITLE));
+    // Okunabilirlik için en küçük sütun genişlikleri
+    if (model->category_column_width < 10) model->category_column_width = 10;
+    if (model->focus_column_width < 15) model->focus_column_width = 15;
 
-    // Saat ve Dakika
-    time_t rawtime;
-    struct tm *info;
+    model->bar_width = bar_width;
+    model->stats_generation = stats_generation;
+    model->entity_generation = entity_generation;
+    model->valid = true;
+    return model;
+}
+
+// Boşta ekranındaki saati çizer; yalnızca bu hücreler değişir.
+// Return: bir sonraki dakika başına kalan milisaniye
+static long long draw_idle_clock(void) {
+    int yMax, xMax;
+    getmaxyx(stdscr, yMax, xMax);
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    struct tm info;
+    localtime_r(&now.tv_sec, &info);
     char time_buffer[80];
-    time(&rawtime);
-    info = localtime(&rawtime);
-    strftime(time_buffer, sizeof(time_buffer), "%H:%M", info);
+    strftime(time_buffer, sizeof(time_buffer), "%H:%M", &info);
     attron(A_BOLD);
-    mvprintw(yMax / 2 - 8, (xMax - strlen(time_buffer)) / 2, "%s", time_buffer);
+    mvprintw(yMax / 2 - 8, (xMax - text_width(time_buffer)) / 2, "%s", time_buffer);
     attroff(A_BOLD);
+    // Saat dilimi farkları tam dakika olduğundan dakika sınırı yerel saatte de aynıdır
+    return (60 - info.tm_sec) * 1000LL - now.tv_nsec / 1000000;
+}
 
+// Boşta ekranını güncel ekran boyutuna göre çizer. full_repaint, ekran menüden gelirken
+// kullanılır; veriler değiştiğinde ise yalnızca farklı hücreler gönderilir.
+// Return: bir sonraki dakika başına kalan milisaniye
+static long long render_idle_screen(const char **current_lang_menu_items, bool full_repaint) {
+    if (full_repaint) {
+        clear(); // Menüden tamamen farklı bir ekran: fark yerine silip yeniden yazmak daha az bayt gönderir
+    } else {
+        erase();
+    }
+    int yMax, xMax;
+    getmaxyx(stdscr, yMax, xMax);
 
     // İstatistik Çubuğu
     int bar_width = xMax - 20; // Ekran genişliğinin bir kısmı
@@ -1757,6 +6792,22 @@ void draw_idle_bar(const char **current_lang_menu_items) {
     int bar_start_x = (xMax - bar_width) / 2;
     int bar_y = yMax / 2 - 5;
 
+    const IdleRenderModel *model = get_idle_render_model(bar_width);
+    if (model == NULL) {
+        // Bellek hatası
+        return 60 * 1000LL;
+    }
+
+    // Başlık
+    const char *idle_title = (current_lang_menu_items == menu_items_en) ? "Current Focus Distribution" : "Mevcut Odak Dağılımı";
+    attron(COLOR_PAIR(COLOR_PAIR_TITLE));
+    mvprintw(yMax / 2 - 10, (xMax - text_width(idle_title)) / 2, "%s", idle_title);
+    attroff(COLOR_PAIR(COLOR_PAIR_TITLE));
+
+    // Saat ve Dakika
+    long long next_minute_ms = draw_idle_clock();
+
+
     // Barın çerçevesini çiz (önce çerçeve)
     mvhline(bar_y - 1, bar_start_x - 1, '-', bar_width + 2);
     mvvline(bar_y, bar_start_x - 1, '|', 1);
@@ -1772,42 +6823,15 @@ void draw_idle_bar(const char **current_lang_menu_items) {
     mvhline(bar_y, bar_start_x, ' ', bar_width);
     attroff(COLOR_PAIR(COLOR_PAIR_DEFAULT));
 
-    if (total_overall_duration > 0) {
+    if (model->total_duration > 0) {
         int current_bar_x = bar_start_x;
-        for (int i = 0; i < num_all_focuses; i++) {
-            double percentage = (double)all_focuses[i].total_duration / total_overall_duration;
-            int segment_width = (int)(bar_width * percentage);
-
-            // Minimum segment genişliği: Eğer yüzde > 0 ise ve hesaplanan genişlik 0 ise, 1 piksel yap
-            if (percentage > 0 && segment_width == 0) {
-                segment_width = 1;
-            }
-
-            // Barın dışına taşmasını engelle
-            if (current_bar_x + segment_width > bar_start_x + bar_width) {
-                segment_width = (bar_start_x + bar_width) - current_bar_x;
-            }
-            if (segment_width <= 0) continue; // Geçersiz segment genişliği
-
-            // Odağın rengini bul
-            int focus_color_id = COLOR_PAIR_DEFAULT;
-            for (int k = 0; k < num_user_categories; k++) {
-                for (int l = 0; l < user_categories[k].num_focuses; l++) {
-                    if (strcmp(user_categories[k].focuses[l].name, all_focuses[i].name) == 0) {
-                        focus_color_id = user_categories[k].focuses[l].color_pair_id;
-                        break;
-                    }
-                }
-                if (focus_color_id != COLOR_PAIR_DEFAULT) break;
-            }
-
+        for (int i = 0; i < model->num_segments; i++) {
+            const IdleBarSegment *segment = &model->segments[i];
             // Bar segmentini çiz (ACS_BLOCK ile)
-            attron(COLOR_PAIR(focus_color_id));
-            for (int x_pos = 0; x_pos < segment_width; x_pos++) {
-                mvaddch(bar_y, current_bar_x + x_pos, ACS_BLOCK); // Boşluk yerine ACS_BLOCK kullanıldı
-            }
-            attroff(COLOR_PAIR(focus_color_id));
-            current_bar_x += segment_width;
+            attron(COLOR_PAIR(segment->color_pair_id));
+            mvhline(bar_y, current_bar_x, ACS_BLOCK, segment->width);
+            attroff(COLOR_PAIR(segment->color_pair_id));
+            current_bar_x += segment->width;
         }
         // Kalan kısmı varsayılan renkle doldur (yuvarlama hatalarını önlemek için)
         if (current_bar_x < bar_start_x + bar_width) {
@@ -1819,45 +6843,17 @@ void draw_idle_bar(const char **current_lang_menu_items) {
         }
     } else {
         const char *no_stats_msg = (current_lang_menu_items == menu_items_en) ? "No statistics yet to display." : "Henüz görüntülenecek istatistik yok.";
-        mvprintw(bar_y, (xMax - strlen(no_stats_msg)) / 2, "%s", no_stats_msg);
+        mvprintw(bar_y, (xMax - text_width(no_stats_msg)) / 2, "%s", no_stats_msg);
     }
+    draw_stats_progress(stdscr, bar_y + 2, xMax, current_lang_menu_items == menu_items_en);
 
     // En çok odaklanılan 3 odak bölümü
-    mvprintw(bar_y + 3, (xMax - strlen((current_lang_menu_items == menu_items_en) ? "Top 3 Focuses:" : "En Çok Odaklanılan 3 Odak:")) / 2, "%s", (current_lang_menu_items == menu_items_en) ? "Top 3 Focuses:" : "En Çok Odaklanılan 3 Odak:");
+    mvprintw(bar_y + 3, (xMax - text_width((current_lang_menu_items == menu_items_en) ? "Top 3 Focuses:" : "En Çok Odaklanılan 3 Odak:")) / 2, "%s", (current_lang_menu_items == menu_items_en) ? "Top 3 Focuses:" : "En Çok Odaklanılan 3 Odak:");
 
-    // Calculate max widths for alignment in Top 3 Focuses section
-    int max_top_cat_len = 0;
-    int max_top_focus_len = 0;
+    // Sütun genişlikleri modelde hazır
     char temp_duration_buffer[20]; // For duration string length
-
-    for (int i = 0; i < num_all_focuses && i < 3; i++) {
-        // Find category name for this focus
-        char current_category_name[MAX_CATEGORY_NAME_LEN] = "";
-        for (int k = 0; k < num_user_categories; k++) {
-            for (int l = 0; l < user_categories[k].num_focuses; l++) {
-                if (strcmp(user_categories[k].focuses[l].name, all_focuses[i].name) == 0) {
-                    strncpy(current_category_name, user_categories[k].name, sizeof(current_category_name) - 1);
-                    current_category_name[sizeof(current_category_name) - 1] = '\0';
-                    break;
-                }
-            }
-            if (strlen(current_category_name) > 0) break;
-        }
-        if (strlen(current_category_name) > max_top_cat_len) {
-            max_top_cat_len = strlen(current_category_name);
-        }
-        if (strlen(all_focuses[i].name) > max_top_focus_len) {
-            max_top_focus_len = strlen(all_focuses[i].name);
-        }
-    }
-
-    // Ensure minimum column widths for readability
-    if (max_top_cat_len < 10) max_top_cat_len = 10;
-    if (max_top_focus_len < 15) max_top_focus_len = 15;
-
-    // Adjust for padding and separators
-    int col1_width = max_top_cat_len;
-    int col2_width = max_top_focus_len;
+    int col1_width = model->category_column_width;
+    int col2_width = model->focus_column_width;
     format_duration_string(9999999, temp_duration_buffer, sizeof(temp_duration_buffer)); // Max possible duration string
     int col3_width = strlen(temp_duration_buffer); // Duration width
 
@@ -1883,35 +6879,21 @@ void draw_idle_bar(const char **current_lang_menu_items) {
 
 
     int display_y = bar_y + 7;
-    for (int i = 0; i < num_all_focuses && i < 3; i++) {
+    for (int i = 0; i < model->num_top; i++) {
+        const IdleTopFocus *top = &model->top[i];
         char total_time_str[20];
-        format_duration_string(all_focuses[i].total_duration, total_time_str, sizeof(total_time_str));
-
-        char category_for_focus[MAX_CATEGORY_NAME_LEN] = "";
-        int category_color_id = COLOR_PAIR_DEFAULT;
-        int focus_color_id = COLOR_PAIR_DEFAULT;
-
-        // Find category and focus colors
-        for (int k = 0; k < num_user_categories; k++) {
-            for (int l = 0; l < user_categories[k].num_focuses; l++) {
-                if (strcmp(user_categories[k].focuses[l].name, all_focuses[i].name) == 0) {
-                    strncpy(category_for_focus, user_categories[k].name, sizeof(category_for_focus) - 1);
-                    category_for_focus[sizeof(category_for_focus) - 1] = '\0';
-                    category_color_id = user_categories[k].color_pair_id;
-                    focus_color_id = user_categories[k].focuses[l].color_pair_id;
-                    break;
-                }
-            }
-            if (strlen(category_for_focus) > 0) break;
-        }
-        if (strlen(category_for_focus) == 0) {
-            strncpy(category_for_focus, (current_lang_menu_items == menu_items_en) ? "Unknown Category" : "Bilinmeyen Kategori", sizeof(category_for_focus) - 1);
-            category_for_focus[sizeof(category_for_focus) - 1] = '\0';
+        format_duration_string(top->total_duration, total_time_str, sizeof(total_time_str));
+
+        const char *category_for_focus = top->category_name;
+        if (category_for_focus == NULL || category_for_focus[0] == '\0') {
+            category_for_focus = (current_lang_menu_items == menu_items_en) ? "Unknown Category" : "Bilinmeyen Kategori";
         }
+        int category_color_id = top->category_color_id;
+        int focus_color_id = top->focus_color_id;
 
         // Print category name with its color
         attron(COLOR_PAIR(category_color_id));
-        mvprintw(display_y + i, top_focus_block_start_x, "%-*s", col1_width, category_for_focus);
+        put_cells(stdscr, display_y + i, top_focus_block_start_x, category_for_focus, col1_width); // Hücre genişliğine göre
         attroff(COLOR_PAIR(category_color_id));
 
         // Print separator
@@ -1919,7 +6901,7 @@ void draw_idle_bar(const char **current_lang_menu_items) {
 
         // Print focus name with its color
         attron(COLOR_PAIR(focus_color_id));
-        mvprintw(display_y + i, top_focus_block_start_x + col1_width + strlen(" - "), "%-*s", col2_width, all_focuses[i].name);
+        put_cells(stdscr, display_y + i, top_focus_block_start_x + col1_width + strlen(" - "), top->focus_name, col2_width);
         attroff(COLOR_PAIR(focus_color_id));
 
         // Print separator
@@ -1929,10 +6911,466 @@ void draw_idle_bar(const char **current_lang_menu_items) {
         mvprintw(display_y + i, top_focus_block_start_x + col1_width + strlen(" - ") + col2_width + strlen(" : "), "%*s", col3_width, total_time_str);
     }
 
-    refresh();
-    nodelay(stdscr, FALSE); // Bloğa girene kadar beklet
-    getch(); // Herhangi bir tuşa basılmasını bekle
-    nodelay(stdscr, TRUE); // Geri döndüğünde non-blocking moda geç
+    ui_present(stdscr);
+    return next_minute_ms;
+}
+
+// Veri dizinini, log veya kategori dosyasının yazımı bittiğinde, dosya değiştirildiğinde
+// ya da silindiğinde uyanmak için izler (arayüz ve arka plan servisi). Tek izleyici dizine
+// kurulur çünkü her iki dosya da rename() ile yerine konabilir.
+// Return: inotify tanımlayıcısı, -1 (desteklenmiyor; değişiklikler dakika başında denetlenir)
+int open_data_watch() {
+    int watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd == -1) return -1;
+    if (inotify_add_watch(watch_fd, focuslog_data_dir, DATA_WATCH_EVENTS) == -1) {
+        close(watch_fd);
+        return -1;
+    }
+    return watch_fd;
+}
+
+static const char *path_basename(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return (slash != NULL) ? slash + 1 : path;
+}
+
+// Bekleyen inotify olaylarını tek seferde boşaltır (art arda gelen yazımlar birleşir)
+// Return: DATA_CHANGE_LOG | DATA_CHANGE_CATEGORIES bitleri (0: ilgisiz dosyalar)
+int drain_data_watch(int watch_fd) {
+    const char *log_name = path_basename(active_log_path());
+    const char *categories_name = path_basename(categories_file_path);
+
+    int changes = 0;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while ((len = read(watch_fd, buffer, sizeof(buffer))) > 0) {
+        for (char *ptr = buffer; ptr < buffer + len; ) {
+            const struct inotify_event *event = (const struct inotify_event *)ptr;
+            if (event->len == 0) {
+                changes |= DATA_CHANGE_LOG | DATA_CHANGE_CATEGORIES; // Kuyruk taştı: her şeyi denetle
+            } else if (strcmp(event->name, log_name) == 0) {
+                changes |= DATA_CHANGE_LOG;
+            } else if (strcmp(event->name, categories_name) == 0) {
+                changes |= DATA_CHANGE_CATEGORIES;
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changes;
+}
+
+// Boşta kalma çubuğunu çizen fonksiyon
+// Ekran canlı bir pano olarak kalır: saat her dakika başında yalnızca kendi hücrelerinde
+// güncellenir; çubuk ve en çok odaklanılanlar yalnızca istatistikler değiştiğinde (ör. başka
+// bir terminalde biten oturum) yeniden çizilir. Arada süreç poll() içinde uyur.
+void draw_idle_bar(const char **current_lang_menu_items) {
+    request_statistics(); // Büyük log arka planda okunur, çubuk hazır olunca yenilenir
+    if (category_model_pins == 0) sync_category_model();
+
+    long long next_minute_ms = render_idle_screen(current_lang_menu_items, true);
+    unsigned long drawn_stats_generation = stats_generation;
+    unsigned long drawn_entity_generation = entity_generation;
+    while (1) {
+        // Saatin yeni dakikayı göstermesi için sınırın biraz sonrasında uyan
+        int ch = wait_for_key(monotonic_now_ms() + next_minute_ms + 20);
+        if (ch == KEY_RESIZE) {
+            // Yeni boyuta göre yeniden çiz (odak sıralaması önbellekten gelir, log yeniden okunmaz)
+            next_minute_ms = render_idle_screen(current_lang_menu_items, true);
+            continue;
+        }
+        if (ch != ERR && ch != EVENT_DATA_CHANGED) {
+            break; // Herhangi bir tuş boşta ekranını kapatır
+        }
+
+        // Log değişikliği wait_for_key içinde yüklendi. inotify yoksa dosyalar dakika başında
+        // denetlenir; yük artımlıdır (değişmediyse yalnızca fstat/stat)
+        if (ch == ERR) {
+            request_statistics();
+        }
+        // Bir menü kategori işaretçileri tutuyorsa birleştirme menüye dönülünce yapılır
+        if ((ch == ERR || category_model_stale) && category_model_pins == 0) {
+            sync_category_model();
+        }
+        if (stats_generation != drawn_stats_generation || entity_generation != drawn_entity_generation) {
+            next_minute_ms = render_idle_screen(current_lang_menu_items, false);
+            drawn_stats_generation = stats_generation;
+            drawn_entity_generation = entity_generation;
+        } else if (ch == ERR) {
+            next_minute_ms = draw_idle_clock();
+            ui_present(stdscr);
+        } else {
+            int yMax = getmaxy(stdscr);
+            draw_stats_progress(stdscr, yMax / 2 - 3, getmaxx(stdscr), current_lang_menu_items == menu_items_en); // Çubuğun altı
+            ui_present(stdscr);
+        }
+    }
+}
+
+
+// --- Arka Plan Servisi ---
+// Satır tabanlı protokol: her istek '\n' ile biten tek satırdır, alanlar sekmeyle ayrılır;
+// her yanıt "OK ..." veya "ERR ..." ile başlayan tek satırdır.
+//   PING                                        -> OK focuslog
+//   STATUS                                      -> OK idle | OK running|paused <kalan> <geçen> <kategori> <odak>
+//   TOTAL [kategori]                            -> OK <oturum> <saniye>
+//   START <saniye> <kat. ID> <odak ID> <kategori> <odak> [belirteç] -> OK <belirteç> | ERR busy
+//   PAUSE / RESUME [belirteç]                   -> OK | ERR idle
+//   STOP (geçen süreyi kaydet), FINISH (tam süreyi kaydet) [belirteç] -> OK <kaydedilen saniye> | ERR idle | ERR write
+// Oturumu başlatan istemci kaydı hiçbir zaman kendisi yazmaz. Bağlantısı koparsa yeniden bağlanıp
+// isteği belirteçle tekrarlar: belirteç isteğin sonradan başlamış başka bir oturuma uygulanmasını
+// önler, "ERR idle" ise oturumun servisçe zaten kaydedildiğini bildirir. START'ta istemcinin verdiği
+// belirteç, yanıtı kaybolan START'ın tekrarını aynı oturum olarak tanıtır.
+
+static DaemonSession daemon_session;
+static unsigned long daemon_next_token; // run_daemon'da saatle tohumlanır; yeniden başlayan servis eski belirteçleri tanımaz
+static volatile sig_atomic_t daemon_stop_requested = 0;
+
+static void daemon_handle_signal(int signal_number) {
+    (void)signal_number;
+    daemon_stop_requested = 1;
+}
+
+// Servisin etkin oturumunu loga yazar ve kapatır
+// Return: kaydedilen saniye, -1 (log yazılamadı; oturum yine de kapanır)
+static long daemon_record_session(long duration_seconds) {
+    DaemonSession *session = &daemon_session;
+    Category category = { 0 };
+    Focus focus = { 0 };
+    category.name = session->category_name;
+    category.id = session->category_id;
+    focus.name = session->focus_name;
+    focus.id = session->focus_id;
+
+    // Duvar saati geri alındıysa bitiş, başlangıçtan önce kaydedilmez
+    time_t end_time = time(NULL);
+    if (end_time < session->start_time) end_time = session->start_time + (time_t)duration_seconds;
+    bool recorded = record_work_session(&category, &focus, session->start_time, end_time, duration_seconds);
+    session->active = false;
+    return recorded ? duration_seconds : -1;
+}
+
+static long daemon_elapsed_seconds(void) {
+    long elapsed = (long)(session_clock_elapsed_ms(&daemon_session.clock) / 1000);
+    return elapsed < daemon_session.duration_seconds ? elapsed : daemon_session.duration_seconds;
+}
+
+// Bir istek satırını işler ve yanıtı reply'a yazar
+static void daemon_handle_request(char *line, char *reply, size_t reply_size, int watch_fd) {
+    DaemonSession *session = &daemon_session;
+    char *fields[7];
+    int num_fields = 0;
+    char *cursor = line;
+    while (num_fields < 7) {
+        fields[num_fields++] = cursor;
+        cursor = strchr(cursor, '\t');
+        if (cursor == NULL) break;
+        *cursor++ = '\0';
+    }
+    const char *command = fields[0];
+
+    if (strcmp(command, "PING") == 0) {
+        snprintf(reply, reply_size, "OK focuslog");
+    } else if (strcmp(command, "STATUS") == 0) {
+        if (!session->active) {
+            snprintf(reply, reply_size, "OK idle");
+        } else {
+            long elapsed = daemon_elapsed_seconds();
+            snprintf(reply, reply_size, "OK %s\t%ld\t%ld\t%s\t%s", session->clock.paused ? "paused" : "running",
+                     session->duration_seconds - elapsed, elapsed, session->category_name, session->focus_name);
+        }
+    } else if (strcmp(command, "TOTAL") == 0) {
+        if (watch_fd == -1) {
+            load_statistics(); // inotify yok: artımlı yükleme değişmediyse yalnızca fstat
+        }
+        const char *category_filter = (num_fields > 1) ? fields[1] : NULL;
+        int sessions = 0;
+        long seconds = 0;
+        for (int i = 0; i < global_stat_table.num_categories; i++) {
+            const StatCategory *stat_cat = &global_stat_table.categories[i];
+            if (category_filter != NULL && strcmp(stats_query_category_name(stat_cat), category_filter) != 0) {
+                continue;
+            }
+            for (int j = 0; j < stat_cat->num_focuses; j++) {
+                sessions += stat_cat->focuses[j].session_count;
+                seconds += stat_cat->focuses[j].total_duration;
+            }
+        }
+        snprintf(reply, reply_size, "OK %d\t%ld", sessions, seconds);
+    } else if (strcmp(command, "START") == 0) {
+        long duration_seconds = (num_fields >= 6) ? atol(fields[1]) : 0;
+        unsigned long client_token = (num_fields == 7) ? strtoul(fields[6], NULL, 10) : 0;
+        if (session->active && client_token != 0 && client_token == session->token) {
+            snprintf(reply, reply_size, "OK %lu", session->token); // Yanıtı kaybolan START tekrarlandı
+        } else if (session->active) {
+            snprintf(reply, reply_size, "ERR busy");
+        } else if (duration_seconds <= 0) {
+            snprintf(reply, reply_size, "ERR usage");
+        } else {
+            session->duration_seconds = duration_seconds;
+            session->category_id = (uint32_t)strtoul(fields[2], NULL, 10);
+            session->focus_id = (uint32_t)strtoul(fields[3], NULL, 10);
+            snprintf(session->category_name, sizeof(session->category_name), "%s", fields[4]);
+            snprintf(session->focus_name, sizeof(session->focus_name), "%s", fields[5]);
+            session->start_time = time(NULL);
+            session_clock_start(&session->clock);
+            session->active = true;
+            session->token = (client_token != 0) ? client_token : ++daemon_next_token;
+            snprintf(reply, reply_size, "OK %lu", session->token);
+        }
+    } else if (strcmp(command, "PAUSE") == 0 || strcmp(command, "RESUME") == 0) {
+        if (!session->active || (num_fields > 1 && strtoul(fields[1], NULL, 10) != session->token)) {
+            snprintf(reply, reply_size, "ERR idle");
+        } else {
+            if (command[0] == 'P') {
+                session_clock_pause(&session->clock);
+            } else {
+                session_clock_resume(&session->clock);
+            }
+            snprintf(reply, reply_size, "OK");
+        }
+    } else if (strcmp(command, "STOP") == 0 || strcmp(command, "FINISH") == 0) {
+        if (!session->active || (num_fields > 1 && strtoul(fields[1], NULL, 10) != session->token)) {
+            snprintf(reply, reply_size, "ERR idle");
+        } else {
+            long recorded = daemon_record_session(command[0] == 'S' ? daemon_elapsed_seconds() : session->duration_seconds);
+            if (recorded < 0) {
+                snprintf(reply, reply_size, "ERR write");
+            } else {
+                snprintf(reply, reply_size, "OK %ld", recorded);
+            }
+        }
+    } else {
+        snprintf(reply, reply_size, "ERR unknown");
+    }
+}
+
+// İstemciden gelen baytları satırlara ayırıp yanıtlar.
+// Return: false (bağlantı kapandı veya istemci kurala uymuyor)
+static bool daemon_serve_client(DaemonClient *client, int watch_fd) {
+    ssize_t len = recv(client->fd, client->buffer + client->len, sizeof(client->buffer) - client->len, MSG_DONTWAIT);
+    if (len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+        return false;
+    }
+    if (len < 0) {
+        return true;
+    }
+    client->len += (size_t)len;
+
+    char *line = client->buffer;
+    char *newline;
+    while ((newline = memchr(line, '\n', client->len - (size_t)(line - client->buffer))) != NULL) {
+        *newline = '\0';
+        if (newline > line && newline[-1] == '\r') newline[-1] = '\0';
+        char reply[DAEMON_LINE_MAX];
+        daemon_handle_request(line, reply, sizeof(reply) - 1, watch_fd);
+        size_t reply_len = strlen(reply);
+        reply[reply_len++] = '\n';
+        // Yanıtı okumayan istemci servisi bekletemez
+        if (send(client->fd, reply, reply_len, MSG_DONTWAIT | MSG_NOSIGNAL) != (ssize_t)reply_len) {
+            return false;
+        }
+        line = newline + 1;
+    }
+    size_t pending = client->len - (size_t)(line - client->buffer);
+    if (pending == sizeof(client->buffer)) {
+        return false; // Satır sınırı aşıldı
+    }
+    memmove(client->buffer, line, pending);
+    client->len = pending;
+    return true;
+}
+
+static bool daemon_socket_address(struct sockaddr_un *address) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(daemon_socket_path) >= sizeof(address->sun_path)) {
+        return false;
+    }
+    strcpy(address->sun_path, daemon_socket_path);
+    return true;
+}
+
+// Çalışan servise bağlanır; gönderme/alma süreleri sınırlıdır, böylece yanıt vermeyen bir
+// servis arayüzü kilitlemez.
+// Return: soket, -1 (servis çalışmıyor)
+int daemon_connect() {
+    struct sockaddr_un address;
+    if (!daemon_socket_address(&address)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval timeout = { 0, DAEMON_CLIENT_TIMEOUT_MS * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+// Tek bir istek gönderir ve yanıt satırını ('\n' olmadan) okur
+// Return: true (yanıt alındı), false (bağlantı hatası veya zaman aşımı)
+bool daemon_request(int fd, const char *request, char *reply, size_t reply_size) {
+    char line[DAEMON_LINE_MAX];
+    int line_len = snprintf(line, sizeof(line), "%s\n", request);
+    if (line_len < 0 || line_len >= (int)sizeof(line) ||
+        send(fd, line, (size_t)line_len, MSG_NOSIGNAL) != line_len) {
+        return false;
+    }
+    size_t received = 0;
+    while (received + 1 < reply_size) {
+        ssize_t len = recv(fd, reply + received, reply_size - 1 - received, 0);
+        if (len <= 0) {
+            return false;
+        }
+        received += (size_t)len;
+        char *newline = memchr(reply, '\n', received);
+        if (newline != NULL) {
+            *newline = '\0';
+            return true;
+        }
+    }
+    return false;
+}
+
+// `focuslog status [İSTEK...]`: isteği (varsayılan STATUS) servise gönderir ve yanıtın
+// "OK " sonrasını yazdırır
+// Return: çıkış kodu
+int run_status_client(int argc, char **argv) {
+    char request[DAEMON_LINE_MAX] = "STATUS";
+    if (argc > 2) {
+        size_t len = 0;
+        for (int i = 2; i < argc && len < sizeof(request); i++) {
+            len += snprintf(request + len, sizeof(request) - len, "%s%s", (i > 2) ? "\t" : "", argv[i]);
+        }
+    }
+
+    int fd = daemon_connect();
+    if (fd == -1) {
+        fprintf(stderr, "Hata: FocusLog servisi çalışmıyor (%s)\n", daemon_socket_path);
+        return EXIT_FAILURE;
+    }
+    char reply[DAEMON_LINE_MAX];
+    bool ok = daemon_request(fd, request, reply, sizeof(reply));
+    close(fd);
+    if (!ok || strncmp(reply, "OK", 2) != 0) {
+        fprintf(stderr, "Hata: %s\n", ok ? reply : "Servis yanıt vermedi");
+        return EXIT_FAILURE;
+    }
+    printf("%s\n", reply[2] == ' ' ? reply + 3 : reply + 2);
+    return EXIT_SUCCESS;
+}
+
+// `focuslog daemon`: etkin oturumun sahibi olan ve toplamları bellekte tutan servis.
+// Toplamlar log değiştikçe artımlı güncellenir; sorgular logu yeniden okumaz. Ön planda
+// çalışır (ör. `focuslog daemon &` veya bir kullanıcı servisi olarak); SIGINT/SIGTERM'de
+// süren oturumun geçen kısmını kaydedip soketi kaldırır.
+// Return: çıkış kodu
+int run_daemon() {
+    struct sockaddr_un address;
+    if (!daemon_socket_address(&address)) {
+        fprintf(stderr, "Hata: Soket yolu çok uzun: %s\n", daemon_socket_path);
+        return EXIT_FAILURE;
+    }
+    int probe_fd = daemon_connect();
+    if (probe_fd != -1) {
+        close(probe_fd);
+        fprintf(stderr, "Hata: FocusLog servisi zaten çalışıyor (%s)\n", daemon_socket_path);
+        return EXIT_FAILURE;
+    }
+    unlink(daemon_socket_path); // Önceki servisten kalmış soket
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    mode_t old_umask = umask(0077); // Soket yalnızca kullanıcıya açık
+    bool bound = (listen_fd != -1 && bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) == 0);
+    umask(old_umask);
+    if (!bound || listen(listen_fd, 16) != 0) {
+        fprintf(stderr, "Hata: Soket açılamadı: %s\n", daemon_socket_path);
+        if (listen_fd != -1) close(listen_fd);
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = daemon_handle_signal; // SA_RESTART yok: poll() EINTR ile döner
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    load_settings(); // Oturum saatinin uyku politikası
+    load_data();
+    load_statistics();
+    int watch_fd = open_data_watch();
+    daemon_next_token = (unsigned long)time(NULL) << 16;
+
+    DaemonClient clients[DAEMON_MAX_CLIENTS];
+    int num_clients = 0;
+    struct pollfd fds[DAEMON_MAX_CLIENTS + 2];
+
+    while (!daemon_stop_requested) {
+        // Etkin oturum yalnızca süresi dolduğunda uyandırır
+        int timeout_ms = -1;
+        if (daemon_session.active && !daemon_session.clock.paused) {
+            long long remaining_ms = daemon_session.duration_seconds * 1000LL - session_clock_elapsed_ms(&daemon_session.clock);
+            if (remaining_ms <= 0) {
+                daemon_record_session(daemon_session.duration_seconds);
+                continue;
+            }
+            timeout_ms = (int)(remaining_ms < DAEMON_MAX_SLEEP_MS ? remaining_ms : DAEMON_MAX_SLEEP_MS);
+        }
+
+        int nfds = 0;
+        fds[nfds++] = (struct pollfd){ listen_fd, (num_clients < DAEMON_MAX_CLIENTS) ? POLLIN : 0, 0 };
+        int watch_slot = -1;
+        if (watch_fd != -1) {
+            watch_slot = nfds;
+            fds[nfds++] = (struct pollfd){ watch_fd, POLLIN, 0 };
+        }
+        int first_client_slot = nfds;
+        for (int i = 0; i < num_clients; i++) {
+            fds[nfds++] = (struct pollfd){ clients[i].fd, POLLIN, 0 };
+        }
+
+        if (poll(fds, nfds, timeout_ms) <= 0) {
+            continue; // Zaman aşımı (oturum bitişi) veya sinyal
+        }
+
+        if (watch_slot != -1 && fds[watch_slot].revents != 0) {
+            int changes = drain_data_watch(watch_fd);
+            if (changes & DATA_CHANGE_LOG) load_statistics();
+            if (changes & DATA_CHANGE_CATEGORIES) sync_category_model(); // Servis modele işaretçi tutmaz
+        }
+
+        // Kapanan istemciler sondakiyle yer değiştirerek çıkarılır
+        for (int i = num_clients - 1; i >= 0; i--) {
+            if (fds[first_client_slot + i].revents != 0 && !daemon_serve_client(&clients[i], watch_fd)) {
+                close(clients[i].fd);
+                clients[i] = clients[--num_clients];
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int client_fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (client_fd != -1) {
+                clients[num_clients].fd = client_fd;
+                clients[num_clients].len = 0;
+                num_clients++;
+            }
+        }
+    }
 
-    free(all_focuses); // Belleği serbest bırak
+    if (daemon_session.active) {
+        daemon_record_session(daemon_elapsed_seconds()); // Süren oturum kaybolmasın
+    }
+    for (int i = 0; i < num_clients; i++) {
+        close(clients[i].fd);
+    }
+    if (watch_fd != -1) close(watch_fd);
+    close(listen_fd);
+    unlink(daemon_socket_path);
+    return EXIT_SUCCESS;
 }
@@ -1,4 +1,130 @@
 #!/bin/bash
 
-gcc main.c -o focuslog -lncurses
-./focuslog
+gcc main.c -o focuslog -lncursesw -pthread || exit 1
+
+# ./test.sh --check: arayüzsüz denetimler geçici bir HOME'da çalışır; aksi halde uygulama açılır
+if [ "$1" != "--check" ]; then
+    ./focuslog
+    exit
+fi
+
+FOCUSLOG="$PWD/focuslog"
+failures=0
+export LANG=C.UTF-8 TZ=UTC
+
+fail() {
+    echo "BAŞARISIZ: $1"
+    failures=$((failures + 1))
+}
+
+# Her denetim boş bir veri diziniyle başlar
+fresh_home() {
+    export HOME="$(mktemp -d)"
+    DATA="$HOME/.config/focuslog"
+    mkdir -p "$DATA"
+}
+
+wait_for_daemon() {
+    for _ in $(seq 50); do
+        [ -S "$DATA/focuslog.sock" ] && return 0
+        sleep 0.1
+    done
+    return 1
+}
+
+# Servisin sahip olduğu oturum tam bir kez kaydedilir: START'ı gönderen bağlantı kapandıktan
+# sonra (arayüzde PAUSE'un başarısız olması gibi) istekler yeni bağlantıdan belirteçle tekrarlanır
+check_daemon_single_owner() {
+    fresh_home
+    "$FOCUSLOG" daemon &
+    local daemon_pid=$!
+    wait_for_daemon || { fail "servis başlamadı"; kill $daemon_pid; return; }
+
+    [ "$("$FOCUSLOG" status START 60 0 0 Cat Foc 4242)" = "4242" ] || fail "START belirteci döndürmedi"
+    [ "$("$FOCUSLOG" status START 60 0 0 Cat Foc 4242)" = "4242" ] || fail "START tekrarı aynı oturumu bulmadı"
+    "$FOCUSLOG" status PAUSE 4242 > /dev/null || fail "PAUSE yeniden bağlantıda reddedildi"
+    "$FOCUSLOG" status STOP 999 > /dev/null 2>&1 && fail "başka belirteçle STOP kabul edildi"
+    [ "$("$FOCUSLOG" status FINISH 4242)" = "60" ] || fail "FINISH tam süreyi kaydetmedi"
+    "$FOCUSLOG" status FINISH 4242 > /dev/null 2>&1 && fail "tekrarlanan FINISH ikinci kez kaydetti"
+
+    kill $daemon_pid
+    wait $daemon_pid
+    [ "$("$FOCUSLOG" stats --by total)" = "$(printf '1\t60')" ] || fail "oturum tam bir kez kaydedilmedi"
+}
+
+# İki örnek aynı anda kayıt eklerken log sıkıştırılıp biçimi değiştirilse de hiçbir satır kaybolmaz
+check_concurrent_writers() {
+    fresh_home
+    local rows=150 writers=()
+    for name in A B; do
+        (for _ in $(seq $rows); do "$FOCUSLOG" record "$name" "x" 1 || echo "kayıt hatası" >&2; done) &
+        writers+=($!)
+    done
+    # Yazıcılar sürdükçe log yeniden yazılır
+    while kill -0 "${writers[@]}" 2> /dev/null; do
+        "$FOCUSLOG" compact-log > /dev/null
+        "$FOCUSLOG" convert-log binary > /dev/null
+        "$FOCUSLOG" compact-log > /dev/null
+        "$FOCUSLOG" convert-log csv > /dev/null
+    done
+    wait
+    local expected="$((rows * 2))	$((rows * 2))"
+    [ "$("$FOCUSLOG" stats --by total)" = "$expected" ] || fail "eşzamanlı eklemelerde satır kayboldu"
+}
+
+# Sorgu önbelleğinden artımlı yükleme (ekleme, silme işareti, yeniden yazma sonrası) baştan
+# yüklemeyle aynı toplamları verir
+check_incremental_reload() {
+    fresh_home
+    for i in $(seq 20); do "$FOCUSLOG" record "Cat$((i % 3))" "Focus$((i % 4))" $((i * 10)); done
+    "$FOCUSLOG" stats > /dev/null # Önbelleği oluşturur
+    "$FOCUSLOG" record Cat1 Focus1 77
+    printf '!DELETE_FOCUS,"Cat2","Focus2",%s,0,0\n' "$(date +%s)" >> "$DATA/work_log.csv"
+    "$FOCUSLOG" record Cat2 Focus2 5
+    local incremental full
+    incremental="$("$FOCUSLOG" stats)"
+    rm -f "$DATA/stats.cache"
+    full="$("$FOCUSLOG" stats)"
+    [ "$incremental" = "$full" ] || fail "eklemeden sonra artımlı yükleme farklı"
+
+    "$FOCUSLOG" compact-log > /dev/null
+    "$FOCUSLOG" record Cat0 Focus0 3
+    incremental="$("$FOCUSLOG" stats)"
+    rm -f "$DATA/stats.cache"
+    full="$("$FOCUSLOG" stats)"
+    [ "$incremental" = "$full" ] || fail "yeniden yazmadan sonra artımlı yükleme farklı"
+}
+
+# `focuslog stats` bilinen bir logda beklenen satırları yazar
+check_stats_fixture() {
+    fresh_home
+    cat > "$DATA/work_log.csv" <<'LOG'
+"Category","Focus","StartEpoch","EndEpoch","UtcOffset","Duration","CategoryId","FocusId"
+"Work","Coding",1700000000,1700001500,0,1500,0,0
+"Work","Review",1700002000,1700002600,0,600,0,0
+"Home","Reading",1700003000,1700003900,0,900,0,0
+"Work","Coding",1800000000,1800003000,0,3000,0,0
+!DELETE_FOCUS,"Home","Reading",1800000100,0,0
+"Home","Reading",1800000200,1800000500,0,300,0,0
+"Old","old",1800000600,1800000660,0,60,50,51
+LOG
+    printf '!NextId;52\n#Q"x;20;50\na\tb;21;51\n' > "$DATA/categories_and_focuses.txt"
+
+    diff <("$FOCUSLOG" stats) <(printf 'Work\tCoding\t2\t4500\nWork\tReview\t1\t600\nHome\tReading\t1\t300\nQ"x\ta\\tb\t1\t60\n') ||
+        fail "stats (odak, TSV) çıktısı farklı"
+    diff <("$FOCUSLOG" stats --by category --format csv) <(printf '"Category","Sessions","Seconds"\n"Work",3,5100\n"Home",1,300\n"Q""x",1,60\n') ||
+        fail "stats (kategori, CSV) çıktısı farklı"
+    diff <("$FOCUSLOG" stats --since 2027-01-01 --category Work --by total) <(printf '1\t3000\n') ||
+        fail "stats (--since, --category) çıktısı farklı"
+}
+
+check_daemon_single_owner
+check_concurrent_writers
+check_incremental_reload
+check_stats_fixture
+
+if [ $failures -ne 0 ]; then
+    echo "$failures denetim başarısız"
+    exit 1
+fi
+echo "Tüm denetimler geçti"